@@ -33,6 +33,7 @@ extern "C" {
 typedef enum {
     LVGL_PORT_EVENT_DISPLAY = 0x01,
     LVGL_PORT_EVENT_TOUCH   = 0x02,
+    LVGL_PORT_EVENT_CALL    = 0x04, /*!< Calls queued by lvgl_port_call_async() */
     LVGL_PORT_EVENT_USER    = 0x80,
 } lvgl_port_event_type_t;
 
@@ -148,6 +149,32 @@ esp_err_t lvgl_port_resume(void);
  */
 esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param);
 
+#if LVGL_VERSION_MAJOR >= 9
+#define LVGL_PORT_CALL_QUEUE_LEN 16 /*!< Calls waiting for the LVGL task before lvgl_port_call_async() fails */
+
+/**
+ * @brief Function run in the LVGL task by lvgl_port_call_async()
+ */
+typedef void (*lvgl_port_call_cb_t)(void *arg);
+
+/**
+ * @brief Run a function in the LVGL task
+ *
+ * The call is queued and the LVGL task woken. It runs there with the LVGL mutex held, before the next
+ * lv_timer_handler(), in the order the calls were queued. This is how other tasks hand work to LVGL without waiting
+ * for the lock. Safe from any task and from interrupts; never blocks.
+ *
+ * @param cb  Function to call
+ * @param arg Its argument
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if cb is NULL
+ *      - ESP_ERR_INVALID_STATE     if the LVGL port is not initialized
+ *      - ESP_ERR_NO_MEM            if LVGL_PORT_CALL_QUEUE_LEN calls are already waiting; this one is dropped
+ */
+esp_err_t lvgl_port_call_async(lvgl_port_call_cb_t cb, void *arg);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port damage accumulation
+ *
+ * Collects the areas invalidated during one refresh cycle and merges them where rendering, rotating and flushing one
+ * larger area is cheaper than handling them one by one. Every area costs its pixels plus a fixed per-area overhead
+ * (render setup, rotation setup, the panel transfer), expressed in pixels; two areas are merged when their bounding
+ * box costs no more than both of them:
+ *
+ *     pixels(bounding box) <= pixels(a) + pixels(b) + area_cost
+ *
+ * With an area_cost of 0 this is the rule LVGL itself uses to join overlapping areas, extended to areas that line up
+ * edge to edge. A larger cost also merges areas that are close but apart, like the strips of cards moving side by
+ * side.
+ *
+ * The accumulator does not depend on LVGL, so it can be tested on its own.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_PORT_DAMAGE_MAX_AREAS         16   /*!< Areas collected per refresh cycle before they are forced together */
+#define LVGL_PORT_DAMAGE_AREA_COST_DEFAULT 4096 /*!< Default per-area overhead, in pixels */
+
+/**
+ * @brief Rectangle with inclusive coordinates, as lv_area_t
+ */
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} lvgl_port_damage_area_t;
+
+/**
+ * @brief Areas collected in the current refresh cycle
+ */
+typedef struct {
+    lvgl_port_damage_area_t areas[LVGL_PORT_DAMAGE_MAX_AREAS];
+    uint32_t count;     /*!< Areas in use */
+    uint32_t area_cost; /*!< Per-area overhead in pixels, 0 for LVGL's rule */
+} lvgl_port_damage_t;
+
+/**
+ * @brief Start an empty accumulator
+ *
+ * @param damage    Accumulator
+ * @param area_cost Per-area overhead in pixels
+ */
+void lvgl_port_damage_init(lvgl_port_damage_t *damage, uint32_t area_cost);
+
+/**
+ * @brief Forget the collected areas, at the end of a refresh cycle
+ */
+void lvgl_port_damage_clear(lvgl_port_damage_t *damage);
+
+/**
+ * @brief Add an invalidated area
+ *
+ * Merges the area with every collected one where the cost model says so, repeating while the grown area reaches
+ * further ones, and collects the result. When all slots are taken, the area goes into the collected one it grows
+ * the least. Collected areas never contain one another.
+ *
+ * @param damage Accumulator
+ * @param area   Invalidated area, replaced by the collected area that covers it
+ * @return Number of collected areas merged into it
+ */
+uint32_t lvgl_port_damage_add(lvgl_port_damage_t *damage, lvgl_port_damage_area_t *area);
+
+/**
+ * @brief Pixels of an area
+ */
+static inline uint32_t lvgl_port_damage_area_size(const lvgl_port_damage_area_t *area)
+{
+    return (uint32_t)(area->x2 - area->x1 + 1) * (uint32_t)(area->y2 - area->y1 + 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -67,6 +67,32 @@ typedef struct {
     } flags;
 } lvgl_port_display_cfg_t;
 
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Kernel used for software rotation (flags.sw_rotate)
+ */
+typedef enum {
+    LVGL_PORT_ROTATE_KERNEL_AUTO = 0,  /*!< PPA for 90 degrees on MIPI-DSI displays, tiled otherwise */
+    LVGL_PORT_ROTATE_KERNEL_TILED,     /*!< Cache-blocked lvgl_port_rotate_tiled() */
+    LVGL_PORT_ROTATE_KERNEL_REFERENCE, /*!< Pixel by pixel lvgl_port_rotate_reference() */
+    LVGL_PORT_ROTATE_KERNEL_LVGL,      /*!< LVGL's lv_draw_sw_rotate() */
+    LVGL_PORT_ROTATE_KERNEL_PPA,       /*!< PPA scale-rotate-mirror engine (ESP32-P4 MIPI-DSI displays, RGB565) */
+} lvgl_port_rotate_kernel_t;
+
+/**
+ * @brief Counters of the damage accumulation and the flush path, since the display was added
+ */
+typedef struct {
+    uint32_t areas_in;       /*!< Areas invalidated by LVGL */
+    uint32_t areas_merged;   /*!< Collected areas merged into a later one */
+    uint32_t areas_out;      /*!< Areas flushed */
+    uint32_t refreshes;      /*!< Refresh cycles */
+    uint64_t pixels_in;      /*!< Pixels of the invalidated areas, counting overlaps once per area */
+    uint64_t pixels_out;     /*!< Pixels flushed */
+    uint64_t pixels_rotated; /*!< Pixels turned by the SW rotation */
+} lvgl_port_damage_stats_t;
+#endif
+
 /**
  * @brief Configuration RGB display structure
  */
@@ -137,6 +163,48 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg,
  */
 esp_err_t lvgl_port_remove_disp(lv_display_t *disp);
 
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Choose the kernel that rotates flushed areas when software rotation is enabled
+ *
+ * Takes effect from the next flush. Kernels the display cannot use fall back to the tiled one.
+ *
+ * @param disp   LVGL display
+ * @param kernel Rotation kernel
+ * @param tile   Tile edge in pixels for LVGL_PORT_ROTATE_KERNEL_TILED (8 to 32), 0 for the default of the color format
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the display or the kernel is not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if the PPA is requested but the display does not use it
+ */
+esp_err_t lvgl_port_set_rotate_kernel(lv_display_t *disp, lvgl_port_rotate_kernel_t kernel, uint32_t tile);
+
+/**
+ * @brief Set how eagerly the areas invalidated in a refresh cycle are merged before they are rendered and flushed
+ *
+ * Two areas are merged when their bounding box has at most area_cost more pixels than both of them together, see
+ * esp_lvgl_port_damage.h. Merging is on by default with LVGL_PORT_DAMAGE_AREA_COST_DEFAULT.
+ *
+ * @param disp      LVGL display
+ * @param area_cost Per-area overhead in pixels; 0 leaves the areas as LVGL invalidates them
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the display is not valid
+ */
+esp_err_t lvgl_port_set_damage_merge(lv_display_t *disp, uint32_t area_cost);
+
+/**
+ * @brief Read the damage and flush counters of a display
+ *
+ * @param disp  LVGL display
+ * @param stats Filled with the counters
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if an argument is not valid
+ */
+esp_err_t lvgl_port_get_damage_stats(lv_display_t *disp, lvgl_port_damage_stats_t *stats);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,10 +18,49 @@ extern "C" {
 #warning "esp_lvgl_port_lv_blend.h included, but CONFIG_LV_DRAW_SW_ASM_CUSTOM not set. Assembly rendering not used"
 #else
 
+#include "lv_version.h"
+
 /*********************
  *      DEFINES
  *********************/
 
+#if CONFIG_IDF_TARGET_ESP32P4
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) _lv_color_blend_to_rgb565_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc) _lv_color_blend_to_rgb565_with_opa_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc) _lv_color_blend_to_rgb565_with_mask_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc) _lv_color_blend_to_rgb565_mix_mask_opa_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) _lv_rgb565_blend_normal_to_rgb565_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc) _lv_rgb565_blend_normal_to_rgb565_with_opa_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc) _lv_rgb565_blend_normal_to_rgb565_with_mask_esp(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc) \
+    _lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_esp(dsc)
+#endif
+
+#else  // esp32, esp32s3
+
 #ifndef LV_DRAW_SW_COLOR_BLEND_TO_ARGB8888
 #define LV_DRAW_SW_COLOR_BLEND_TO_ARGB8888(dsc) _lv_color_blend_to_argb8888_esp(dsc)
 #endif
@@ -38,10 +77,21 @@ extern "C" {
 #define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) _lv_rgb565_blend_normal_to_rgb565_esp(dsc)
 #endif
 
+#endif  // CONFIG_IDF_TARGET_ESP32P4
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* LVGL 9.2 renamed the blend descriptors, the old names are struct tags only */
+#if LVGL_VERSION_MAJOR > 9 || (LVGL_VERSION_MAJOR == 9 && LVGL_VERSION_MINOR >= 2)
+typedef lv_draw_sw_blend_fill_dsc_t esp_blend_fill_dsc_t;
+typedef lv_draw_sw_blend_image_dsc_t esp_blend_image_dsc_t;
+#else
+typedef _lv_draw_sw_blend_fill_dsc_t esp_blend_fill_dsc_t;
+typedef _lv_draw_sw_blend_image_dsc_t esp_blend_image_dsc_t;
+#endif
+
 typedef struct {
     uint32_t opa;
     void *dst_buf;
@@ -58,9 +108,9 @@ typedef struct {
  * GLOBAL PROTOTYPES
  **********************/
 
-extern int lv_color_blend_to_argb8888_esp(asm_dsc_t *asm_dsc);
+extern int lv_color_blend_to_rgb565_esp(asm_dsc_t *asm_dsc);
 
-static inline lv_result_t _lv_color_blend_to_argb8888_esp(_lv_draw_sw_blend_fill_dsc_t *dsc)
+static inline lv_result_t _lv_color_blend_to_rgb565_esp(esp_blend_fill_dsc_t *dsc)
 {
     asm_dsc_t asm_dsc = {
         .dst_buf    = dsc->dest_buf,
@@ -70,14 +120,31 @@ static inline lv_result_t _lv_color_blend_to_argb8888_esp(_lv_draw_sw_blend_fill
         .src_buf    = &dsc->color,
     };
 
-    return lv_color_blend_to_argb8888_esp(&asm_dsc);
+    return lv_color_blend_to_rgb565_esp(&asm_dsc);
 }
 
-extern int lv_color_blend_to_rgb565_esp(asm_dsc_t *asm_dsc);
+extern int lv_rgb565_blend_normal_to_rgb565_esp(asm_dsc_t *asm_dsc);
 
-static inline lv_result_t _lv_color_blend_to_rgb565_esp(_lv_draw_sw_blend_fill_dsc_t *dsc)
+static inline lv_result_t _lv_rgb565_blend_normal_to_rgb565_esp(esp_blend_image_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {.dst_buf    = dsc->dest_buf,
+                         .dst_w      = dsc->dest_w,
+                         .dst_h      = dsc->dest_h,
+                         .dst_stride = dsc->dest_stride,
+                         .src_buf    = dsc->src_buf,
+                         .src_stride = dsc->src_stride};
+
+    return lv_rgb565_blend_normal_to_rgb565_esp(&asm_dsc);
+}
+
+#if CONFIG_IDF_TARGET_ESP32P4
+
+extern int lv_color_blend_to_rgb565_with_opa_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_color_blend_to_rgb565_with_opa_esp(esp_blend_fill_dsc_t *dsc)
 {
     asm_dsc_t asm_dsc = {
+        .opa        = dsc->opa,
         .dst_buf    = dsc->dest_buf,
         .dst_w      = dsc->dest_w,
         .dst_h      = dsc->dest_h,
@@ -85,12 +152,112 @@ static inline lv_result_t _lv_color_blend_to_rgb565_esp(_lv_draw_sw_blend_fill_d
         .src_buf    = &dsc->color,
     };
 
-    return lv_color_blend_to_rgb565_esp(&asm_dsc);
+    return lv_color_blend_to_rgb565_with_opa_esp(&asm_dsc);
+}
+
+extern int lv_color_blend_to_rgb565_with_mask_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_color_blend_to_rgb565_with_mask_esp(esp_blend_fill_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {
+        .dst_buf     = dsc->dest_buf,
+        .dst_w       = dsc->dest_w,
+        .dst_h       = dsc->dest_h,
+        .dst_stride  = dsc->dest_stride,
+        .src_buf     = &dsc->color,
+        .mask_buf    = dsc->mask_buf,
+        .mask_stride = dsc->mask_stride,
+    };
+
+    return lv_color_blend_to_rgb565_with_mask_esp(&asm_dsc);
+}
+
+extern int lv_color_blend_to_rgb565_mix_mask_opa_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_color_blend_to_rgb565_mix_mask_opa_esp(esp_blend_fill_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {
+        .opa         = dsc->opa,
+        .dst_buf     = dsc->dest_buf,
+        .dst_w       = dsc->dest_w,
+        .dst_h       = dsc->dest_h,
+        .dst_stride  = dsc->dest_stride,
+        .src_buf     = &dsc->color,
+        .mask_buf    = dsc->mask_buf,
+        .mask_stride = dsc->mask_stride,
+    };
+
+    return lv_color_blend_to_rgb565_mix_mask_opa_esp(&asm_dsc);
+}
+
+extern int lv_rgb565_blend_normal_to_rgb565_with_opa_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_rgb565_blend_normal_to_rgb565_with_opa_esp(esp_blend_image_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {.opa        = dsc->opa,
+                         .dst_buf    = dsc->dest_buf,
+                         .dst_w      = dsc->dest_w,
+                         .dst_h      = dsc->dest_h,
+                         .dst_stride = dsc->dest_stride,
+                         .src_buf    = dsc->src_buf,
+                         .src_stride = dsc->src_stride};
+
+    return lv_rgb565_blend_normal_to_rgb565_with_opa_esp(&asm_dsc);
+}
+
+extern int lv_rgb565_blend_normal_to_rgb565_with_mask_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_rgb565_blend_normal_to_rgb565_with_mask_esp(esp_blend_image_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {.dst_buf     = dsc->dest_buf,
+                         .dst_w       = dsc->dest_w,
+                         .dst_h       = dsc->dest_h,
+                         .dst_stride  = dsc->dest_stride,
+                         .src_buf     = dsc->src_buf,
+                         .src_stride  = dsc->src_stride,
+                         .mask_buf    = dsc->mask_buf,
+                         .mask_stride = dsc->mask_stride};
+
+    return lv_rgb565_blend_normal_to_rgb565_with_mask_esp(&asm_dsc);
+}
+
+extern int lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_esp(esp_blend_image_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {.opa         = dsc->opa,
+                         .dst_buf     = dsc->dest_buf,
+                         .dst_w       = dsc->dest_w,
+                         .dst_h       = dsc->dest_h,
+                         .dst_stride  = dsc->dest_stride,
+                         .src_buf     = dsc->src_buf,
+                         .src_stride  = dsc->src_stride,
+                         .mask_buf    = dsc->mask_buf,
+                         .mask_stride = dsc->mask_stride};
+
+    return lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_esp(&asm_dsc);
+}
+
+#else  // esp32, esp32s3
+
+extern int lv_color_blend_to_argb8888_esp(asm_dsc_t *asm_dsc);
+
+static inline lv_result_t _lv_color_blend_to_argb8888_esp(esp_blend_fill_dsc_t *dsc)
+{
+    asm_dsc_t asm_dsc = {
+        .dst_buf    = dsc->dest_buf,
+        .dst_w      = dsc->dest_w,
+        .dst_h      = dsc->dest_h,
+        .dst_stride = dsc->dest_stride,
+        .src_buf    = &dsc->color,
+    };
+
+    return lv_color_blend_to_argb8888_esp(&asm_dsc);
 }
 
 extern int lv_color_blend_to_rgb888_esp(asm_dsc_t *asm_dsc);
 
-static inline lv_result_t _lv_color_blend_to_rgb888_esp(_lv_draw_sw_blend_fill_dsc_t *dsc, uint32_t dest_px_size)
+static inline lv_result_t _lv_color_blend_to_rgb888_esp(esp_blend_fill_dsc_t *dsc, uint32_t dest_px_size)
 {
     if (dest_px_size != 3) {
         return LV_RESULT_INVALID;
@@ -106,19 +273,7 @@ static inline lv_result_t _lv_color_blend_to_rgb888_esp(_lv_draw_sw_blend_fill_d
     return lv_color_blend_to_rgb888_esp(&asm_dsc);
 }
 
-extern int lv_rgb565_blend_normal_to_rgb565_esp(asm_dsc_t *asm_dsc);
-
-static inline lv_result_t _lv_rgb565_blend_normal_to_rgb565_esp(_lv_draw_sw_blend_image_dsc_t *dsc)
-{
-    asm_dsc_t asm_dsc = {.dst_buf    = dsc->dest_buf,
-                         .dst_w      = dsc->dest_w,
-                         .dst_h      = dsc->dest_h,
-                         .dst_stride = dsc->dest_stride,
-                         .src_buf    = dsc->src_buf,
-                         .src_stride = dsc->src_stride};
-
-    return lv_rgb565_blend_normal_to_rgb565_esp(&asm_dsc);
-}
+#endif  // CONFIG_IDF_TARGET_ESP32P4
 
 #endif  // CONFIG_LV_DRAW_SW_ASM_CUSTOM
 
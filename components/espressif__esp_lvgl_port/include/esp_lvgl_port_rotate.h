@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port software rotation kernels
+ *
+ * Rotate a block of pixels into a separate buffer, as the flush callback does for software rotation. Angles follow
+ * lv_display_rotation_t: the content turns the opposite way to the display, so that the rotated block lands on the
+ * area lvgl_port_rotate_area() gives. For a w x h source block:
+ *
+ *  - 90:  src(x, y) -> dst(y, w - 1 - x), the destination is h pixels wide
+ *  - 180: src(x, y) -> dst(w - 1 - x, h - 1 - y)
+ *  - 270: src(x, y) -> dst(h - 1 - y, x), the destination is h pixels wide
+ *
+ * The kernels do not depend on LVGL, so they can be tested and benchmarked on their own.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Rotation angle, in the values of lv_display_rotation_t
+ */
+typedef enum {
+    LVGL_PORT_ROTATE_0   = 0,
+    LVGL_PORT_ROTATE_90  = 1,
+    LVGL_PORT_ROTATE_180 = 2,
+    LVGL_PORT_ROTATE_270 = 3,
+} lvgl_port_rotate_angle_t;
+
+#define LVGL_PORT_ROTATE_TILE_MIN 8  /*!< Smallest tile edge of lvgl_port_rotate_tiled() */
+#define LVGL_PORT_ROTATE_TILE_MAX 32 /*!< Largest tile edge of lvgl_port_rotate_tiled() */
+
+/**
+ * @brief Rotate pixel by pixel, the portable reference
+ *
+ * Walks the source in order and scatters every pixel to its place. For 90 and 270 degrees the writes stride through
+ * the whole destination, which is what the tiled kernel avoids.
+ *
+ * @param src        First pixel of the source block
+ * @param dst        First pixel of the destination block, must not overlap the source
+ * @param w          Source width in pixels
+ * @param h          Source height in pixels
+ * @param src_stride Source line length in bytes
+ * @param dst_stride Destination line length in bytes
+ * @param angle      Rotation angle; 0 copies
+ * @param px_size    Bytes per pixel: 2 (RGB565), 3 (RGB888) or 4 (ARGB8888)
+ */
+void lvgl_port_rotate_reference(const void *src, void *dst, int32_t w, int32_t h, int32_t src_stride,
+                                int32_t dst_stride, lvgl_port_rotate_angle_t angle, uint32_t px_size);
+
+/**
+ * @brief Rotate in square tiles, cache-blocked
+ *
+ * 90 and 270 degrees transpose one tile x tile block at a time: each destination line of a tile is written in one
+ * run while the tile's source lines stay in the cache, so neither side strides through a full-frame buffer pixel by
+ * pixel. 180 degrees needs no transpose and reverses whole lines. The result is identical to
+ * lvgl_port_rotate_reference().
+ *
+ * @param tile Tile edge in pixels, clamped to LVGL_PORT_ROTATE_TILE_MIN..LVGL_PORT_ROTATE_TILE_MAX; 0 picks
+ *             lvgl_port_rotate_default_tile()
+ *
+ * Other parameters as for lvgl_port_rotate_reference().
+ */
+void lvgl_port_rotate_tiled(const void *src, void *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                            lvgl_port_rotate_angle_t angle, uint32_t px_size, uint32_t tile);
+
+/**
+ * @brief Tile edge the tiled kernel uses by default
+ *
+ * About one 64-byte cache line of pixels per tile line: 32 pixels of RGB565, 16 of RGB888 and ARGB8888.
+ */
+uint32_t lvgl_port_rotate_default_tile(uint32_t px_size);
+
+#ifdef __cplusplus
+}
+#endif
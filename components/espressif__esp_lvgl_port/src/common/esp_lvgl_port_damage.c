@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include "esp_lvgl_port_damage.h"
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static void damage_join(lvgl_port_damage_area_t *out, const lvgl_port_damage_area_t *a,
+                        const lvgl_port_damage_area_t *b)
+{
+    out->x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+    out->y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+    out->x2 = a->x2 > b->x2 ? a->x2 : b->x2;
+    out->y2 = a->y2 > b->y2 ? a->y2 : b->y2;
+}
+
+/* Take out the collected area i, the last one fills its slot */
+static void damage_remove(lvgl_port_damage_t *damage, uint32_t i)
+{
+    damage->areas[i] = damage->areas[--damage->count];
+}
+
+/* Merge area with the first collected area the cost model allows */
+static bool damage_merge_one(lvgl_port_damage_t *damage, lvgl_port_damage_area_t *area)
+{
+    const uint64_t area_px = lvgl_port_damage_area_size(area);
+    for (uint32_t i = 0; i < damage->count; i++) {
+        lvgl_port_damage_area_t joined;
+        damage_join(&joined, area, &damage->areas[i]);
+        if (lvgl_port_damage_area_size(&joined) <=
+                area_px + lvgl_port_damage_area_size(&damage->areas[i]) + damage->area_cost) {
+            *area = joined;
+            damage_remove(damage, i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Merge area with the collected area it grows the least */
+static void damage_merge_closest(lvgl_port_damage_t *damage, lvgl_port_damage_area_t *area)
+{
+    uint32_t best                       = 0;
+    uint64_t best_growth                = UINT64_MAX;
+    lvgl_port_damage_area_t best_joined = *area;
+    for (uint32_t i = 0; i < damage->count; i++) {
+        lvgl_port_damage_area_t joined;
+        damage_join(&joined, area, &damage->areas[i]);
+        const uint64_t growth = lvgl_port_damage_area_size(&joined) - lvgl_port_damage_area_size(&damage->areas[i]);
+        if (growth < best_growth) {
+            best        = i;
+            best_growth = growth;
+            best_joined = joined;
+        }
+    }
+    *area = best_joined;
+    damage_remove(damage, best);
+}
+
+/*******************************************************************************
+ * Public API functions
+ *******************************************************************************/
+
+void lvgl_port_damage_init(lvgl_port_damage_t *damage, uint32_t area_cost)
+{
+    damage->count     = 0;
+    damage->area_cost = area_cost;
+}
+
+void lvgl_port_damage_clear(lvgl_port_damage_t *damage)
+{
+    damage->count = 0;
+}
+
+uint32_t lvgl_port_damage_add(lvgl_port_damage_t *damage, lvgl_port_damage_area_t *area)
+{
+    uint32_t merged = 0;
+
+    /* A grown area may now reach collected areas it was too far from before, so start over after every merge */
+    while (true) {
+        if (damage_merge_one(damage, area)) {
+            merged++;
+        } else if (damage->count == LVGL_PORT_DAMAGE_MAX_AREAS) {
+            damage_merge_closest(damage, area);
+            merged++;
+        } else {
+            break;
+        }
+    }
+    damage->areas[damage->count++] = *area;
+    return merged;
+}
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_lvgl_port_rotate.h"
+
+/* RGB888 pixel, copied as a whole */
+typedef struct {
+    uint8_t c[3];
+} px24_t;
+
+/* Pixel px of a line */
+#define PX(type, line, px) (((type *)(line))[px])
+
+/*******************************************************************************
+ * Reference kernels: one pixel at a time, in source order
+ *******************************************************************************/
+
+#define DEFINE_ROTATE_REFERENCE(suffix, type)                                                                          \
+    static void rotate_reference_##suffix(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, \
+                                          int32_t dst_stride, lvgl_port_rotate_angle_t angle)                          \
+    {                                                                                                                  \
+        for (int32_t y = 0; y < h; y++) {                                                                              \
+            const uint8_t *line = src + y * src_stride;                                                                \
+            for (int32_t x = 0; x < w; x++) {                                                                          \
+                int32_t dx = x, dy = y;                                                                                \
+                switch (angle) {                                                                                       \
+                    case LVGL_PORT_ROTATE_90:                                                                          \
+                        dx = y;                                                                                        \
+                        dy = w - 1 - x;                                                                                \
+                        break;                                                                                         \
+                    case LVGL_PORT_ROTATE_180:                                                                         \
+                        dx = w - 1 - x;                                                                                \
+                        dy = h - 1 - y;                                                                                \
+                        break;                                                                                         \
+                    case LVGL_PORT_ROTATE_270:                                                                         \
+                        dx = h - 1 - y;                                                                                \
+                        dy = x;                                                                                        \
+                        break;                                                                                         \
+                    default:                                                                                           \
+                        break;                                                                                         \
+                }                                                                                                      \
+                PX(type, dst + dy * dst_stride, dx) = PX(const type, line, x);                                         \
+            }                                                                                                          \
+        }                                                                                                              \
+    }
+
+DEFINE_ROTATE_REFERENCE(16, uint16_t)
+DEFINE_ROTATE_REFERENCE(24, px24_t)
+DEFINE_ROTATE_REFERENCE(32, uint32_t)
+
+/*******************************************************************************
+ * Tiled kernels
+ *******************************************************************************/
+
+/* 90 and 270 degrees: every source column of a tile becomes one destination line segment. The tile's source lines
+ * are read once per column, so they stay cached while the segment is written in one run. */
+#define DEFINE_ROTATE_TILED(suffix, type)                                                                              \
+    static void rotate90_tiled_##suffix(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride,   \
+                                        int32_t dst_stride, int32_t tile)                                              \
+    {                                                                                                                  \
+        for (int32_t ty = 0; ty < h; ty += tile) {                                                                     \
+            const int32_t y_end = ty + tile < h ? ty + tile : h;                                                       \
+            for (int32_t tx = 0; tx < w; tx += tile) {                                                                 \
+                const int32_t x_end = tx + tile < w ? tx + tile : w;                                                   \
+                for (int32_t x = tx; x < x_end; x++) {                                                                 \
+                    type *out        = &PX(type, dst + (w - 1 - x) * dst_stride, ty);                                  \
+                    const uint8_t *in = src + ty * src_stride;                                                         \
+                    for (int32_t y = ty; y < y_end; y++, in += src_stride) {                                           \
+                        *out++ = PX(const type, in, x);                                                                \
+                    }                                                                                                  \
+                }                                                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void rotate270_tiled_##suffix(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride,  \
+                                         int32_t dst_stride, int32_t tile)                                             \
+    {                                                                                                                  \
+        for (int32_t ty = 0; ty < h; ty += tile) {                                                                     \
+            const int32_t y_end = ty + tile < h ? ty + tile : h;                                                       \
+            for (int32_t tx = 0; tx < w; tx += tile) {                                                                 \
+                const int32_t x_end = tx + tile < w ? tx + tile : w;                                                   \
+                for (int32_t x = tx; x < x_end; x++) {                                                                 \
+                    type *out        = &PX(type, dst + x * dst_stride, h - 1 - ty);                                    \
+                    const uint8_t *in = src + ty * src_stride;                                                         \
+                    for (int32_t y = ty; y < y_end; y++, in += src_stride) {                                           \
+                        *out-- = PX(const type, in, x);                                                                \
+                    }                                                                                                  \
+                }                                                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void rotate180_##suffix(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride,        \
+                                   int32_t dst_stride)                                                                 \
+    {                                                                                                                  \
+        for (int32_t y = 0; y < h; y++) {                                                                              \
+            const type *in = &PX(const type, src + y * src_stride, 0);                                                 \
+            type *out      = &PX(type, dst + (h - 1 - y) * dst_stride, w - 1);                                         \
+            for (int32_t x = 0; x < w; x++) {                                                                          \
+                *out-- = *in++;                                                                                        \
+            }                                                                                                          \
+        }                                                                                                              \
+    }
+
+DEFINE_ROTATE_TILED(16, uint16_t)
+DEFINE_ROTATE_TILED(24, px24_t)
+DEFINE_ROTATE_TILED(32, uint32_t)
+
+/*******************************************************************************
+ * Public API functions
+ *******************************************************************************/
+
+static void copy_lines(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                       uint32_t px_size)
+{
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(dst + y * dst_stride, src + y * src_stride, w * px_size);
+    }
+}
+
+void lvgl_port_rotate_reference(const void *src, void *dst, int32_t w, int32_t h, int32_t src_stride,
+                                int32_t dst_stride, lvgl_port_rotate_angle_t angle, uint32_t px_size)
+{
+    switch (px_size) {
+        case 2:
+            rotate_reference_16(src, dst, w, h, src_stride, dst_stride, angle);
+            break;
+        case 3:
+            rotate_reference_24(src, dst, w, h, src_stride, dst_stride, angle);
+            break;
+        case 4:
+            rotate_reference_32(src, dst, w, h, src_stride, dst_stride, angle);
+            break;
+        default:
+            break;
+    }
+}
+
+uint32_t lvgl_port_rotate_default_tile(uint32_t px_size)
+{
+    return px_size <= 2 ? 32 : 16;
+}
+
+void lvgl_port_rotate_tiled(const void *src, void *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                            lvgl_port_rotate_angle_t angle, uint32_t px_size, uint32_t tile)
+{
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (tile == 0) {
+        tile = lvgl_port_rotate_default_tile(px_size);
+    } else if (tile < LVGL_PORT_ROTATE_TILE_MIN) {
+        tile = LVGL_PORT_ROTATE_TILE_MIN;
+    } else if (tile > LVGL_PORT_ROTATE_TILE_MAX) {
+        tile = LVGL_PORT_ROTATE_TILE_MAX;
+    }
+
+    switch (angle) {
+        case LVGL_PORT_ROTATE_90:
+            if (px_size == 2) {
+                rotate90_tiled_16(src, dst, w, h, src_stride, dst_stride, tile);
+            } else if (px_size == 3) {
+                rotate90_tiled_24(src, dst, w, h, src_stride, dst_stride, tile);
+            } else if (px_size == 4) {
+                rotate90_tiled_32(src, dst, w, h, src_stride, dst_stride, tile);
+            }
+            break;
+        case LVGL_PORT_ROTATE_180:
+            if (px_size == 2) {
+                rotate180_16(src, dst, w, h, src_stride, dst_stride);
+            } else if (px_size == 3) {
+                rotate180_24(src, dst, w, h, src_stride, dst_stride);
+            } else if (px_size == 4) {
+                rotate180_32(src, dst, w, h, src_stride, dst_stride);
+            }
+            break;
+        case LVGL_PORT_ROTATE_270:
+            if (px_size == 2) {
+                rotate270_tiled_16(src, dst, w, h, src_stride, dst_stride, tile);
+            } else if (px_size == 3) {
+                rotate270_tiled_24(src, dst, w, h, src_stride, dst_stride, tile);
+            } else if (px_size == 4) {
+                rotate270_tiled_32(src, dst, w, h, src_stride, dst_stride, tile);
+            }
+            break;
+        default:
+            copy_lines(src, dst, w, h, src_stride, dst_stride, px_size);
+            break;
+    }
+}
@@ -15,6 +15,7 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
 #include "esp_lvgl_port.h"
 #include "esp_lvgl_port_priv.h"
 #include "lvgl.h"
@@ -27,11 +28,17 @@ static const char *TAG = "LVGL";
  * Types definitions
  *******************************************************************************/
 
+typedef struct {
+    lvgl_port_call_cb_t cb;
+    void *arg;
+} lvgl_port_call_t;
+
 typedef struct lvgl_port_ctx_s {
     TaskHandle_t lvgl_task;
     SemaphoreHandle_t lvgl_mux;
     SemaphoreHandle_t timer_mux;
     EventGroupHandle_t lvgl_events;
+    QueueHandle_t calls;
     SemaphoreHandle_t task_init_mux;
     esp_timer_handle_t tick_timer;
     bool running;
@@ -83,6 +90,9 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     /* Task queue */
     lvgl_port_ctx.lvgl_events = xEventGroupCreate();
     ESP_GOTO_ON_FALSE(lvgl_port_ctx.lvgl_events, ESP_ERR_NO_MEM, err, TAG, "Create LVGL Event Group fail!");
+    /* Calls from other tasks */
+    lvgl_port_ctx.calls = xQueueCreate(LVGL_PORT_CALL_QUEUE_LEN, sizeof(lvgl_port_call_t));
+    ESP_GOTO_ON_FALSE(lvgl_port_ctx.calls, ESP_ERR_NO_MEM, err, TAG, "Create LVGL call queue fail!");
 
     BaseType_t res;
     if (cfg->task_affinity < 0) {
@@ -202,6 +212,34 @@ esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param)
     return ESP_OK;
 }
 
+esp_err_t lvgl_port_call_async(lvgl_port_call_cb_t cb, void *arg)
+{
+    /* No logging, this may run in an interrupt */
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!lvgl_port_ctx.calls) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const lvgl_port_call_t call = {.cb = cb, .arg = arg};
+    BaseType_t queued;
+    if (xPortInIsrContext() == pdTRUE) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        queued = xQueueSendFromISR(lvgl_port_ctx.calls, &call, &xHigherPriorityTaskWoken);
+        if (xHigherPriorityTaskWoken) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        queued = xQueueSend(lvgl_port_ctx.calls, &call, 0);
+    }
+    if (queued != pdTRUE) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return lvgl_port_task_wake(LVGL_PORT_EVENT_CALL, NULL);
+}
+
 IRAM_ATTR bool lvgl_port_task_notify(uint32_t value)
 {
     BaseType_t need_yield = pdFALSE;
@@ -249,6 +287,12 @@ static void lvgl_port_task(void *arg)
         events          = xEventGroupWaitBits(lvgl_port_ctx.lvgl_events, 0xFF, pdTRUE, pdFALSE, wait);
 
         if (lv_display_get_default() && lvgl_port_lock(0)) {
+            /* Calls from other tasks; whatever they change is drawn by the lv_timer_handler() below */
+            lvgl_port_call_t call;
+            while (xQueueReceive(lvgl_port_ctx.calls, &call, 0) == pdTRUE) {
+                call.cb(call.arg);
+            }
+
             /* Call read input devices */
             if (events & LVGL_PORT_EVENT_TOUCH) {
                 xSemaphoreTake(lvgl_port_ctx.timer_mux, portMAX_DELAY);
@@ -296,6 +340,9 @@ static void lvgl_port_task_deinit(void)
     if (lvgl_port_ctx.lvgl_events) {
         vEventGroupDelete(lvgl_port_ctx.lvgl_events);
     }
+    if (lvgl_port_ctx.calls) {
+        vQueueDelete(lvgl_port_ctx.calls);
+    }
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
 #if LV_ENABLE_GC || !LV_MEM_CUSTOM
     /* Deinitialize LVGL */
@@ -18,6 +18,8 @@
 #include "esp_lcd_panel_ops.h"
 #include "esp_lvgl_port.h"
 #include "esp_lvgl_port_priv.h"
+#include "esp_lvgl_port_rotate.h"
+#include "esp_lvgl_port_damage.h"
 #include "driver/ppa.h"
 #include "esp_heap_caps.h"
 #include "esp_private/esp_cache_private.h"
@@ -62,6 +64,11 @@ typedef struct {
     uint8_t* oled_buffer;
     lv_display_t* disp_drv; /* LVGL display driver */
     lv_display_rotation_t current_rotation;
+    lvgl_port_rotate_kernel_t rotate_kernel; /* Kernel of the SW rotation */
+    uint32_t rotate_tile;                    /* Tile edge of the tiled kernel, 0 for the default */
+    bool damage_merge;                       /* Merge invalidated areas before rendering */
+    lvgl_port_damage_t damage;               /* Areas invalidated in the current refresh cycle */
+    lvgl_port_damage_stats_t damage_stats;   /* Damage and flush counters */
     SemaphoreHandle_t trans_sem; /* Idle transfer mutex */
     struct {
         unsigned int monochrome : 1;   /* True, if display is monochrome and using 1bit for 1px */
@@ -95,6 +102,7 @@ static void lvgl_port_flush_callback(lv_display_t* drv, const lv_area_t* area, u
 static void lvgl_port_disp_size_update_callback(lv_event_t* e);
 static void lvgl_port_disp_rotation_update(lvgl_port_display_ctx_t* disp_ctx);
 static void lvgl_port_display_invalidate_callback(lv_event_t* e);
+static void lvgl_port_display_refr_ready_callback(lv_event_t* e);
 
 /*******************************************************************************
  * Public API functions
@@ -257,6 +265,49 @@ void lvgl_port_flush_ready(lv_display_t* disp)
     lv_disp_flush_ready(disp);
 }
 
+esp_err_t lvgl_port_set_rotate_kernel(lv_display_t* disp, lvgl_port_rotate_kernel_t kernel, uint32_t tile)
+{
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "Invalid display");
+    ESP_RETURN_ON_FALSE(kernel <= LVGL_PORT_ROTATE_KERNEL_PPA, ESP_ERR_INVALID_ARG, TAG, "Invalid rotation kernel");
+    ESP_RETURN_ON_FALSE(kernel != LVGL_PORT_ROTATE_KERNEL_PPA || ppa_srm_handle, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "PPA is not used by this display");
+    lvgl_port_display_ctx_t* disp_ctx = (lvgl_port_display_ctx_t*)lv_display_get_driver_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_ARG, TAG, "Invalid display");
+
+    /* The flush callback reads both under the lock */
+    lvgl_port_lock(0);
+    disp_ctx->rotate_kernel = kernel;
+    disp_ctx->rotate_tile   = tile;
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_set_damage_merge(lv_display_t* disp, uint32_t area_cost)
+{
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "Invalid display");
+    lvgl_port_display_ctx_t* disp_ctx = (lvgl_port_display_ctx_t*)lv_display_get_driver_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_ARG, TAG, "Invalid display");
+
+    /* Areas already collected stay as they are and are dropped at the end of the refresh cycle */
+    lvgl_port_lock(0);
+    disp_ctx->damage_merge     = (area_cost > 0);
+    disp_ctx->damage.area_cost = area_cost;
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_get_damage_stats(lv_display_t* disp, lvgl_port_damage_stats_t* stats)
+{
+    ESP_RETURN_ON_FALSE(disp && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    lvgl_port_display_ctx_t* disp_ctx = (lvgl_port_display_ctx_t*)lv_display_get_driver_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_ARG, TAG, "Invalid display");
+
+    lvgl_port_lock(0);
+    *stats = disp_ctx->damage_stats;
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
 /*******************************************************************************
  * Private functions
  *******************************************************************************/
@@ -313,6 +364,9 @@ static lv_display_t* lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t* disp
     disp_ctx->flags.swap_bytes  = disp_cfg->flags.swap_bytes;
     disp_ctx->flags.sw_rotate   = disp_cfg->flags.sw_rotate;
     disp_ctx->current_rotation  = LV_DISPLAY_ROTATION_0;
+    disp_ctx->rotate_kernel     = LVGL_PORT_ROTATE_KERNEL_AUTO;
+    disp_ctx->damage_merge      = true;
+    lvgl_port_damage_init(&disp_ctx->damage, LVGL_PORT_DAMAGE_AREA_COST_DEFAULT);
 
     uint32_t buff_caps = 0;
 #if SOC_PSRAM_DMA_CAPABLE == 0
@@ -414,6 +468,7 @@ static lv_display_t* lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t* disp
     lv_display_add_event_cb(disp, lvgl_port_disp_size_update_callback, LV_EVENT_RESOLUTION_CHANGED, disp_ctx);
     lv_display_add_event_cb(disp, lvgl_port_display_invalidate_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
     lv_display_add_event_cb(disp, lvgl_port_display_invalidate_callback, LV_EVENT_REFR_REQUEST, disp_ctx);
+    lv_display_add_event_cb(disp, lvgl_port_display_refr_ready_callback, LV_EVENT_REFR_READY, disp_ctx);
 
     lv_display_set_driver_data(disp, disp_ctx);
     disp_ctx->disp_drv = disp;
@@ -665,6 +720,50 @@ IRAM_ATTR static void rotate_copy_pixel(const uint16_t* from, uint16_t* to, uint
     ESP_ERROR_CHECK(ppa_do_scale_rotate_mirror(ppa_srm_handle, &oper_config));
 }
 
+/* Rotate the w x h area in color_map into dst with the kernel chosen for the display */
+static void lvgl_port_rotate_flush_area(lvgl_port_display_ctx_t* disp_ctx, const uint8_t* color_map, uint8_t* dst,
+                                        int32_t w, int32_t h, lv_color_format_t cf)
+{
+    const lv_display_rotation_t rotation = disp_ctx->current_rotation;
+    const uint32_t w_stride              = lv_draw_buf_width_to_stride(w, cf);
+    const uint32_t h_stride              = lv_draw_buf_width_to_stride(h, cf);
+    const uint32_t dst_stride            = (rotation == LV_DISPLAY_ROTATION_180) ? w_stride : h_stride;
+    /* The PPA is set up for the LV_COLOR_DEPTH format only */
+    const bool ppa_usable =
+        ppa_srm_handle && cf == ((LV_COLOR_DEPTH == 24) ? LV_COLOR_FORMAT_RGB888 : LV_COLOR_FORMAT_RGB565);
+
+    lvgl_port_rotate_kernel_t kernel = disp_ctx->rotate_kernel;
+    if (kernel == LVGL_PORT_ROTATE_KERNEL_AUTO) {
+        /* The PPA frees the CPU for the 90 degrees of the portrait panels, the tiled kernel does the rest */
+        kernel = (ppa_usable && rotation == LV_DISPLAY_ROTATION_90) ? LVGL_PORT_ROTATE_KERNEL_PPA
+                 : LVGL_PORT_ROTATE_KERNEL_TILED;
+    } else if (kernel == LVGL_PORT_ROTATE_KERNEL_PPA && !ppa_usable) {
+        kernel = LVGL_PORT_ROTATE_KERNEL_TILED;
+    }
+
+    switch (kernel) {
+        case LVGL_PORT_ROTATE_KERNEL_PPA: {
+            /* rotate_copy_pixel() counts its angles the other way round */
+            const uint16_t angle = (rotation == LV_DISPLAY_ROTATION_90)    ? 270
+                                   : (rotation == LV_DISPLAY_ROTATION_270) ? 90
+                                                                           : 180;
+            rotate_copy_pixel((const uint16_t*)color_map, (uint16_t*)dst, 0, 0, w - 1, h - 1, w, h, angle);
+            break;
+        }
+        case LVGL_PORT_ROTATE_KERNEL_LVGL:
+            lv_draw_sw_rotate(color_map, dst, w, h, w_stride, dst_stride, rotation, cf);
+            break;
+        case LVGL_PORT_ROTATE_KERNEL_REFERENCE:
+            lvgl_port_rotate_reference(color_map, dst, w, h, w_stride, dst_stride, (lvgl_port_rotate_angle_t)rotation,
+                                       lv_color_format_get_size(cf));
+            break;
+        default:
+            lvgl_port_rotate_tiled(color_map, dst, w, h, w_stride, dst_stride, (lvgl_port_rotate_angle_t)rotation,
+                                   lv_color_format_get_size(cf), disp_ctx->rotate_tile);
+            break;
+    }
+}
+
 static void lvgl_port_flush_callback(lv_display_t* drv, const lv_area_t* area, uint8_t* color_map)
 {
     assert(drv != NULL);
@@ -673,6 +772,9 @@ static void lvgl_port_flush_callback(lv_display_t* drv, const lv_area_t* area, u
     lvgl_port_display_ctx_t* disp_ctx = (lvgl_port_display_ctx_t*)lv_display_get_driver_data(drv);
     assert(disp_ctx != NULL);
 
+    disp_ctx->damage_stats.areas_out++;
+    disp_ctx->damage_stats.pixels_out += lv_area_get_size(area);
+
     int offsetx1 = area->x1;
     int offsetx2 = area->x2;
     int offsety1 = area->y1;
@@ -684,26 +786,9 @@ static void lvgl_port_flush_callback(lv_display_t* drv, const lv_area_t* area, u
     if (disp_ctx->flags.sw_rotate && (disp_ctx->current_rotation > LV_DISPLAY_ROTATION_0)) {
         /* SW rotation */
         if (disp_ctx->draw_buffs[2]) {
-            int32_t ww           = lv_area_get_width(area);
-            int32_t hh           = lv_area_get_height(area);
-            lv_color_format_t cf = lv_display_get_color_format(drv);
-            uint32_t w_stride    = lv_draw_buf_width_to_stride(ww, cf);
-            uint32_t h_stride    = lv_draw_buf_width_to_stride(hh, cf);
-            if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_180) {
-                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], hh, ww, h_stride, h_stride,
-                                  LV_DISPLAY_ROTATION_180, cf);
-            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_90) {
-                // printf("%ld %ld\n", w_stride, h_stride);
-                // lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride,
-                //                   LV_DISPLAY_ROTATION_90, cf);
-                // rotate_copy_pixel((uint16_t*)color_map, (uint16_t*)disp_ctx->draw_buffs[2], offsetx1, offsety1,
-                //                   offsetx2, offsety2, LV_HOR_RES, LV_VER_RES, 270);
-                rotate_copy_pixel((uint16_t*)color_map, (uint16_t*)disp_ctx->draw_buffs[2], 0, 0, offsetx2 - offsetx1,
-                                  offsety2 - offsety1, offsetx2 - offsetx1 + 1, offsety2 - offsety1 + 1, 270);
-            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_270) {
-                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride,
-                                  LV_DISPLAY_ROTATION_270, cf);
-            }
+            disp_ctx->damage_stats.pixels_rotated += lv_area_get_size(area);
+            lvgl_port_rotate_flush_area(disp_ctx, color_map, (uint8_t*)disp_ctx->draw_buffs[2], lv_area_get_width(area),
+                                        lv_area_get_height(area), lv_display_get_color_format(drv));
             color_map = (uint8_t*)disp_ctx->draw_buffs[2];
             lvgl_port_rotate_area(drv, (lv_area_t*)area);
             offsetx1 = area->x1;
@@ -871,6 +956,30 @@ static void lvgl_port_disp_size_update_callback(lv_event_t* e)
 
 static void lvgl_port_display_invalidate_callback(lv_event_t* e)
 {
+    if (lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        lvgl_port_display_ctx_t* disp_ctx = (lvgl_port_display_ctx_t*)lv_event_get_user_data(e);
+        lv_area_t* area                   = (lv_area_t*)lv_event_get_param(e);
+        disp_ctx->damage_stats.areas_in++;
+        disp_ctx->damage_stats.pixels_in += lv_area_get_size(area);
+        if (disp_ctx->damage_merge) {
+            /* LVGL saves the grown area; the ones merged into it lie inside it and are joined away before rendering */
+            lvgl_port_damage_area_t damage = {area->x1, area->y1, area->x2, area->y2};
+            disp_ctx->damage_stats.areas_merged += lvgl_port_damage_add(&disp_ctx->damage, &damage);
+            area->x1 = damage.x1;
+            area->y1 = damage.y1;
+            area->x2 = damage.x2;
+            area->y2 = damage.y2;
+        }
+    }
+
     /* Wake LVGL task, if needed */
     lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
 }
+
+static void lvgl_port_display_refr_ready_callback(lv_event_t* e)
+{
+    lvgl_port_display_ctx_t* disp_ctx = (lvgl_port_display_ctx_t*)lv_event_get_user_data(e);
+    /* LVGL has flushed and forgotten its invalidated areas, start the next cycle with none */
+    lvgl_port_damage_clear(&disp_ctx->damage);
+    disp_ctx->damage_stats.refreshes++;
+}
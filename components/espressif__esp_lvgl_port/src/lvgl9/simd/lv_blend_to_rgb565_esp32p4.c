@@ -0,0 +1,320 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// This is LVGL RGB565 fill and RGB565 image blend for ESP32P4 processor
+
+/*
+ * The kernels work on whole 32-bit words where they can: two RGB565 pixels per store for fills and copies, four mask
+ * bytes per load to skip transparent and copy opaque runs of glyph and shape masks at once. Mixing keeps LVGL's
+ * lv_color_16_16_mix() arithmetic, with the per-call parts (the spread foreground color, the rounded opacity) taken
+ * out of the loops and without its special-case branches, which give the same result as the plain formula. The output
+ * is bit-exact with LVGL's C code, as the simd test app checks.
+ *
+ * 1-bit (I1) glyphs reach the blender as A8 masks holding only 0x00 and 0xFF, so they take the word-wide paths.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+/* Mirrors asm_dsc_t from esp_lvgl_port_lv_blend.h, which needs LVGL headers */
+typedef struct {
+    uint32_t opa;
+    void *dst_buf;
+    uint32_t dst_w;
+    uint32_t dst_h;
+    uint32_t dst_stride;
+    const void *src_buf;
+    uint32_t src_stride;
+    const uint8_t *mask_buf;
+    uint32_t mask_stride;
+} asm_dsc_t;
+
+#define RESULT_OK     1         /* LV_RESULT_OK */
+#define RGB565_SPREAD 0x7E0F81F /* Green in the upper half-word, red and blue in the lower one, with headroom */
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static inline uint32_t rgb565_spread(uint16_t c)
+{
+    return ((uint32_t)c | ((uint32_t)c << 16)) & RGB565_SPREAD;
+}
+
+/* lv_color_16_16_mix() with fg already spread and mix already rounded to 0..32 */
+static inline uint16_t rgb565_mix(uint32_t fg, uint16_t c2, uint32_t mix32)
+{
+    const uint32_t bg     = rgb565_spread(c2);
+    const uint32_t result = ((((fg - bg) * mix32) >> 5) + bg) & RGB565_SPREAD;
+    return (uint16_t)((result >> 16) | result);
+}
+
+static inline uint32_t mix_to_32(uint32_t mix)
+{
+    return (mix + 4) >> 3;
+}
+
+static inline uint8_t *next_row(const void *buf, uint32_t stride)
+{
+    return (uint8_t *)buf + stride;
+}
+
+/* Fill w pixels starting at dst with color, two pixels per word store */
+static inline void fill_line(uint16_t *dst, int32_t w, uint16_t color, uint32_t color32)
+{
+    if (((uintptr_t)dst & 0x3) && w > 0) {
+        *dst++ = color;
+        w--;
+    }
+    uint32_t *dst32 = (uint32_t *)dst;
+    int32_t words   = w >> 1;
+    for (; words >= 4; words -= 4) {
+        dst32[0] = color32;
+        dst32[1] = color32;
+        dst32[2] = color32;
+        dst32[3] = color32;
+        dst32 += 4;
+    }
+    for (; words > 0; words--) {
+        *dst32++ = color32;
+    }
+    if (w & 1) {
+        *(uint16_t *)dst32 = color;
+    }
+}
+
+/* Returns 0 for 4 transparent mask bytes, 1 for 4 opaque ones, -1 otherwise; mask must be 4-byte aligned */
+static inline int mask_word_class(const uint8_t *mask)
+{
+    const uint32_t m = *(const uint32_t *)mask;
+    return m == 0 ? 0 : (m == 0xFFFFFFFF ? 1 : -1);
+}
+
+/*******************************************************************************
+ * Color fill
+ *******************************************************************************/
+
+int lv_color_blend_to_rgb565_esp(asm_dsc_t *dsc)
+{
+    const uint8_t *c       = dsc->src_buf; /* lv_color_t: blue, green, red */
+    const uint16_t color   = ((c[2] & 0xF8) << 8) | ((c[1] & 0xFC) << 3) | (c[0] >> 3);
+    const uint32_t color32 = color | ((uint32_t)color << 16);
+    uint8_t *dst           = dsc->dst_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        fill_line((uint16_t *)dst, dsc->dst_w, color, color32);
+        dst = next_row(dst, dsc->dst_stride);
+    }
+    return RESULT_OK;
+}
+
+int lv_color_blend_to_rgb565_with_opa_esp(asm_dsc_t *dsc)
+{
+    const uint8_t *c     = dsc->src_buf;
+    const uint16_t color = ((c[2] & 0xF8) << 8) | ((c[1] & 0xFC) << 3) | (c[0] >> 3);
+    const uint32_t fg    = rgb565_spread(color);
+    const uint32_t mix32 = mix_to_32(dsc->opa);
+    const int32_t w      = dsc->dst_w;
+    uint8_t *dst         = dsc->dst_buf;
+
+    /* Backgrounds under a translucent fill are mostly uniform: a pixel pair equal to the previous one gets the
+     * previous result. The cache starts from a black pair, so it needs no first-pair special case. */
+    uint32_t last_in  = 0;
+    uint32_t last_out = rgb565_mix(fg, 0, mix32) * 0x10001;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        uint16_t *px = (uint16_t *)dst;
+        int32_t x    = 0;
+        if (((uintptr_t)px & 0x3) && w > 0) {
+            px[0] = rgb565_mix(fg, px[0], mix32);
+            x     = 1;
+        }
+        for (; x + 2 <= w; x += 2) {
+            uint32_t *pair = (uint32_t *)&px[x];
+            if (*pair != last_in) {
+                last_in  = *pair;
+                last_out = rgb565_mix(fg, last_in & 0xFFFF, mix32) |
+                           ((uint32_t)rgb565_mix(fg, last_in >> 16, mix32) << 16);
+            }
+            *pair = last_out;
+        }
+        if (x < w) {
+            px[x] = rgb565_mix(fg, px[x], mix32);
+        }
+        dst = next_row(dst, dsc->dst_stride);
+    }
+    return RESULT_OK;
+}
+
+int lv_color_blend_to_rgb565_with_mask_esp(asm_dsc_t *dsc)
+{
+    const uint8_t *c       = dsc->src_buf;
+    const uint16_t color   = ((c[2] & 0xF8) << 8) | ((c[1] & 0xFC) << 3) | (c[0] >> 3);
+    const uint32_t color32 = color | ((uint32_t)color << 16);
+    const uint32_t fg      = rgb565_spread(color);
+    const int32_t w        = dsc->dst_w;
+    uint8_t *dst           = dsc->dst_buf;
+    const uint8_t *mask    = dsc->mask_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        uint16_t *px = (uint16_t *)dst;
+        int32_t x    = 0;
+        /* Up to the first mask word */
+        for (; x < w && ((uintptr_t)&mask[x] & 0x3); x++) {
+            px[x] = rgb565_mix(fg, px[x], mix_to_32(mask[x]));
+        }
+        for (; x + 4 <= w; x += 4) {
+            switch (mask_word_class(&mask[x])) {
+                case 0:
+                    break;
+                case 1:
+                    fill_line(&px[x], 4, color, color32);
+                    break;
+                default:
+                    px[x + 0] = rgb565_mix(fg, px[x + 0], mix_to_32(mask[x + 0]));
+                    px[x + 1] = rgb565_mix(fg, px[x + 1], mix_to_32(mask[x + 1]));
+                    px[x + 2] = rgb565_mix(fg, px[x + 2], mix_to_32(mask[x + 2]));
+                    px[x + 3] = rgb565_mix(fg, px[x + 3], mix_to_32(mask[x + 3]));
+                    break;
+            }
+        }
+        for (; x < w; x++) {
+            px[x] = rgb565_mix(fg, px[x], mix_to_32(mask[x]));
+        }
+        dst = next_row(dst, dsc->dst_stride);
+        mask += dsc->mask_stride;
+    }
+    return RESULT_OK;
+}
+
+int lv_color_blend_to_rgb565_mix_mask_opa_esp(asm_dsc_t *dsc)
+{
+    const uint8_t *c     = dsc->src_buf;
+    const uint16_t color = ((c[2] & 0xF8) << 8) | ((c[1] & 0xFC) << 3) | (c[0] >> 3);
+    const uint32_t fg    = rgb565_spread(color);
+    const uint32_t opa   = dsc->opa;
+    const int32_t w      = dsc->dst_w;
+    uint8_t *dst         = dsc->dst_buf;
+    const uint8_t *mask  = dsc->mask_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        uint16_t *px = (uint16_t *)dst;
+        int32_t x    = 0;
+        for (; x < w && ((uintptr_t)&mask[x] & 0x3); x++) {
+            px[x] = rgb565_mix(fg, px[x], mix_to_32((mask[x] * opa) >> 8));
+        }
+        for (; x + 4 <= w; x += 4) {
+            if (mask_word_class(&mask[x]) == 0) {
+                continue;
+            }
+            px[x + 0] = rgb565_mix(fg, px[x + 0], mix_to_32((mask[x + 0] * opa) >> 8));
+            px[x + 1] = rgb565_mix(fg, px[x + 1], mix_to_32((mask[x + 1] * opa) >> 8));
+            px[x + 2] = rgb565_mix(fg, px[x + 2], mix_to_32((mask[x + 2] * opa) >> 8));
+            px[x + 3] = rgb565_mix(fg, px[x + 3], mix_to_32((mask[x + 3] * opa) >> 8));
+        }
+        for (; x < w; x++) {
+            px[x] = rgb565_mix(fg, px[x], mix_to_32((mask[x] * opa) >> 8));
+        }
+        dst = next_row(dst, dsc->dst_stride);
+        mask += dsc->mask_stride;
+    }
+    return RESULT_OK;
+}
+
+/*******************************************************************************
+ * RGB565 image blend
+ *******************************************************************************/
+
+int lv_rgb565_blend_normal_to_rgb565_esp(asm_dsc_t *dsc)
+{
+    const uint32_t line_bytes = dsc->dst_w * sizeof(uint16_t);
+    uint8_t *dst              = dsc->dst_buf;
+    const uint8_t *src        = dsc->src_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        memcpy(dst, src, line_bytes);
+        dst = next_row(dst, dsc->dst_stride);
+        src = next_row(src, dsc->src_stride);
+    }
+    return RESULT_OK;
+}
+
+int lv_rgb565_blend_normal_to_rgb565_with_opa_esp(asm_dsc_t *dsc)
+{
+    const uint32_t mix32 = mix_to_32(dsc->opa);
+    uint8_t *dst         = dsc->dst_buf;
+    const uint8_t *src   = dsc->src_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        uint16_t *px        = (uint16_t *)dst;
+        const uint16_t *spx = (const uint16_t *)src;
+        for (uint32_t x = 0; x < dsc->dst_w; x++) {
+            px[x] = rgb565_mix(rgb565_spread(spx[x]), px[x], mix32);
+        }
+        dst = next_row(dst, dsc->dst_stride);
+        src = next_row(src, dsc->src_stride);
+    }
+    return RESULT_OK;
+}
+
+int lv_rgb565_blend_normal_to_rgb565_with_mask_esp(asm_dsc_t *dsc)
+{
+    const int32_t w     = dsc->dst_w;
+    uint8_t *dst        = dsc->dst_buf;
+    const uint8_t *src  = dsc->src_buf;
+    const uint8_t *mask = dsc->mask_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        uint16_t *px        = (uint16_t *)dst;
+        const uint16_t *spx = (const uint16_t *)src;
+        int32_t x           = 0;
+        for (; x < w && ((uintptr_t)&mask[x] & 0x3); x++) {
+            px[x] = rgb565_mix(rgb565_spread(spx[x]), px[x], mix_to_32(mask[x]));
+        }
+        for (; x + 4 <= w; x += 4) {
+            switch (mask_word_class(&mask[x])) {
+                case 0:
+                    break;
+                case 1:
+                    memcpy(&px[x], &spx[x], 4 * sizeof(uint16_t));
+                    break;
+                default:
+                    px[x + 0] = rgb565_mix(rgb565_spread(spx[x + 0]), px[x + 0], mix_to_32(mask[x + 0]));
+                    px[x + 1] = rgb565_mix(rgb565_spread(spx[x + 1]), px[x + 1], mix_to_32(mask[x + 1]));
+                    px[x + 2] = rgb565_mix(rgb565_spread(spx[x + 2]), px[x + 2], mix_to_32(mask[x + 2]));
+                    px[x + 3] = rgb565_mix(rgb565_spread(spx[x + 3]), px[x + 3], mix_to_32(mask[x + 3]));
+                    break;
+            }
+        }
+        for (; x < w; x++) {
+            px[x] = rgb565_mix(rgb565_spread(spx[x]), px[x], mix_to_32(mask[x]));
+        }
+        dst = next_row(dst, dsc->dst_stride);
+        src = next_row(src, dsc->src_stride);
+        mask += dsc->mask_stride;
+    }
+    return RESULT_OK;
+}
+
+int lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_esp(asm_dsc_t *dsc)
+{
+    const uint32_t opa  = dsc->opa;
+    uint8_t *dst        = dsc->dst_buf;
+    const uint8_t *src  = dsc->src_buf;
+    const uint8_t *mask = dsc->mask_buf;
+
+    for (uint32_t y = 0; y < dsc->dst_h; y++) {
+        uint16_t *px        = (uint16_t *)dst;
+        const uint16_t *spx = (const uint16_t *)src;
+        for (uint32_t x = 0; x < dsc->dst_w; x++) {
+            px[x] = rgb565_mix(rgb565_spread(spx[x]), px[x], mix_to_32((mask[x] * opa) >> 8));
+        }
+        dst = next_row(dst, dsc->dst_stride);
+        src = next_row(src, dsc->src_stride);
+        mask += dsc->mask_stride;
+    }
+    return RESULT_OK;
+}
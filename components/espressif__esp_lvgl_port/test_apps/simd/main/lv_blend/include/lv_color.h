@@ -43,7 +43,7 @@ extern "C" {
  * Opacity percentages.
  */
 
-typedef enum {
+enum _lv_opacity_level_t {
     LV_OPA_TRANSP = 0,
     LV_OPA_0      = 0,
     LV_OPA_10     = 25,
@@ -57,7 +57,13 @@ typedef enum {
     LV_OPA_90     = 229,
     LV_OPA_100    = 255,
     LV_OPA_COVER  = 255,
-} lv_opa_t;
+};
+
+#ifdef DOXYGEN
+typedef _lv_opacity_level_t lv_opa_t;
+#else
+typedef uint8_t lv_opa_t;
+#endif /*DOXYGEN*/
 
 #define LV_OPA_MIN 2   /*Opacities below this will be transparent*/
 #define LV_OPA_MAX 253 /*Opacities above this will fully cover*/
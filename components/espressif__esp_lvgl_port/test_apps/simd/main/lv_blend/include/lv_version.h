@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * This file is derived from the LVGL project.
+ * See https://github.com/lvgl/lvgl for details.
+ */
+
+/**
+ * @file lv_version.h
+ * The current version of LVGL, which the blend files in this folder are copied from
+ */
+
+#ifndef LVGL_VERSION_H
+#define LVGL_VERSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_VERSION_MAJOR 9
+#define LVGL_VERSION_MINOR 1
+#define LVGL_VERSION_PATCH 0
+#define LVGL_VERSION_INFO ""
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LVGL_VERSION_H*/
@@ -206,9 +206,7 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_color_to_argb8888(_lv_draw_sw_blend_
 
     /*Simple fill*/
     if (mask == NULL && opa >= LV_OPA_MAX) {
-        if (dsc->use_asm) {
-            LV_DRAW_SW_COLOR_BLEND_TO_ARGB8888(dsc);
-        } else {
+        if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_ARGB8888(dsc)) {
             uint32_t color32   = lv_color_to_u32(dsc->color);
             uint32_t *dest_buf = dsc->dest_buf;
             for (y = 0; y < h; y++) {
@@ -208,9 +208,7 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_color_to_rgb565(_lv_draw_sw_blend_fi
 
     /*Simple fill*/
     if (mask == NULL && opa >= LV_OPA_MAX) {
-        if (dsc->use_asm) {
-            LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc);
-        } else {
+        if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc)) {
             for (y = 0; y < h; y++) {
                 uint16_t *dest_end_final = dest_buf_u16 + w;
                 uint32_t *dest_end_mid   = (uint32_t *)((uint16_t *)dest_buf_u16 + ((w - 1) & ~(0xF)));
@@ -248,7 +246,7 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_color_to_rgb565(_lv_draw_sw_blend_fi
     }
     /*Opacity only*/
     else if (mask == NULL && opa < LV_OPA_MAX) {
-        if (LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc)) {
+        if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc)) {
             uint32_t last_dest32_color = dest_buf_u16[0] + 1; /*Set to value which is not equal to the first pixel*/
             uint32_t last_res32_color  = 0;
 
@@ -289,7 +287,7 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_color_to_rgb565(_lv_draw_sw_blend_fi
 
     /*Masked with full opacity*/
     else if (mask && opa >= LV_OPA_MAX) {
-        if (LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc)) {
+        if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc)) {
             for (y = 0; y < h; y++) {
                 x = 0;
                 if ((lv_uintptr_t)(mask)&0x1) {
@@ -319,7 +317,7 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_color_to_rgb565(_lv_draw_sw_blend_fi
     }
     /*Masked with opacity*/
     else if (mask && opa < LV_OPA_MAX) {
-        if (LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc)) {
+        if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc)) {
             for (y = 0; y < h; y++) {
                 for (x = 0; x < w; x++) {
                     dest_buf_u16[x] = lv_color_16_16_mix(color16, dest_buf_u16[x], LV_OPA_MIX2(mask[x], opa));
@@ -608,9 +606,7 @@ static void LV_ATTRIBUTE_FAST_MEM rgb565_image_blend(_lv_draw_sw_blend_image_dsc
 
     if (dsc->blend_mode == LV_BLEND_MODE_NORMAL) {
         if (mask_buf == NULL && opa >= LV_OPA_MAX) {
-            if (dsc->use_asm) {
-                LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc);
-            } else {
+            if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc)) {
                 uint32_t line_in_bytes = w * 2;
                 for (y = 0; y < h; y++) {
                     lv_memcpy(dest_buf_u16, src_buf_u16, line_in_bytes);
@@ -619,7 +615,7 @@ static void LV_ATTRIBUTE_FAST_MEM rgb565_image_blend(_lv_draw_sw_blend_image_dsc
                 }
             }
         } else if (mask_buf == NULL && opa < LV_OPA_MAX) {
-            if (LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc)) {
+            if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc)) {
                 for (y = 0; y < h; y++) {
                     for (x = 0; x < w; x++) {
                         dest_buf_u16[x] = lv_color_16_16_mix(src_buf_u16[x], dest_buf_u16[x], opa);
@@ -629,7 +625,7 @@ static void LV_ATTRIBUTE_FAST_MEM rgb565_image_blend(_lv_draw_sw_blend_image_dsc
                 }
             }
         } else if (mask_buf && opa >= LV_OPA_MAX) {
-            if (LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc)) {
+            if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc)) {
                 for (y = 0; y < h; y++) {
                     for (x = 0; x < w; x++) {
                         dest_buf_u16[x] = lv_color_16_16_mix(src_buf_u16[x], dest_buf_u16[x], mask_buf[x]);
@@ -640,7 +636,7 @@ static void LV_ATTRIBUTE_FAST_MEM rgb565_image_blend(_lv_draw_sw_blend_image_dsc
                 }
             }
         } else {
-            if (LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc)) {
+            if (!dsc->use_asm || LV_RESULT_INVALID == LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc)) {
                 for (y = 0; y < h; y++) {
                     for (x = 0; x < w; x++) {
                         dest_buf_u16[x] =
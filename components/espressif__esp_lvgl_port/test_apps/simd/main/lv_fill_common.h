@@ -8,6 +8,7 @@
 
 #include "esp_err.h"
 #include <stdint.h>
+#include <stdbool.h>
 #include "lv_color.h"
 #include "lv_draw_sw_blend.h"
 
@@ -41,6 +42,8 @@ typedef struct {
         void *p_ansi;        // pointer to the working ANSI test buf
         void *p_asm_alloc;   // pointer to the beginning of the memory allocated for ASM test buf, used in free()
         void *p_ansi_alloc;  // pointer to the beginning of the memory allocated for ANSI test buf, used in free()
+        void *p_mask;        // pointer to the A8 mask, NULL when the fill is not masked
+        void *p_mask_alloc;  // pointer to the beginning of the memory allocated for the mask, used in free()
     } buf;
     void (*blend_api_func)(_lv_draw_sw_blend_fill_dsc_t *);  // pointer to LVGL API function
     void (*blend_api_px_func)(_lv_draw_sw_blend_fill_dsc_t *,
@@ -53,6 +56,8 @@ typedef struct {
     unsigned int dest_h;        // Destination buffer height
     unsigned int dest_stride;   // Destination buffer stride
     unsigned int unalign_byte;  // Destination buffer memory unalignment
+    lv_opa_t opa;               // Fill opacity
+    bool use_mask;              // Blend through an A8 mask with transparent, opaque and partial runs
 } func_test_case_params_t;
 
 /**
@@ -67,6 +72,8 @@ typedef struct {
     unsigned int benchmark_cycles;  // Count of benchmark cycles
     void *array_align16;            // test array with 16 byte alignment - testing most ideal case
     void *array_align1;             // test array with 1 byte alignment - testing worst case
+    lv_opa_t opa;                   // Fill opacity
+    const lv_opa_t *mask;           // A8 mask of width x height, NULL for an unmasked fill
     void (*blend_api_func)(_lv_draw_sw_blend_fill_dsc_t *);  // pointer to LVGL API function
     void (*blend_api_px_func)(_lv_draw_sw_blend_fill_dsc_t *,
                               uint32_t);  // pointer to LVGL API function with dest_px_size argument
@@ -23,6 +23,8 @@ extern "C" {
 typedef enum {
     OPERATION_FILL,
     OPERATION_FILL_WITH_OPA,
+    OPERATION_FILL_WITH_MASK,
+    OPERATION_FILL_MIX_MASK_OPA,
 } blend_operation_t;
 
 /**
@@ -72,6 +74,8 @@ typedef struct {
                                     used in free() */
         void *p_dest_ansi_alloc; /*!< pointer to the beginning of the memory allocated for the destination ANSI test
                                     buf, used in free() */
+        void *p_mask;       /*!< pointer to the A8 mask, NULL for operations without a mask */
+        void *p_mask_alloc; /*!< pointer to the beginning of the memory allocated for the mask, used in free() */
     } buf;
     void (*blend_api_func)(_lv_draw_sw_blend_image_dsc_t *); /*!< pointer to LVGL API function */
     lv_color_format_t color_format;                          /*!< LV color format */
@@ -109,6 +113,8 @@ typedef struct {
     void *src_array_align1;        /*!< Source test array with 1 byte alignment - testing worst case */
     void *dest_array_align16;      /*!< Destination test array with 16 byte alignment - testing most ideal case */
     void *dest_array_align1;       /*!< Destination test array with 1 byte alignment - testing worst case */
+    lv_opa_t opa;                  /*!< Image opacity */
+    const lv_opa_t *mask;          /*!< A8 mask of width x height, NULL for an unmasked blend */
     void (*blend_api_func)(_lv_draw_sw_blend_image_dsc_t *); /*!< pointer to LVGL API function */
 } bench_test_case_lv_image_params_t;
 
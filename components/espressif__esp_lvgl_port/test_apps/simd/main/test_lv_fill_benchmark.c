@@ -10,7 +10,7 @@
 
 #include "unity.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"  // for xthal_get_ccount()
+#include "esp_cpu.h"  // for esp_cpu_get_cycle_count(), on Xtensa and RISC-V
 #include "lv_fill_common.h"
 #include "lv_draw_sw_blend.h"
 #include "lv_draw_sw_blend_to_argb8888.h"
@@ -88,6 +88,7 @@ TEST_CASE("LV Fill benchmark ARGB8888", "[fill][benchmark][ARGB8888]")
         .benchmark_cycles = BENCHMARK_CYCLES,
         .array_align16    = (void *)dest_array_align16,
         .array_align1     = (void *)dest_array_align1,
+        .opa              = LV_OPA_MAX,
         .blend_api_func   = &lv_draw_sw_blend_color_to_argb8888,
     };
 
@@ -113,6 +114,7 @@ TEST_CASE("LV Fill benchmark RGB565", "[fill][benchmark][RGB565]")
         .benchmark_cycles = BENCHMARK_CYCLES,
         .array_align16    = (void *)dest_array_align16,
         .array_align1     = (void *)dest_array_align1,
+        .opa              = LV_OPA_MAX,
         .blend_api_func   = &lv_draw_sw_blend_color_to_rgb565,
     };
 
@@ -121,6 +123,50 @@ TEST_CASE("LV Fill benchmark RGB565", "[fill][benchmark][RGB565]")
     free(dest_array_align16);
 }
 
+TEST_CASE("LV Fill benchmark RGB565 with opacity and mask", "[fill][benchmark][RGB565]")
+{
+    uint16_t *dest_array_align16 = (uint16_t *)memalign(16, STRIDE * HEIGHT * sizeof(uint16_t) + UNALIGN_BYTES);
+    uint8_t *mask                = (uint8_t *)memalign(16, WIDTH * HEIGHT);
+    TEST_ASSERT_NOT_EQUAL(NULL, dest_array_align16);
+    TEST_ASSERT_NOT_EQUAL(NULL, mask);
+
+    // Glyph-like mask: transparent gaps, opaque strokes and anti-aliased edges
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        const int x = i % WIDTH;
+        mask[i]     = (x % 16 < 6) ? LV_OPA_TRANSP : ((x % 16 < 12) ? LV_OPA_COVER : (uint8_t)(x * 16));
+    }
+
+    // Apply byte unalignment for the worst-case test scenario
+    uint16_t *dest_array_align1 = dest_array_align16 + UNALIGN_BYTES;
+
+    bench_test_case_params_t test_params = {
+        .height           = HEIGHT,
+        .width            = WIDTH,
+        .stride           = STRIDE * sizeof(uint16_t),
+        .cc_height        = HEIGHT - 1,
+        .cc_width         = WIDTH - 1,
+        .benchmark_cycles = BENCHMARK_CYCLES,
+        .array_align16    = (void *)dest_array_align16,
+        .array_align1     = (void *)dest_array_align1,
+        .opa              = LV_OPA_50,
+        .blend_api_func   = &lv_draw_sw_blend_color_to_rgb565,
+    };
+
+    ESP_LOGI(TAG_LV_FILL_BENCH, "running test for RGB565 color format with opacity");
+    lv_fill_benchmark_init(&test_params);
+
+    test_params.opa  = LV_OPA_MAX;
+    test_params.mask = mask;
+    ESP_LOGI(TAG_LV_FILL_BENCH, "running test for RGB565 color format with mask");
+    lv_fill_benchmark_init(&test_params);
+
+    test_params.opa = LV_OPA_50;
+    ESP_LOGI(TAG_LV_FILL_BENCH, "running test for RGB565 color format with mask and opacity");
+    lv_fill_benchmark_init(&test_params);
+    free(dest_array_align16);
+    free(mask);
+}
+
 TEST_CASE("LV Fill benchmark RGB888", "[fill][benchmark][RGB888]")
 {
     uint8_t *dest_array_align16 = (uint8_t *)memalign(16, STRIDE * HEIGHT * sizeof(uint8_t) * 3 + UNALIGN_BYTES);
@@ -138,6 +184,7 @@ TEST_CASE("LV Fill benchmark RGB888", "[fill][benchmark][RGB888]")
         .benchmark_cycles  = BENCHMARK_CYCLES,
         .array_align16     = (void *)dest_array_align16,
         .array_align1      = (void *)dest_array_align1,
+        .opa               = LV_OPA_MAX,
         .blend_api_px_func = &lv_draw_sw_blend_color_to_rgb888,
     };
 
@@ -155,9 +202,10 @@ static void lv_fill_benchmark_init(bench_test_case_params_t *test_params)
         .dest_w      = test_params->width,
         .dest_h      = test_params->height,
         .dest_stride = test_params->stride,  // stride * sizeof()
-        .mask_buf    = NULL,
+        .mask_buf    = test_params->mask,
+        .mask_stride = test_params->width,
         .color       = test_color,
-        .opa         = LV_OPA_MAX,
+        .opa         = test_params->opa,
         .use_asm     = true,
     };
 
@@ -201,7 +249,7 @@ static float lv_fill_benchmark_run(bench_test_case_params_t *test_params, _lv_dr
         test_params->blend_api_px_func(dsc, 3);
     }
 
-    const unsigned int start_b = xthal_get_ccount();
+    const unsigned int start_b = esp_cpu_get_cycle_count();
     if (test_params->blend_api_func != NULL) {
         for (int i = 0; i < test_params->benchmark_cycles; i++) {
             test_params->blend_api_func(dsc);
@@ -211,7 +259,7 @@ static float lv_fill_benchmark_run(bench_test_case_params_t *test_params, _lv_dr
             test_params->blend_api_px_func(dsc, 3);
         }
     }
-    const unsigned int end_b = xthal_get_ccount();
+    const unsigned int end_b = esp_cpu_get_cycle_count();
 
     const float total_b = end_b - start_b;
     const float cycles  = total_b / (test_params->benchmark_cycles);
@@ -127,6 +127,7 @@ TEST_CASE("Test fill functionality ARGB8888", "[fill][functionality][ARGB8888]")
         .blend_api_func = &lv_draw_sw_blend_color_to_argb8888,
         .color_format   = LV_COLOR_FORMAT_ARGB8888,
         .data_type_size = sizeof(uint32_t),
+        .opa            = LV_OPA_MAX,
     };
 
     ESP_LOGI(TAG_LV_FILL_FUNC, "running test for ARGB8888 color format");
@@ -151,12 +152,75 @@ TEST_CASE("Test fill functionality RGB565", "[fill][functionality][RGB565]")
         .blend_api_func = &lv_draw_sw_blend_color_to_rgb565,
         .color_format   = LV_COLOR_FORMAT_RGB565,
         .data_type_size = sizeof(uint16_t),
+        .opa            = LV_OPA_MAX,
     };
 
     ESP_LOGI(TAG_LV_FILL_FUNC, "running test for RGB565 color format");
     functionality_test_matrix(&test_matrix, &test_case);
 }
 
+TEST_CASE("Test fill functionality RGB565 with opacity", "[fill][functionality][RGB565]")
+{
+    test_matrix_params_t test_matrix = {
+        .min_w                   = 1,
+        .min_h                   = 1,
+        .max_w                   = 32,
+        .max_h                   = 4,
+        .min_unalign_byte        = 0,
+        .max_unalign_byte        = 16,
+        .unalign_step            = 1,
+        .dest_stride_step        = 1,
+        .test_combinations_count = 0,
+    };
+
+    func_test_case_params_t test_case = {
+        .blend_api_func = &lv_draw_sw_blend_color_to_rgb565,
+        .color_format   = LV_COLOR_FORMAT_RGB565,
+        .data_type_size = sizeof(uint16_t),
+    };
+
+    // Opacities rounding to different mix steps
+    const lv_opa_t opas[] = {LV_OPA_20, LV_OPA_50, LV_OPA_80};
+    for (int i = 0; i < sizeof(opas) / sizeof(opas[0]); i++) {
+        test_case.opa                       = opas[i];
+        test_matrix.test_combinations_count = 0;
+        ESP_LOGI(TAG_LV_FILL_FUNC, "running test for RGB565 color format with opacity %d", opas[i]);
+        functionality_test_matrix(&test_matrix, &test_case);
+    }
+}
+
+TEST_CASE("Test fill functionality RGB565 with mask", "[fill][functionality][RGB565]")
+{
+    test_matrix_params_t test_matrix = {
+        .min_w                   = 1,
+        .min_h                   = 1,
+        .max_w                   = 32,
+        .max_h                   = 4,
+        .min_unalign_byte        = 0,
+        .max_unalign_byte        = 16,
+        .unalign_step            = 1,
+        .dest_stride_step        = 1,
+        .test_combinations_count = 0,
+    };
+
+    func_test_case_params_t test_case = {
+        .blend_api_func = &lv_draw_sw_blend_color_to_rgb565,
+        .color_format   = LV_COLOR_FORMAT_RGB565,
+        .data_type_size = sizeof(uint16_t),
+        .opa            = LV_OPA_MAX,
+        .use_mask       = true,
+    };
+
+    ESP_LOGI(TAG_LV_FILL_FUNC, "running test for RGB565 color format with mask");
+    functionality_test_matrix(&test_matrix, &test_case);
+
+    // Glyph masks: opacity on top of the mask
+    test_case.opa                       = LV_OPA_70;
+    test_matrix.test_combinations_count = 0;
+    ESP_LOGI(TAG_LV_FILL_FUNC, "running test for RGB565 color format with mask and opacity");
+    functionality_test_matrix(&test_matrix, &test_case);
+}
+
 TEST_CASE("Test fill functionality RGB888", "[fill][functionality][RGB888]")
 {
     test_matrix_params_t test_matrix = {
@@ -175,6 +239,7 @@ TEST_CASE("Test fill functionality RGB888", "[fill][functionality][RGB888]")
         .blend_api_px_func = &lv_draw_sw_blend_color_to_rgb888,
         .color_format      = LV_COLOR_FORMAT_RGB888,
         .data_type_size    = sizeof(uint8_t) * 3,  // 24-bit data length
+        .opa               = LV_OPA_MAX,
     };
 
     ESP_LOGI(TAG_LV_FILL_FUNC, "running test for RGB888 color format");
@@ -214,9 +279,10 @@ static void lv_fill_functionality(func_test_case_params_t *test_case)
         .dest_w      = test_case->dest_w,
         .dest_h      = test_case->dest_h,
         .dest_stride = test_case->dest_stride * test_case->data_type_size,  // stride * sizeof()
-        .mask_buf    = NULL,
+        .mask_buf    = test_case->buf.p_mask,
+        .mask_stride = test_case->dest_w,
         .color       = test_color,
-        .opa         = LV_OPA_MAX,
+        .opa         = test_case->opa,
         .use_asm     = true,
     };
 
@@ -238,8 +304,9 @@ static void lv_fill_functionality(func_test_case_params_t *test_case)
     test_case->buf.p_ansi -= CANARY_BYTES * test_case->data_type_size;
 
     // Evaluate the results
-    sprintf(test_msg_buf, "Test case: dest_w = %d, dest_h = %d, dest_stride = %d, unalign_byte = %d\n",
-            test_case->dest_w, test_case->dest_h, test_case->dest_stride, test_case->unalign_byte);
+    sprintf(test_msg_buf, "Test case: dest_w = %d, dest_h = %d, dest_stride = %d, unalign_byte = %d, opa = %d%s\n",
+            test_case->dest_w, test_case->dest_h, test_case->dest_stride, test_case->unalign_byte, test_case->opa,
+            test_case->use_mask ? ", masked" : "");
 
     switch (test_case->color_format) {
         case LV_COLOR_FORMAT_ARGB8888: {
@@ -263,6 +330,7 @@ static void lv_fill_functionality(func_test_case_params_t *test_case)
 
     free(test_case->buf.p_asm_alloc);
     free(test_case->buf.p_ansi_alloc);
+    free(test_case->buf.p_mask_alloc);
 }
 
 static void fill_test_bufs(func_test_case_params_t *test_case)
@@ -305,6 +373,31 @@ static void fill_test_bufs(func_test_case_params_t *test_case)
     // Save a pointer to the working part of the memory, where the test data are stored
     test_case->buf.p_asm  = (void *)dest_buf_asm;
     test_case->buf.p_ansi = (void *)dest_buf_ansi;
+
+    test_case->buf.p_mask       = NULL;
+    test_case->buf.p_mask_alloc = NULL;
+    if (test_case->use_mask) {
+        // Runs of 8 transparent, opaque and partial mask bytes, like a glyph, starting at the same unalignment
+        const size_t mask_len = test_case->dest_w * test_case->dest_h;
+        uint8_t *mem_mask     = memalign(16, mask_len + unalign_byte);
+        TEST_ASSERT_NOT_NULL_MESSAGE(mem_mask, "Lack of memory");
+        uint8_t *mask = mem_mask + unalign_byte;
+        for (int i = 0; i < mask_len; i++) {
+            switch ((i / 8) % 3) {
+                case 0:
+                    mask[i] = LV_OPA_TRANSP;
+                    break;
+                case 1:
+                    mask[i] = LV_OPA_COVER;
+                    break;
+                default:
+                    mask[i] = (uint8_t)(i * 37);
+                    break;
+            }
+        }
+        test_case->buf.p_mask_alloc = mem_mask;
+        test_case->buf.p_mask       = mask;
+    }
 }
 
 static void test_eval_32bit_data(func_test_case_params_t *test_case)
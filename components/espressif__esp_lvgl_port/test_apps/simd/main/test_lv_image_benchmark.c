@@ -10,7 +10,7 @@
 
 #include "unity.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"  // for xthal_get_ccount()
+#include "esp_cpu.h"  // for esp_cpu_get_cycle_count(), on Xtensa and RISC-V
 #include "lv_image_common.h"
 #include "lv_draw_sw_blend.h"
 #include "lv_draw_sw_blend_to_rgb565.h"
@@ -108,6 +108,7 @@ TEST_CASE("LV Image benchmark RGB565 blend to RGB565", "[image][benchmark][RGB56
         .src_array_align1   = (void *)src_array_align1,
         .dest_array_align16 = (void *)dest_array_align16,
         .dest_array_align1  = (void *)dest_array_align1,
+        .opa                = LV_OPA_MAX,
         .blend_api_func     = &lv_draw_sw_blend_image_to_rgb565,
     };
 
@@ -116,6 +117,63 @@ TEST_CASE("LV Image benchmark RGB565 blend to RGB565", "[image][benchmark][RGB56
     free(dest_array_align16);
     free(src_array_align16);
 }
+
+TEST_CASE("LV Image benchmark RGB565 blend to RGB565 with opacity and mask", "[image][benchmark][RGB565]")
+{
+    uint16_t *dest_array_align16 = (uint16_t *)memalign(16, STRIDE * HEIGHT * sizeof(uint16_t) + UNALIGN_BYTES);
+    uint16_t *src_array_align16  = (uint16_t *)memalign(16, STRIDE * HEIGHT * sizeof(uint16_t) + UNALIGN_BYTES);
+    uint8_t *mask                = (uint8_t *)memalign(16, WIDTH * HEIGHT);
+    TEST_ASSERT_NOT_EQUAL(NULL, dest_array_align16);
+    TEST_ASSERT_NOT_EQUAL(NULL, src_array_align16);
+    TEST_ASSERT_NOT_EQUAL(NULL, mask);
+
+    // Rounded-corner like mask: mostly opaque, transparent and anti-aliased at the line ends
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        const int x = i % WIDTH;
+        if (x < 8 || x >= WIDTH - 8) {
+            mask[i] = LV_OPA_TRANSP;
+        } else if (x < 12 || x >= WIDTH - 12) {
+            mask[i] = (uint8_t)(x * 20);
+        } else {
+            mask[i] = LV_OPA_COVER;
+        }
+    }
+
+    // Apply byte unalignment (different for each array) for the worst-case test scenario
+    uint16_t *dest_array_align1 = (uint16_t *)((uint8_t *)dest_array_align16 + UNALIGN_BYTES - 1);
+    uint16_t *src_array_align1  = (uint16_t *)((uint8_t *)src_array_align16 + UNALIGN_BYTES);
+
+    bench_test_case_lv_image_params_t test_params = {
+        .height             = HEIGHT,
+        .width              = WIDTH,
+        .dest_stride        = STRIDE * sizeof(uint16_t),
+        .src_stride         = STRIDE * sizeof(uint16_t),
+        .cc_height          = HEIGHT,
+        .cc_width           = WIDTH - 1,
+        .benchmark_cycles   = BENCHMARK_CYCLES,
+        .src_array_align16  = (void *)src_array_align16,
+        .src_array_align1   = (void *)src_array_align1,
+        .dest_array_align16 = (void *)dest_array_align16,
+        .dest_array_align1  = (void *)dest_array_align1,
+        .opa                = LV_OPA_50,
+        .blend_api_func     = &lv_draw_sw_blend_image_to_rgb565,
+    };
+
+    ESP_LOGI(TAG_LV_IMAGE_BENCH, "running test for RGB565 color format with opacity");
+    lv_image_benchmark_init(&test_params);
+
+    test_params.opa  = LV_OPA_MAX;
+    test_params.mask = mask;
+    ESP_LOGI(TAG_LV_IMAGE_BENCH, "running test for RGB565 color format with mask");
+    lv_image_benchmark_init(&test_params);
+
+    test_params.opa = LV_OPA_50;
+    ESP_LOGI(TAG_LV_IMAGE_BENCH, "running test for RGB565 color format with mask and opacity");
+    lv_image_benchmark_init(&test_params);
+    free(dest_array_align16);
+    free(src_array_align16);
+    free(mask);
+}
 // ------------------------------------------------ Static test functions ----------------------------------------------
 
 static void lv_image_benchmark_init(bench_test_case_lv_image_params_t *test_params)
@@ -126,11 +184,12 @@ static void lv_image_benchmark_init(bench_test_case_lv_image_params_t *test_para
         .dest_w           = test_params->width,
         .dest_h           = test_params->height,
         .dest_stride      = test_params->dest_stride,  // stride * sizeof()
-        .mask_buf         = NULL,
+        .mask_buf         = test_params->mask,
+        .mask_stride      = test_params->width,
         .src_buf          = test_params->src_array_align16,
         .src_stride       = test_params->src_stride,
         .src_color_format = LV_COLOR_FORMAT_RGB565,
-        .opa              = LV_OPA_MAX,
+        .opa              = test_params->opa,
         .blend_mode       = LV_BLEND_MODE_NORMAL,
         .use_asm          = true,
     };
@@ -170,11 +229,11 @@ static float lv_image_benchmark_run(bench_test_case_lv_image_params_t *test_para
     // Call the DUT function for the first time to init the benchmark test
     test_params->blend_api_func(dsc);
 
-    const unsigned int start_b = xthal_get_ccount();
+    const unsigned int start_b = esp_cpu_get_cycle_count();
     for (int i = 0; i < test_params->benchmark_cycles; i++) {
         test_params->blend_api_func(dsc);
     }
-    const unsigned int end_b = xthal_get_ccount();
+    const unsigned int end_b = esp_cpu_get_cycle_count();
 
     const float total_b = end_b - start_b;
     const float cycles  = total_b / (test_params->benchmark_cycles);
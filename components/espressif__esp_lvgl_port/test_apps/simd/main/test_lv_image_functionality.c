@@ -139,6 +139,27 @@ TEST_CASE("LV Image functionality RGB565 blend to RGB565", "[image][functionalit
     functionality_test_matrix(&test_matrix, &test_case);
 }
 
+TEST_CASE("LV Image functionality RGB565 blend to RGB565 with opacity and mask", "[image][functionality][RGB565]")
+{
+    const blend_operation_t operations[]       = {OPERATION_FILL_WITH_OPA, OPERATION_FILL_WITH_MASK,
+                                                  OPERATION_FILL_MIX_MASK_OPA};
+    const char *operation_names[]              = {"opacity", "mask", "mask and opacity"};
+    func_test_case_lv_image_params_t test_case = {
+        .blend_api_func      = &lv_draw_sw_blend_image_to_rgb565,
+        .color_format        = LV_COLOR_FORMAT_RGB565,
+        .canary_pixels       = CANARY_PIXELS_RGB565,
+        .src_data_type_size  = sizeof(uint16_t),
+        .dest_data_type_size = sizeof(uint16_t),
+    };
+
+    for (int i = 0; i < sizeof(operations) / sizeof(operations[0]); i++) {
+        test_matrix_lv_image_params_t test_matrix = default_test_matrix_image_rgb565_blend_rgb565;
+        test_case.operation_type                  = operations[i];
+        ESP_LOGI(TAG_LV_IMAGE_FUNC, "running test for RGB565 color format with %s", operation_names[i]);
+        functionality_test_matrix(&test_matrix, &test_case);
+    }
+}
+
 // ------------------------------------------------ Static test functions ----------------------------------------------
 
 static void functionality_test_matrix(test_matrix_lv_image_params_t *test_matrix,
@@ -184,12 +205,15 @@ static void lv_image_functionality(func_test_case_lv_image_params_t *test_case)
         .dest_w           = test_case->dest_w,
         .dest_h           = test_case->dest_h,
         .dest_stride      = test_case->dest_stride * test_case->dest_data_type_size,  // dest_stride * sizeof(data_type)
-        .mask_buf         = NULL,
-        .mask_stride      = 0,
+        .mask_buf         = test_case->buf.p_mask,
+        .mask_stride      = test_case->buf.p_mask ? test_case->dest_w : 0,
         .src_buf          = test_case->buf.p_src,
         .src_stride       = test_case->src_stride * test_case->src_data_type_size,  // src_stride * sizeof(data_type)
         .src_color_format = test_case->color_format,
-        .opa              = LV_OPA_MAX,
+        .opa              = (test_case->operation_type == OPERATION_FILL_WITH_OPA ||
+                             test_case->operation_type == OPERATION_FILL_MIX_MASK_OPA)
+                                ? LV_OPA_60
+                                : LV_OPA_MAX,
         .blend_mode       = LV_BLEND_MODE_NORMAL,
         .use_asm          = true,
     };
@@ -209,9 +233,9 @@ static void lv_image_functionality(func_test_case_lv_image_params_t *test_case)
     // Evaluate the results
     sprintf(test_msg_buf,
             "Test case: dest_w = %d, dest_h = %d, dest_stride = %d, src_stride = %d, dest_unalign_byte = %d, "
-            "src_unalign_byte = %d\n",
+            "src_unalign_byte = %d, operation = %d\n",
             test_case->dest_w, test_case->dest_h, test_case->dest_stride, test_case->src_stride,
-            test_case->dest_unalign_byte, test_case->src_unalign_byte);
+            test_case->dest_unalign_byte, test_case->src_unalign_byte, test_case->operation_type);
 #if DBG_PRINT_OUTPUT
     printf("%s\n", test_msg_buf);
 #endif
@@ -228,6 +252,7 @@ static void lv_image_functionality(func_test_case_lv_image_params_t *test_case)
     free(test_case->buf.p_dest_asm_alloc);
     free(test_case->buf.p_dest_ansi_alloc);
     free(test_case->buf.p_src_alloc);
+    free(test_case->buf.p_mask_alloc);
 }
 
 static void fill_test_bufs(func_test_case_lv_image_params_t *test_case)
@@ -272,6 +297,9 @@ static void fill_test_bufs(func_test_case_lv_image_params_t *test_case)
 
     switch (test_case->operation_type) {
         case OPERATION_FILL:
+        case OPERATION_FILL_WITH_OPA:
+        case OPERATION_FILL_WITH_MASK:
+        case OPERATION_FILL_MIX_MASK_OPA:
             // Fill the actual part of the destination buffers with known values,
             // Values must be same, because of the stride
 
@@ -307,6 +335,32 @@ static void fill_test_bufs(func_test_case_lv_image_params_t *test_case)
     test_case->buf.p_dest_asm  = (void *)dest_buf_asm;
     test_case->buf.p_dest_ansi = (void *)dest_buf_ansi;
 
+    test_case->buf.p_mask       = NULL;
+    test_case->buf.p_mask_alloc = NULL;
+    if (test_case->operation_type == OPERATION_FILL_WITH_MASK ||
+        test_case->operation_type == OPERATION_FILL_MIX_MASK_OPA) {
+        // Runs of 8 transparent, opaque and partial mask bytes, with the source unalignment
+        const size_t mask_len = test_case->dest_w * test_case->dest_h;
+        uint8_t *mem_mask     = memalign(16, mask_len + src_unalign_byte);
+        TEST_ASSERT_NOT_NULL_MESSAGE(mem_mask, "Lack of memory");
+        uint8_t *mask = mem_mask + src_unalign_byte;
+        for (int i = 0; i < mask_len; i++) {
+            switch ((i / 8) % 3) {
+                case 0:
+                    mask[i] = LV_OPA_TRANSP;
+                    break;
+                case 1:
+                    mask[i] = LV_OPA_COVER;
+                    break;
+                default:
+                    mask[i] = (uint8_t)(i * 37);
+                    break;
+            }
+        }
+        test_case->buf.p_mask_alloc = mem_mask;
+        test_case->buf.p_mask       = mask;
+    }
+
 #if DBG_PRINT_OUTPUT
     printf("Destination buffers fill:\n");
     for (uint32_t i = 0; i < test_case->active_dest_buf_len; i++) {
@@ -357,12 +411,15 @@ static void test_eval_image_16bit_data(func_test_case_lv_image_params_t *test_ca
                                            test_case->active_dest_buf_len, test_msg_buf);
 
     // Data part of the destination buffer and source buffer (not considering matrix padding) must be equal
-    uint16_t *dest_row_begin = (uint16_t *)test_case->buf.p_dest_asm + canary_pixels;
-    uint16_t *src_row_begin  = (uint16_t *)test_case->buf.p_src;
-    for (int row = 0; row < test_case->dest_h; row++) {
-        TEST_ASSERT_EQUAL_UINT16_ARRAY_MESSAGE(dest_row_begin, src_row_begin, test_case->dest_w, test_msg_buf);
-        dest_row_begin += test_case->dest_stride;  // Move pointer of the destination buffer to the next row
-        src_row_begin += test_case->src_stride;    // Move pointer of the source buffer to the next row
+    // after a plain copy
+    if (test_case->operation_type == OPERATION_FILL) {
+        uint16_t *dest_row_begin = (uint16_t *)test_case->buf.p_dest_asm + canary_pixels;
+        uint16_t *src_row_begin  = (uint16_t *)test_case->buf.p_src;
+        for (int row = 0; row < test_case->dest_h; row++) {
+            TEST_ASSERT_EQUAL_UINT16_ARRAY_MESSAGE(dest_row_begin, src_row_begin, test_case->dest_w, test_msg_buf);
+            dest_row_begin += test_case->dest_stride;  // Move pointer of the destination buffer to the next row
+            src_row_begin += test_case->src_stride;    // Move pointer of the source buffer to the next row
+        }
     }
 
     // Canary pixels area must stay 0
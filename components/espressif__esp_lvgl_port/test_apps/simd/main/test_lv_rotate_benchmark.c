@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <sdkconfig.h>
+
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"  // for esp_cpu_get_cycle_count(), on Xtensa and RISC-V
+#include "esp_heap_caps.h"
+#include "esp_lvgl_port_rotate.h"
+
+#define SMALL_WIDTH      128
+#define SMALL_HEIGHT     128
+#define BAND_WIDTH       720  // A flush band of a 720 x 1280 portrait panel
+#define BAND_HEIGHT      128
+#define BENCHMARK_CYCLES 20
+
+// ------------------------------------------------- Macros and Types --------------------------------------------------
+
+static const char *TAG_LV_ROTATE_BENCH = "LV Rotate Benchmark";
+static const char *angle_names[]       = {"0", "90", "180", "270"};
+static const uint32_t bench_tiles[]    = {LVGL_PORT_ROTATE_TILE_MIN, 16, LVGL_PORT_ROTATE_TILE_MAX};
+
+// ------------------------------------------------ Static function headers --------------------------------------------
+
+/**
+ * @brief Allocate the buffers and benchmark every angle
+ *
+ * @param[in] caps Memory the buffers are allocated from
+ */
+static void lv_rotate_benchmark_init(int32_t w, int32_t h, uint32_t px_size, uint32_t caps);
+
+/**
+ * @brief Run the benchmark test
+ *
+ * @param[in] tile Tile edge, or 0 to run the reference kernel
+ * @return Cycles per pixel
+ */
+static float lv_rotate_benchmark_run(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, uint32_t px_size,
+                                     lvgl_port_rotate_angle_t angle, uint32_t tile);
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Benchmark tests
+
+Requires:
+    - To pass functionality tests first
+
+Purpose:
+    - Test that the tiled rotation kernel is faster than the pixel by pixel reference, and find the best tile edge
+
+Procedure:
+    - Allocate a source and a destination block, in internal RAM and, where there is one, in PSRAM like the
+draw buffers of a large panel
+    - Rotate by 90, 180 and 270 degrees with the reference kernel multiple times, counting CPU cycles
+    - Repeat with the tiled kernel for every tile edge
+    - Print cycles per pixel of every run
+*/
+
+// ------------------------------------------------ Test cases stages --------------------------------------------------
+
+TEST_CASE("LV Rotate benchmark RGB565", "[rotate][benchmark][RGB565]")
+{
+    ESP_LOGI(TAG_LV_ROTATE_BENCH, "running test for RGB565 color format, internal RAM");
+    lv_rotate_benchmark_init(SMALL_WIDTH, SMALL_HEIGHT, 2, MALLOC_CAP_INTERNAL);
+    ESP_LOGI(TAG_LV_ROTATE_BENCH, "running test for RGB565 color format, PSRAM");
+    lv_rotate_benchmark_init(BAND_WIDTH, BAND_HEIGHT, 2, MALLOC_CAP_SPIRAM);
+}
+
+TEST_CASE("LV Rotate benchmark RGB888", "[rotate][benchmark][RGB888]")
+{
+    ESP_LOGI(TAG_LV_ROTATE_BENCH, "running test for RGB888 color format, internal RAM");
+    lv_rotate_benchmark_init(SMALL_WIDTH, SMALL_HEIGHT, 3, MALLOC_CAP_INTERNAL);
+    ESP_LOGI(TAG_LV_ROTATE_BENCH, "running test for RGB888 color format, PSRAM");
+    lv_rotate_benchmark_init(BAND_WIDTH, BAND_HEIGHT, 3, MALLOC_CAP_SPIRAM);
+}
+
+// ------------------------------------------------ Static test functions ----------------------------------------------
+
+static void lv_rotate_benchmark_init(int32_t w, int32_t h, uint32_t px_size, uint32_t caps)
+{
+    const size_t len = (size_t)w * h * px_size;
+    uint8_t *src     = heap_caps_aligned_alloc(16, len, caps);
+    uint8_t *dst     = heap_caps_aligned_alloc(16, len, caps);
+    if (src == NULL || dst == NULL) {
+        heap_caps_free(src);
+        heap_caps_free(dst);
+        ESP_LOGW(TAG_LV_ROTATE_BENCH, "not enough memory for %" PRIi32 "x%" PRIi32 ", skipped\n", w, h);
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        src[i] = (uint8_t)i;
+    }
+
+    for (int a = LVGL_PORT_ROTATE_90; a <= LVGL_PORT_ROTATE_270; a++) {
+        const lvgl_port_rotate_angle_t angle = (lvgl_port_rotate_angle_t)a;
+        const float reference                = lv_rotate_benchmark_run(src, dst, w, h, px_size, angle, 0);
+        ESP_LOGI(TAG_LV_ROTATE_BENCH, " %s degrees, %" PRIi32 "x%" PRIi32 ": reference %.3f cycles per pixel",
+                 angle_names[a], w, h, reference);
+
+        for (size_t t = 0; t < sizeof(bench_tiles) / sizeof(bench_tiles[0]); t++) {
+            const float tiled = lv_rotate_benchmark_run(src, dst, w, h, px_size, angle, bench_tiles[t]);
+            ESP_LOGI(TAG_LV_ROTATE_BENCH, "   tile %2" PRIu32 ": %.3f cycles per pixel, %.2fx%s", bench_tiles[t],
+                     tiled, reference / tiled,
+                     bench_tiles[t] == lvgl_port_rotate_default_tile(px_size) ? " (default)" : "");
+        }
+    }
+    ESP_LOGI(TAG_LV_ROTATE_BENCH, "");
+
+    heap_caps_free(src);
+    heap_caps_free(dst);
+}
+
+static float lv_rotate_benchmark_run(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, uint32_t px_size,
+                                     lvgl_port_rotate_angle_t angle, uint32_t tile)
+{
+    const bool swap          = (angle == LVGL_PORT_ROTATE_90 || angle == LVGL_PORT_ROTATE_270);
+    const int32_t src_stride = w * px_size;
+    const int32_t dst_stride = (swap ? h : w) * px_size;
+
+    // Call the DUT function for the first time to init the benchmark test
+    if (tile == 0) {
+        lvgl_port_rotate_reference(src, dst, w, h, src_stride, dst_stride, angle, px_size);
+    } else {
+        lvgl_port_rotate_tiled(src, dst, w, h, src_stride, dst_stride, angle, px_size, tile);
+    }
+
+    const uint32_t start_b = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCHMARK_CYCLES; i++) {
+        if (tile == 0) {
+            lvgl_port_rotate_reference(src, dst, w, h, src_stride, dst_stride, angle, px_size);
+        } else {
+            lvgl_port_rotate_tiled(src, dst, w, h, src_stride, dst_stride, angle, px_size, tile);
+        }
+    }
+    const uint32_t end_b = esp_cpu_get_cycle_count();
+
+    const float total_b = (uint32_t)(end_b - start_b);
+    return total_b / ((float)BENCHMARK_CYCLES * w * h);
+}
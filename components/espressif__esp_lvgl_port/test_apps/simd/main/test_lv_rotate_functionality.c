@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_lvgl_port_rotate.h"
+
+// ------------------------------------------------- Defines -----------------------------------------------------------
+
+#define CANARY_BYTES 16
+#define CANARY_VALUE 0xA5
+#define STRIDE_PAD   4  // Extra pixels at the end of every line, left untouched by the kernels
+
+// ------------------------------------------------- Macros and Types --------------------------------------------------
+
+typedef struct {
+    int32_t w;
+    int32_t h;
+} rotate_size_t;
+
+// ------------------------------------------------ Static variables ---------------------------------------------------
+
+static const char *TAG_LV_ROTATE_FUNC = "LV Rotate Functionality";
+static char test_msg_buf[200];
+
+// Odd sizes, sizes around the tile edges and a flush strip of a 720 px wide panel
+static const rotate_size_t test_sizes[] = {
+    {1, 1}, {1, 7}, {7, 1}, {3, 5}, {8, 8}, {15, 17}, {16, 16}, {31, 33}, {32, 32}, {33, 9}, {65, 40}, {720, 12},
+};
+
+static const uint32_t test_tiles[] = {0, LVGL_PORT_ROTATE_TILE_MIN, 16, LVGL_PORT_ROTATE_TILE_MAX};
+
+// ------------------------------------------------ Static function headers --------------------------------------------
+
+/**
+ * @brief Rotate every test size by every angle with every tile and compare to the reference
+ *
+ * @param[in] px_size Bytes per pixel
+ */
+static void lv_rotate_functionality(uint32_t px_size);
+
+/**
+ * @brief Check that the reference kernel moves pixels as documented in esp_lvgl_port_rotate.h
+ */
+static void lv_rotate_check_mapping(const uint8_t *src, const uint8_t *dst, int32_t w, int32_t h, int32_t src_stride,
+                                    int32_t dst_stride, lvgl_port_rotate_angle_t angle, uint32_t px_size);
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality tests
+
+Purpose:
+    - Test that the tiled rotation kernel gives the same result as the pixel by pixel reference
+
+Procedure:
+    - Fill a source block with a unique value per byte, lines padded past their width
+    - Rotate it with the reference kernel, check a few pixels against the mapping of every angle
+    - Rotate it with the tiled kernel, for tile edges from the smallest to the largest
+    - Compare both destinations byte by byte, including the line padding and the canaries around the buffer
+*/
+
+// ------------------------------------------------ Test cases stages --------------------------------------------------
+
+TEST_CASE("LV Rotate functionality RGB565", "[rotate][functionality][RGB565]")
+{
+    lv_rotate_functionality(2);
+}
+
+TEST_CASE("LV Rotate functionality RGB888", "[rotate][functionality][RGB888]")
+{
+    lv_rotate_functionality(3);
+}
+
+TEST_CASE("LV Rotate functionality ARGB8888", "[rotate][functionality][ARGB8888]")
+{
+    lv_rotate_functionality(4);
+}
+
+// ------------------------------------------------ Static test functions ----------------------------------------------
+
+static void lv_rotate_functionality(uint32_t px_size)
+{
+    for (size_t s = 0; s < sizeof(test_sizes) / sizeof(test_sizes[0]); s++) {
+        const int32_t w = test_sizes[s].w;
+        const int32_t h = test_sizes[s].h;
+        // Strides are whole pixels, so 16 and 32 bit pixels stay aligned
+        const int32_t src_stride = (w + STRIDE_PAD) * px_size;
+        const size_t src_len     = (size_t)src_stride * h;
+
+        uint8_t *src = (uint8_t *)memalign(16, src_len);
+        TEST_ASSERT_NOT_EQUAL(NULL, src);
+        for (size_t i = 0; i < src_len; i++) {
+            src[i] = (uint8_t)(i * 7 + i / 251);
+        }
+
+        for (int a = LVGL_PORT_ROTATE_0; a <= LVGL_PORT_ROTATE_270; a++) {
+            const lvgl_port_rotate_angle_t angle = (lvgl_port_rotate_angle_t)a;
+            const bool swap                      = (angle == LVGL_PORT_ROTATE_90 || angle == LVGL_PORT_ROTATE_270);
+            const int32_t dst_w                  = swap ? h : w;
+            const int32_t dst_h                  = swap ? w : h;
+            const int32_t dst_stride             = (dst_w + STRIDE_PAD) * px_size;
+            const size_t dst_len                 = (size_t)dst_stride * dst_h + 2 * CANARY_BYTES;
+
+            uint8_t *dst_ref   = (uint8_t *)memalign(16, dst_len);
+            uint8_t *dst_tiled = (uint8_t *)memalign(16, dst_len);
+            TEST_ASSERT_NOT_EQUAL(NULL, dst_ref);
+            TEST_ASSERT_NOT_EQUAL(NULL, dst_tiled);
+
+            memset(dst_ref, CANARY_VALUE, dst_len);
+            lvgl_port_rotate_reference(src, dst_ref + CANARY_BYTES, w, h, src_stride, dst_stride, angle, px_size);
+            lv_rotate_check_mapping(src, dst_ref + CANARY_BYTES, w, h, src_stride, dst_stride, angle, px_size);
+
+            for (size_t t = 0; t < sizeof(test_tiles) / sizeof(test_tiles[0]); t++) {
+                memset(dst_tiled, CANARY_VALUE, dst_len);
+                lvgl_port_rotate_tiled(src, dst_tiled + CANARY_BYTES, w, h, src_stride, dst_stride, angle, px_size,
+                                       test_tiles[t]);
+
+                snprintf(test_msg_buf, sizeof(test_msg_buf),
+                         "%" PRIu32 " byte pixels, %" PRIi32 "x%" PRIi32 ", %d degrees, tile %" PRIu32, px_size, w, h,
+                         a * 90, test_tiles[t]);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(dst_ref, dst_tiled, dst_len, test_msg_buf);
+            }
+
+            free(dst_ref);
+            free(dst_tiled);
+        }
+        free(src);
+    }
+    ESP_LOGI(TAG_LV_ROTATE_FUNC, "%" PRIu32 " byte pixels passed", px_size);
+}
+
+static void lv_rotate_check_mapping(const uint8_t *src, const uint8_t *dst, int32_t w, int32_t h, int32_t src_stride,
+                                    int32_t dst_stride, lvgl_port_rotate_angle_t angle, uint32_t px_size)
+{
+    // Corners and the middle of the source
+    const int32_t xs[] = {0, w - 1, 0, w - 1, w / 2};
+    const int32_t ys[] = {0, 0, h - 1, h - 1, h / 2};
+
+    for (int i = 0; i < 5; i++) {
+        const int32_t x = xs[i];
+        const int32_t y = ys[i];
+        int32_t dx = x, dy = y;
+        switch (angle) {
+            case LVGL_PORT_ROTATE_90:
+                dx = y;
+                dy = w - 1 - x;
+                break;
+            case LVGL_PORT_ROTATE_180:
+                dx = w - 1 - x;
+                dy = h - 1 - y;
+                break;
+            case LVGL_PORT_ROTATE_270:
+                dx = h - 1 - y;
+                dy = x;
+                break;
+            default:
+                break;
+        }
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(src + y * src_stride + x * px_size, dst + dy * dst_stride + dx * px_size,
+                                      px_size);
+    }
+}
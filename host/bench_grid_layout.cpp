@@ -0,0 +1,275 @@
+// Cost of a runtime GridLayout against the old compile-time grid macros.
+//
+// Replays the two per-message / per-frame paths that depend on the grid shape,
+// once with the previous fixed 12x5 code (GRID_* macros, arrays sized to the
+// grid, slot rectangles multiplied out per cell) and once the way GridBoard and
+// BoardWidget now do it (dimensions read from the layout, per-cell arrays
+// sized for GRID_MAX_*, slot rectangles from GridGeometry):
+//
+//   layout+diff  lay a message out on an empty grid and diff it against the
+//                board, as process_text_and_animate() does
+//   draw clip    find the slots under a clip area and their rectangles, as
+//                BoardWidget::draw() does for a one-slot invalidation and
+//                for a full-screen refresh
+//
+// The layout is looked up by name at run time so the compiler cannot fold it
+// back into constants.
+//
+// Usage: bench_grid_layout [rounds] [layout]
+
+#include "grid_layout.hpp"
+#include "utf8_segment.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Previous fixed grid
+#define GRID_COLS 12
+#define GRID_ROWS 5
+#define GRID_SLOT_WIDTH 96
+#define GRID_SLOT_HEIGHT 126
+#define GRID_GAP 10
+#define GRID_SCREEN_WIDTH 1280
+#define GRID_SCREEN_HEIGHT 720
+
+static const char *samples[] = {
+    "HELLO WORLD",
+    "HELLO THERE",
+    "WELCOME HOME \xE2\x9D\xA4\xEF\xB8\x8F",
+    "NEXT TRAIN 12:45 PLATFORM 3",
+    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789",
+    "SAME LENGTH",
+};
+#define SAMPLE_COUNT (int)(sizeof(samples) / sizeof(samples[0]))
+
+struct Rect
+{
+    int x1, y1, x2, y2;
+};
+
+static bool intersect(Rect *out, const Rect &a, const Rect &b)
+{
+    out->x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+    out->y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+    out->x2 = a.x2 < b.x2 ? a.x2 : b.x2;
+    out->y2 = a.y2 < b.y2 ? a.y2 : b.y2;
+    return out->x1 <= out->x2 && out->y1 <= out->y2;
+}
+
+// ---- layout + diff ----
+
+static Utf8Cell text_cells[GRID_MAX_CELLS];
+
+static int macro_layout_diff(const char *text, char board[GRID_ROWS][GRID_COLS][8])
+{
+    char layout[GRID_ROWS][GRID_COLS][8];
+    memset(layout, 0, sizeof(layout));
+    int n = utf8_segment(text, strlen(text), text_cells, GRID_ROWS * GRID_COLS);
+
+    int text_rows = (n + GRID_COLS - 1) / GRID_COLS;
+    int start_row = (GRID_ROWS - text_rows) / 2;
+    if (start_row < 0)
+        start_row = 0;
+    int pos = n <= GRID_COLS ? start_row * GRID_COLS + (GRID_COLS - n) / 2 : start_row * GRID_COLS;
+    for (int i = 0; i < n && pos < GRID_ROWS * GRID_COLS; i++, pos++)
+    {
+        memcpy(layout[pos / GRID_COLS][pos % GRID_COLS], text_cells[i].text, text_cells[i].len + 1);
+    }
+
+    int changed = 0;
+    for (int row = 0; row < GRID_ROWS; row++)
+    {
+        for (int col = 0; col < GRID_COLS; col++)
+        {
+            const char *target = strcmp(layout[row][col], " ") == 0 ? "" : layout[row][col];
+            if (strcmp(board[row][col], target) != 0)
+            {
+                strcpy(board[row][col], target);
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
+
+static int layout_diff(const GridLayout &l, const char *text, char board[GRID_MAX_ROWS][GRID_MAX_COLS][8])
+{
+    static char layout[GRID_MAX_ROWS][GRID_MAX_COLS][8];
+    const int rows = l.rows;
+    const int cols = l.cols;
+    memset(layout, 0, sizeof(layout));
+    int n = utf8_segment(text, strlen(text), text_cells, rows * cols);
+
+    int text_rows = (n + cols - 1) / cols;
+    int start_row = (rows - text_rows) / 2;
+    if (start_row < 0)
+        start_row = 0;
+    int pos = n <= cols ? start_row * cols + (cols - n) / 2 : start_row * cols;
+    for (int i = 0; i < n && pos < rows * cols; i++, pos++)
+    {
+        memcpy(layout[pos / cols][pos % cols], text_cells[i].text, text_cells[i].len + 1);
+    }
+
+    int changed = 0;
+    for (int row = 0; row < rows; row++)
+    {
+        for (int col = 0; col < cols; col++)
+        {
+            const char *target = strcmp(layout[row][col], " ") == 0 ? "" : layout[row][col];
+            if (strcmp(board[row][col], target) != 0)
+            {
+                strcpy(board[row][col], target);
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
+
+// ---- draw clip ----
+
+static long macro_draw_clip(const Rect &clip)
+{
+    int total_width = GRID_COLS * GRID_SLOT_WIDTH + (GRID_COLS - 1) * GRID_GAP;
+    int total_height = GRID_ROWS * GRID_SLOT_HEIGHT + (GRID_ROWS - 1) * GRID_GAP;
+    int x0 = (GRID_SCREEN_WIDTH - total_width) / 2;
+    int y0 = (GRID_SCREEN_HEIGHT - total_height) / 2;
+
+    long px = 0;
+    for (int row = 0; row < GRID_ROWS; row++)
+    {
+        for (int col = 0; col < GRID_COLS; col++)
+        {
+            Rect slot;
+            slot.x1 = x0 + col * (GRID_SLOT_WIDTH + GRID_GAP);
+            slot.y1 = y0 + row * (GRID_SLOT_HEIGHT + GRID_GAP);
+            slot.x2 = slot.x1 + GRID_SLOT_WIDTH - 1;
+            slot.y2 = slot.y1 + GRID_SLOT_HEIGHT - 1;
+            Rect r;
+            if (intersect(&r, clip, slot))
+                px += (long)(r.x2 - r.x1 + 1) * (r.y2 - r.y1 + 1);
+        }
+    }
+    return px;
+}
+
+static long draw_clip(const GridGeometry &g, const Rect &clip)
+{
+    const int rows = g.layout.rows;
+    const int cols = g.layout.cols;
+    const int w = g.layout.slot_width;
+    const int h = g.layout.slot_height;
+    int x1 = clip.x1 - g.x0, x2 = clip.x2 - g.x0;
+    int y1 = clip.y1 - g.y0, y2 = clip.y2 - g.y0;
+
+    int col0 = 0, col1 = cols - 1, row0 = 0, row1 = rows - 1;
+    while (col0 < cols && g.col_x[col0] + w <= x1)
+        col0++;
+    while (col1 >= 0 && g.col_x[col1] > x2)
+        col1--;
+    while (row0 < rows && g.row_y[row0] + h <= y1)
+        row0++;
+    while (row1 >= 0 && g.row_y[row1] > y2)
+        row1--;
+
+    long px = 0;
+    for (int row = row0; row <= row1; row++)
+    {
+        for (int col = col0; col <= col1; col++)
+        {
+            Rect slot;
+            slot.x1 = g.x0 + g.col_x[col];
+            slot.y1 = g.y0 + g.row_y[row];
+            slot.x2 = slot.x1 + w - 1;
+            slot.y2 = slot.y1 + h - 1;
+            Rect r;
+            if (intersect(&r, clip, slot))
+                px += (long)(r.x2 - r.x1 + 1) * (r.y2 - r.y1 + 1);
+        }
+    }
+    return px;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 200000;
+    const GridLayout *layout = grid_layout_find(argc > 2 ? argv[2] : "12x5");
+    if (!layout)
+    {
+        fprintf(stderr, "Unknown layout\n");
+        return 2;
+    }
+    GridGeometry geometry = grid_geometry(*layout);
+
+    // One clip per slot (a single moving card) plus the whole screen
+    Rect clips[GRID_ROWS * GRID_COLS + 1];
+    int clip_count = 0;
+    for (int row = 0; row < GRID_ROWS; row++)
+    {
+        for (int col = 0; col < GRID_COLS; col++)
+        {
+            int x = geometry.x0 + col * (GRID_SLOT_WIDTH + GRID_GAP);
+            int y = geometry.y0 + row * (GRID_SLOT_HEIGHT + GRID_GAP);
+            clips[clip_count++] = {x, y, x + GRID_SLOT_WIDTH - 1, y + GRID_SLOT_HEIGHT - 1};
+        }
+    }
+    clips[clip_count++] = {0, 0, layout->screen_width - 1, layout->screen_height - 1};
+
+    using clock = std::chrono::steady_clock;
+    volatile long sink = 0;
+    static char macro_board[GRID_ROWS][GRID_COLS][8];
+    static char board[GRID_MAX_ROWS][GRID_MAX_COLS][8];
+
+    // The macro baseline is only meaningful against the same 12x5 shape
+    bool compare = layout == &GRID_LAYOUT_12X5;
+    long check_macro = 0, check_layout = 0;
+
+    auto t0 = clock::now();
+    if (compare)
+    {
+        for (int r = 0; r < rounds; r++)
+            check_macro += macro_layout_diff(samples[r % SAMPLE_COUNT], macro_board);
+    }
+    auto t1 = clock::now();
+    for (int r = 0; r < rounds; r++)
+        check_layout += layout_diff(*layout, samples[r % SAMPLE_COUNT], board);
+    auto t2 = clock::now();
+
+    long px_macro = 0, px_layout = 0;
+    if (compare)
+    {
+        for (int r = 0; r < rounds; r++)
+            px_macro += macro_draw_clip(clips[r % clip_count]);
+    }
+    auto t3 = clock::now();
+    for (int r = 0; r < rounds; r++)
+        px_layout += draw_clip(geometry, clips[r % clip_count]);
+    auto t4 = clock::now();
+    sink = check_macro + check_layout + px_macro + px_layout;
+    (void)sink;
+
+    auto ns = [rounds](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::nano>(b - a).count() / rounds;
+    };
+    printf("layout %s, %d rounds\n", layout->name, rounds);
+    if (compare)
+    {
+        printf("layout+diff  macro %7.1f ns  layout %7.1f ns  (%+.1f%%)\n", ns(t0, t1), ns(t1, t2),
+               (ns(t1, t2) / ns(t0, t1) - 1.0) * 100.0);
+        printf("draw clip    macro %7.1f ns  layout %7.1f ns  (%+.1f%%)\n", ns(t2, t3), ns(t3, t4),
+               (ns(t3, t4) / ns(t2, t3) - 1.0) * 100.0);
+        if (check_macro != check_layout || px_macro != px_layout)
+        {
+            fprintf(stderr, "Results differ: %ld/%ld changed cells, %ld/%ld px\n", check_macro, check_layout,
+                    px_macro, px_layout);
+            return 1;
+        }
+    }
+    else
+    {
+        printf("layout+diff  %7.1f ns\n", ns(t1, t2));
+        printf("draw clip    %7.1f ns\n", ns(t3, t4));
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Throughput of message layout on a long synthetic playlist.
+//
+// Messages are segmented once up front, then laid out over and over: once
+// with the previous placement of GridBoard (cells in a row from the start
+// of the centered block, wrapping mid-word), kept here as the baseline, and
+// once with the word-wrapping text_layout().
+//
+// Usage: bench_text_layout [messages] [rounds] [layout] [center|left|right]
+
+#include "text_layout.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const char *samples[] = {
+    "HELLO WORLD",
+    "WELCOME HOME \xE2\x9D\xA4\xEF\xB8\x8F\xE2\x9D\xA4\xEF\xB8\x8F",
+    "NEXT TRAIN 12:45 PLATFORM 3",
+    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789",
+    "ARRIVALS\nLONDON 12:45\nPARIS 13:10",
+    "SUPERCALIFRAGILISTICEXPIALIDOCIOUS",
+    "\xF0\x9F\x98\x8A GOOD MORNING, HAVE A \xE2\x80\x9CGREAT\xE2\x80\x9D DAY \xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD",
+};
+
+static const GridLayout *layouts[] = {&GRID_LAYOUT_12X5, &GRID_LAYOUT_16X6, &GRID_LAYOUT_8X3, &GRID_LAYOUT_PORTRAIT};
+
+struct Message
+{
+    Utf8Cell cells[TEXT_LAYOUT_MAX_CELLS];
+    int count;
+};
+
+// Previous GridBoard placement, for comparison
+static int legacy_layout(const GridLayout &l, int text_length, int16_t *positions)
+{
+    const int capacity = grid_layout_cells(l);
+    if (text_length > capacity)
+        text_length = capacity;
+    int text_rows = (text_length + l.cols - 1) / l.cols;
+    int start_row = (l.rows - text_rows) / 2;
+    if (start_row < 0)
+        start_row = 0;
+    int position = text_length <= l.cols ? start_row * l.cols + (l.cols - text_length) / 2 : start_row * l.cols;
+    int placed = 0;
+    for (int i = 0; i < text_length && position < capacity; i++, placed++)
+        positions[i] = (int16_t)position++;
+    return placed;
+}
+
+int main(int argc, char **argv)
+{
+    int message_count = argc > 1 ? atoi(argv[1]) : 10000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+    const GridLayout *layout = &GRID_LAYOUT_12X5;
+    if (argc > 3)
+    {
+        layout = nullptr;
+        for (const GridLayout *l : layouts)
+        {
+            if (strcmp(argv[3], l->name) == 0)
+                layout = l;
+        }
+        if (!layout)
+        {
+            fprintf(stderr, "Unknown layout %s\n", argv[3]);
+            return 2;
+        }
+    }
+    TextAlign align = TEXT_ALIGN_CENTER;
+    if (argc > 4 && !text_align_find(argv[4], &align))
+    {
+        fprintf(stderr, "Unknown alignment %s\n", argv[4]);
+        return 2;
+    }
+    if (message_count < 1 || rounds < 1)
+        return 2;
+
+    const int max_cells = grid_layout_cells(*layout) + layout->rows;
+    std::vector<Message> playlist(message_count);
+    size_t total_cells = 0;
+    for (int i = 0; i < message_count; i++)
+    {
+        const char *text = samples[i % (sizeof(samples) / sizeof(samples[0]))];
+        playlist[i].count = utf8_segment(text, strlen(text), playlist[i].cells, max_cells);
+        total_cells += playlist[i].count;
+    }
+
+    using clock = std::chrono::steady_clock;
+    volatile size_t sink = 0;
+    int16_t positions[TEXT_LAYOUT_MAX_CELLS];
+
+    auto t0 = clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (const Message &m : playlist)
+            sink = sink + legacy_layout(*layout, m.count, positions);
+    }
+    auto t1 = clock::now();
+
+    int overflowing = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        for (const Message &m : playlist)
+        {
+            TextLayoutResult result = text_layout(m.cells, m.count, layout->cols, layout->rows, align, positions);
+            sink = sink + result.placed;
+            overflowing += result.overflow;
+        }
+    }
+    auto t2 = clock::now();
+
+    double cells = (double)total_cells * rounds;
+    double legacy_s = std::chrono::duration<double>(t1 - t0).count();
+    double layout_s = std::chrono::duration<double>(t2 - t1).count();
+    printf("%d messages x %d rounds on %s, %s, %.1f M cells, %d%% overflow\n", message_count, rounds, layout->name,
+           text_align_name(align), cells / 1e6, (int)(100.0 * overflowing / ((double)message_count * rounds)));
+    printf("legacy placement: %8.1f M cells/s  %6.0f ns/message\n", cells / legacy_s / 1e6,
+           legacy_s * 1e9 / ((double)message_count * rounds));
+    printf("text_layout:      %8.1f M cells/s  %6.0f ns/message\n", cells / layout_s / 1e6,
+           layout_s * 1e9 / ((double)message_count * rounds));
+    return 0;
+}
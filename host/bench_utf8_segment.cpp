@@ -0,0 +1,122 @@
+// Throughput of message segmentation on a long synthetic playlist.
+//
+// Compares utf8_segment() against the previous splitter of GridBoard (per
+// character std::string, quote replacement on each 8-byte copy), which is
+// kept here as the baseline.
+//
+// Usage: bench_utf8_segment [messages] [rounds]
+
+#include "utf8_segment.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char *samples[] = {
+    "HELLO WORLD",
+    "WELCOME HOME \xE2\x9D\xA4\xEF\xB8\x8F\xE2\x9D\xA4\xEF\xB8\x8F",
+    "IT\xE2\x80\x99S A \xE2\x80\x9CGREAT\xE2\x80\x9D DAY \xF0\x9F\x98\x8A",
+    "NEXT TRAIN 12:45 PLATFORM 3",
+    "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7 FAMILY \xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD",
+    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789",
+};
+
+// Previous GridBoard splitter, for comparison
+static int legacy_char_len(unsigned char c)
+{
+    if ((c & 0x80) == 0x00)
+        return 1;
+    if ((c & 0xE0) == 0xC0)
+        return 2;
+    if ((c & 0xF0) == 0xE0)
+        return 3;
+    if ((c & 0xF8) == 0xF0)
+        return 4;
+    return 1;
+}
+
+static void legacy_quotes(char *str)
+{
+    unsigned char *p = (unsigned char *)str;
+    char *out = str;
+    while (*p)
+    {
+        if (p[0] == 0xE2 && p[1] == 0x80 && (p[2] == 0x98 || p[2] == 0x99))
+        {
+            *out++ = '\'';
+            p += 3;
+        }
+        else
+        {
+            *out++ = *p++;
+        }
+    }
+    *out = 0;
+}
+
+static size_t legacy_split(const std::string &text)
+{
+    std::vector<std::string> characters;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        int char_len = legacy_char_len((unsigned char)text[i]);
+        if (i + char_len > text.size())
+            break;
+        char utf8[8] = {0};
+        memcpy(utf8, &text[i], char_len);
+        legacy_quotes(utf8);
+        characters.push_back(std::string(utf8));
+        i += char_len;
+    }
+    return characters.size();
+}
+
+int main(int argc, char **argv)
+{
+    int message_count = argc > 1 ? atoi(argv[1]) : 10000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    std::vector<std::string> playlist;
+    size_t total_bytes = 0;
+    for (int i = 0; i < message_count; i++)
+    {
+        playlist.push_back(samples[i % (sizeof(samples) / sizeof(samples[0]))]);
+        total_bytes += playlist.back().size();
+    }
+
+    using clock = std::chrono::steady_clock;
+    volatile size_t sink = 0;
+
+    auto t0 = clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (const std::string &msg : playlist)
+        {
+            sink = sink + legacy_split(msg);
+        }
+    }
+    auto t1 = clock::now();
+
+    Utf8Cell cells[256];
+    for (int r = 0; r < rounds; r++)
+    {
+        for (const std::string &msg : playlist)
+        {
+            sink = sink + utf8_segment(msg.data(), msg.size(), cells, 256);
+        }
+    }
+    auto t2 = clock::now();
+
+    double bytes = (double)total_bytes * rounds;
+    double legacy_s = std::chrono::duration<double>(t1 - t0).count();
+    double segment_s = std::chrono::duration<double>(t2 - t1).count();
+    printf("%d messages x %d rounds, %.1f MB\n", message_count, rounds, bytes / 1e6);
+    printf("legacy split:  %8.1f MB/s  %6.0f ns/message\n", bytes / legacy_s / 1e6,
+           legacy_s * 1e9 / ((double)message_count * rounds));
+    printf("utf8_segment:  %8.1f MB/s  %6.0f ns/message\n", bytes / segment_s / 1e6,
+           segment_s * 1e9 / ((double)message_count * rounds));
+    return 0;
+}
@@ -0,0 +1,275 @@
+// Packs color emoji into an emoji atlas for the "emoji" flash partition.
+//
+// Emoji are read from RGBA PAM images (netpbm P7, e.g. converted from the
+// Noto or Twemoji PNGs with "magick emoji_u1f600.png emoji_u1f600.pam"),
+// given as files or as directories of *.pam files. The file name says which
+// codepoint an image is for: hex codepoints after an optional "emoji_u" or
+// "u" prefix, joined by '-' or '_'. Variation selector FE0F is ignored;
+// sequences of more codepoints than that do not fit a single board cell and
+// are skipped. --font adds the glyphs of the built-in NotoEmoji64 font in
+// white, as a placeholder for emoji without an image.
+//
+// Images are 48 px by default, which fits every emoji of the board into the
+// partition; at 64 px about 200 fit. Atlases larger than the partition are
+// refused.
+//
+// Usage: emoji_atlas_pack [-o FILE] [--size N] [--font] [PAM file or dir ...]
+//
+// Flash the result with
+//   parttool.py write_partition --partition-name emoji --input FILE
+
+#include "emoji_atlas_writer.hpp"
+#include "grid_board.hpp"
+#include "esp_log.h"
+#include "lvgl.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#define DEFAULT_EMOJI_SIZE 48
+#define EMOJI_PARTITION_SIZE (2400 * 1024)  // see partitions.csv
+
+// Codepoint of an image file name, 0 if it names none or a sequence
+static uint32_t codepoint_of(const std::filesystem::path &path)
+{
+    std::string name = path.stem().string();
+    for (const char *prefix : {"emoji_u", "u"})
+    {
+        if (name.compare(0, strlen(prefix), prefix) == 0)
+        {
+            name = name.substr(strlen(prefix));
+            break;
+        }
+    }
+
+    uint32_t codepoint = 0;
+    const char *p = name.c_str();
+    while (*p)
+    {
+        char *end;
+        unsigned long value = strtoul(p, &end, 16);
+        if (end == p || (*end && *end != '-' && *end != '_') || value > 0x10FFFF)
+            return 0;
+        if (value != 0xFE0F)
+        {
+            if (codepoint)
+                return 0;
+            codepoint = (uint32_t)value;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return codepoint;
+}
+
+// Next header token of a PAM file, skipping comments
+static bool pam_token(FILE *f, char *token, size_t size)
+{
+    int c = fgetc(f);
+    while (c == '#' || isspace(c))
+    {
+        if (c == '#')
+        {
+            while (c != '\n' && c != EOF)
+                c = fgetc(f);
+        }
+        c = fgetc(f);
+    }
+    size_t n = 0;
+    while (c != EOF && !isspace(c) && n + 1 < size)
+    {
+        token[n++] = (char)c;
+        c = fgetc(f);
+    }
+    token[n] = '\0';
+    return n > 0;
+}
+
+// RGBA or RGB PAM image with 8-bit samples
+static bool read_pam(const char *path, EmojiAtlasInput *image)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    char token[32];
+    int depth = 0, maxval = 0;
+    image->width = image->height = 0;
+    bool ok = pam_token(f, token, sizeof(token)) && strcmp(token, "P7") == 0;
+    while (ok && pam_token(f, token, sizeof(token)) && strcmp(token, "ENDHDR") != 0)
+    {
+        char value[32];
+        if (strcmp(token, "TUPLTYPE") == 0)
+            ok = pam_token(f, value, sizeof(value));
+        else if (strcmp(token, "WIDTH") == 0 && pam_token(f, value, sizeof(value)))
+            image->width = atoi(value);
+        else if (strcmp(token, "HEIGHT") == 0 && pam_token(f, value, sizeof(value)))
+            image->height = atoi(value);
+        else if (strcmp(token, "DEPTH") == 0 && pam_token(f, value, sizeof(value)))
+            depth = atoi(value);
+        else if (strcmp(token, "MAXVAL") == 0 && pam_token(f, value, sizeof(value)))
+            maxval = atoi(value);
+        else
+            ok = false;
+    }
+    ok = ok && image->width > 0 && image->height > 0 && image->width <= 4096 && image->height <= 4096 &&
+         (depth == 3 || depth == 4) && maxval == 255;
+
+    std::vector<uint8_t> samples;
+    if (ok)
+    {
+        samples.resize((size_t)image->width * image->height * depth);
+        ok = fread(samples.data(), 1, samples.size(), f) == samples.size();
+    }
+    fclose(f);
+    if (!ok)
+        return false;
+
+    image->rgba.resize((size_t)image->width * image->height * 4);
+    for (size_t i = 0; i < (size_t)image->width * image->height; i++)
+    {
+        memcpy(&image->rgba[i * 4], &samples[i * depth], 3);
+        image->rgba[i * 4 + 3] = depth == 4 ? samples[i * depth + 3] : 255;
+    }
+    return true;
+}
+
+// Every glyph of the built-in emoji font as a white image
+static void add_font_glyphs(std::map<uint32_t, EmojiAtlasInput> *emoji)
+{
+    const lv_font_fmt_txt_dsc_t *dsc = (const lv_font_fmt_txt_dsc_t *)NotoEmoji64.dsc;
+    std::vector<uint32_t> letters;
+    for (int i = 0; i < dsc->cmap_num; i++)
+    {
+        const lv_font_fmt_txt_cmap_t &c = dsc->cmaps[i];
+        for (int k = 0; k < (c.unicode_list ? c.list_length : c.range_length); k++)
+            letters.push_back(c.range_start + (c.unicode_list ? c.unicode_list[k] : k));
+    }
+
+    for (uint32_t letter : letters)
+    {
+        lv_font_glyph_dsc_t glyph;
+        if (!lv_font_get_glyph_dsc(&NotoEmoji64, &glyph, letter, 0) || glyph.box_w == 0 || glyph.box_h == 0)
+            continue;
+        lv_draw_buf_t *buf = lv_draw_buf_create(glyph.box_w, glyph.box_h, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+        if (buf && lv_font_get_glyph_bitmap(&glyph, buf))
+        {
+            EmojiAtlasInput image;
+            image.codepoint = letter;
+            image.width = glyph.box_w;
+            image.height = glyph.box_h;
+            image.rgba.assign((size_t)image.width * image.height * 4, 255);
+            for (int y = 0; y < image.height; y++)
+            {
+                for (int x = 0; x < image.width; x++)
+                    image.rgba[((size_t)y * image.width + x) * 4 + 3] = buf->data[y * buf->header.stride + x];
+            }
+            (*emoji)[letter] = image;
+        }
+        lv_draw_buf_destroy(buf);
+    }
+}
+
+static bool add_file(const std::filesystem::path &path, std::map<uint32_t, EmojiAtlasInput> *emoji)
+{
+    EmojiAtlasInput image;
+    image.codepoint = codepoint_of(path);
+    if (!image.codepoint)
+    {
+        fprintf(stderr, "Skipping %s: the name is not a single codepoint\n", path.c_str());
+        return true;
+    }
+    if (!read_pam(path.c_str(), &image))
+    {
+        fprintf(stderr, "Cannot read %s as an 8-bit RGB or RGBA PAM image\n", path.c_str());
+        return false;
+    }
+    (*emoji)[image.codepoint] = image;  // images replace font glyphs
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    esp_log_host_level = 1;
+    lv_init();
+
+    const char *output = "emoji.bin";
+    int size = DEFAULT_EMOJI_SIZE;
+    bool font = false;
+    std::vector<std::filesystem::path> sources;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--font") == 0)
+            font = true;
+        else
+            sources.push_back(argv[i]);
+    }
+
+    std::map<uint32_t, EmojiAtlasInput> emoji;
+    if (font)
+        add_font_glyphs(&emoji);
+    for (const std::filesystem::path &source : sources)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(source, ec))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(source, ec))
+            {
+                if (entry.path().extension() == ".pam" && !add_file(entry.path(), &emoji))
+                    return 2;
+            }
+        }
+        else if (!add_file(source, &emoji))
+        {
+            return 2;
+        }
+    }
+
+    std::vector<EmojiAtlasInput> inputs;
+    for (auto &entry : emoji)
+        inputs.push_back(std::move(entry.second));
+    std::vector<uint8_t> atlas;
+    std::string error;
+    if (!emoji_atlas_pack(inputs, size, &atlas, &error))
+    {
+        fprintf(stderr, "Cannot pack the atlas: %s\n", error.c_str());
+        return 1;
+    }
+    if (atlas.size() > EMOJI_PARTITION_SIZE)
+    {
+        fprintf(stderr, "%u bytes do not fit the %u KB emoji partition, use fewer or smaller emoji\n",
+                (unsigned)atlas.size(), EMOJI_PARTITION_SIZE / 1024);
+        return 1;
+    }
+
+    // Packing is only done if the firmware can read it back
+    EmojiAtlas check;
+    if (!check.open(atlas.data(), atlas.size()))
+    {
+        fprintf(stderr, "The packed atlas does not load\n");
+        return 1;
+    }
+
+    FILE *f = fopen(output, "wb");
+    if (!f || fwrite(atlas.data(), 1, atlas.size(), f) != atlas.size())
+    {
+        fprintf(stderr, "Cannot write %s\n", output);
+        if (f)
+            fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    printf("%s: %u bytes, %d emoji of %dx%d RGB565A8\n", output, (unsigned)atlas.size(), check.count(),
+           check.width(), check.height());
+    check.close();
+    lv_deinit();
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "emoji_atlas_writer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Coverage of source pixel i by the span [from, to)
+static double overlap(int i, double from, double to)
+{
+    return std::max(0.0, std::min(to, i + 1.0) - std::max(from, (double)i));
+}
+
+// Scales an emoji into the middle of a size x size RGB565A8 image. Every
+// target pixel is the area average of the source pixels under it, weighted
+// by alpha so transparent pixels do not darken the edges.
+static void convert(const EmojiAtlasInput &input, int size, uint8_t *out)
+{
+    const double scale = std::min(1.0, std::min((double)size / input.width, (double)size / input.height));
+    const int width = std::max(1, (int)std::lround(input.width * scale));
+    const int height = std::max(1, (int)std::lround(input.height * scale));
+    const int left = (size - width) / 2;
+    const int top = (size - height) / 2;
+    const double step_x = (double)input.width / width;
+    const double step_y = (double)input.height / height;
+
+    uint16_t *colors = (uint16_t *)out;
+    uint8_t *alphas = out + size * size * sizeof(uint16_t);
+    memset(out, 0, emoji_atlas_image_bytes(size, size));
+    for (int y = 0; y < height; y++)
+    {
+        const double y0 = y * step_y;
+        const double y1 = (y + 1) * step_y;
+        for (int x = 0; x < width; x++)
+        {
+            const double x0 = x * step_x;
+            const double x1 = (x + 1) * step_x;
+            double r = 0, g = 0, b = 0, a = 0, area = 0;
+            for (int sy = (int)y0; sy < std::min((int)std::ceil(y1), input.height); sy++)
+            {
+                const double wy = overlap(sy, y0, y1);
+                for (int sx = (int)x0; sx < std::min((int)std::ceil(x1), input.width); sx++)
+                {
+                    const double w = wy * overlap(sx, x0, x1);
+                    const uint8_t *p = &input.rgba[((size_t)sy * input.width + sx) * 4];
+                    const double pa = w * p[3];
+                    r += pa * p[0];
+                    g += pa * p[1];
+                    b += pa * p[2];
+                    a += pa;
+                    area += w;
+                }
+            }
+
+            const int i = (top + y) * size + left + x;
+            const int alpha = (int)std::lround(a / area);
+            alphas[i] = (uint8_t)alpha;
+            if (alpha == 0)
+                continue;
+            const int r5 = (int)std::lround(r / a * 31 / 255);
+            const int g6 = (int)std::lround(g / a * 63 / 255);
+            const int b5 = (int)std::lround(b / a * 31 / 255);
+            colors[i] = (uint16_t)(r5 << 11 | g6 << 5 | b5);
+        }
+    }
+}
+
+bool emoji_atlas_pack(const std::vector<EmojiAtlasInput> &emoji, int size, std::vector<uint8_t> *atlas,
+                      std::string *error)
+{
+    if (size < 1 || size > EMOJI_ATLAS_MAX_SIZE)
+    {
+        *error = "emoji size must be 1 to " + std::to_string(EMOJI_ATLAS_MAX_SIZE) + " px";
+        return false;
+    }
+    if (emoji.empty() || emoji.size() > UINT16_MAX)
+    {
+        *error = "an atlas holds 1 to " + std::to_string(UINT16_MAX) + " emoji";
+        return false;
+    }
+
+    std::vector<const EmojiAtlasInput *> sorted;
+    for (const EmojiAtlasInput &input : emoji)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "U+%04X", (unsigned)input.codepoint);
+        if (input.width < 1 || input.height < 1 || input.rgba.size() != (size_t)input.width * input.height * 4)
+        {
+            *error = std::string(name) + ": pixels do not match the size";
+            return false;
+        }
+        sorted.push_back(&input);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const EmojiAtlasInput *a, const EmojiAtlasInput *b) { return a->codepoint < b->codepoint; });
+    for (size_t i = 1; i < sorted.size(); i++)
+    {
+        if (sorted[i]->codepoint == sorted[i - 1]->codepoint)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "U+%04X", (unsigned)sorted[i]->codepoint);
+            *error = std::string(name) + ": given twice";
+            return false;
+        }
+    }
+
+    // Header, table, then the images, each at a 4-byte boundary
+    const uint32_t image_bytes = emoji_atlas_image_bytes(size, size);
+    const uint32_t stride = (image_bytes + 3) & ~3u;
+    const uint32_t first = (uint32_t)(sizeof(EmojiAtlasHeader) + sorted.size() * sizeof(EmojiAtlasEntry));
+    atlas->assign(first + stride * sorted.size(), 0);
+
+    EmojiAtlasHeader header = {};
+    header.magic = EMOJI_ATLAS_MAGIC;
+    header.version = EMOJI_ATLAS_VERSION;
+    header.count = (uint16_t)sorted.size();
+    header.width = (uint16_t)size;
+    header.height = (uint16_t)size;
+    header.size = (uint32_t)atlas->size();
+    memcpy(atlas->data(), &header, sizeof(header));
+
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        EmojiAtlasEntry entry = {sorted[i]->codepoint, first + stride * (uint32_t)i};
+        memcpy(atlas->data() + sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
+        convert(*sorted[i], size, atlas->data() + entry.offset);
+    }
+    return true;
+}
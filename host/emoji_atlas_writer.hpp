@@ -0,0 +1,23 @@
+// Packs color emoji into an emoji atlas (see main/emoji_atlas.hpp).
+// Shared by the emoji_atlas_pack tool and the atlas unit test.
+
+#pragma once
+
+#include "emoji_atlas.hpp"
+#include <string>
+#include <vector>
+
+struct EmojiAtlasInput
+{
+    uint32_t codepoint;  // what EmojiAtlas::find() finds it by
+    int width;
+    int height;
+    std::vector<uint8_t> rgba;  // width x height RGBA pixels, alpha not premultiplied
+};
+
+// Packs the emoji as size x size images, sorted by codepoint. Larger images
+// are scaled down to fit, keeping their aspect ratio; smaller ones are not
+// scaled up. Either way they are centered. On failure *error says which
+// emoji could not be packed and why.
+bool emoji_atlas_pack(const std::vector<EmojiAtlasInput> &emoji, int size, std::vector<uint8_t> *atlas,
+                      std::string *error);
@@ -0,0 +1,114 @@
+// Packs fonts into a glyph atlas for the "glyphs" flash partition.
+//
+// Each font is given as name=source. The name is what the firmware looks the
+// font up by ("text" and "emoji" for the board), the source is either one of
+// the fonts built into the firmware (ShareTech140, NotoEmoji64) or a font
+// converted with lv_font_conv --format bin --no-compress. Without fonts the
+// board's two built-in fonts are packed.
+//
+// Usage: glyph_atlas_pack [-o FILE] [name=source ...]
+//
+// Flash the result with
+//   parttool.py write_partition --partition-name glyphs --input FILE
+
+#include "glyph_atlas_writer.hpp"
+#include "grid_board.hpp"
+#include "esp_log.h"
+#include "lvgl.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const lv_font_t *builtin_font(const std::string &source)
+{
+    if (source == "ShareTech140")
+        return &ShareTech140;
+    if (source == "NotoEmoji64")
+        return &NotoEmoji64;
+    return nullptr;
+}
+
+int main(int argc, char **argv)
+{
+    esp_log_host_level = 1;
+    lv_init();
+
+    const char *output = "glyphs.bin";
+    std::vector<GlyphAtlasInput> fonts;
+    std::vector<lv_font_t *> loaded;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            output = argv[++i];
+            continue;
+        }
+        const char *eq = strchr(argv[i], '=');
+        if (!eq)
+        {
+            fprintf(stderr, "Expected name=source, got %s\n", argv[i]);
+            return 2;
+        }
+        std::string name(argv[i], eq - argv[i]);
+        std::string source(eq + 1);
+        const lv_font_t *font = builtin_font(source);
+        if (!font)
+        {
+            lv_font_t *file_font = lv_binfont_create(("A:" + source).c_str());
+            if (!file_font)
+            {
+                fprintf(stderr, "Cannot load font %s\n", source.c_str());
+                return 2;
+            }
+            loaded.push_back(file_font);
+            font = file_font;
+        }
+        fonts.push_back({name, font});
+    }
+    if (fonts.empty())
+    {
+        fonts.push_back({GLYPH_ATLAS_FONT_TEXT, &ShareTech140});
+        fonts.push_back({GLYPH_ATLAS_FONT_EMOJI, &NotoEmoji64});
+    }
+
+    std::vector<uint8_t> atlas;
+    std::string error;
+    if (!glyph_atlas_pack(fonts, &atlas, &error))
+    {
+        fprintf(stderr, "Cannot pack the atlas: %s\n", error.c_str());
+        return 1;
+    }
+
+    // Packing is only done if the firmware can read it back
+    GlyphAtlas check;
+    if (!check.open(atlas.data(), atlas.size()))
+    {
+        fprintf(stderr, "The packed atlas does not load\n");
+        return 1;
+    }
+
+    FILE *f = fopen(output, "wb");
+    if (!f || fwrite(atlas.data(), 1, atlas.size(), f) != atlas.size())
+    {
+        fprintf(stderr, "Cannot write %s\n", output);
+        if (f)
+            fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    printf("%s: %u bytes\n", output, (unsigned)atlas.size());
+    for (const GlyphAtlasInput &input : fonts)
+    {
+        const lv_font_fmt_txt_dsc_t *dsc = (const lv_font_fmt_txt_dsc_t *)input.font->dsc;
+        printf("  %-16s %3d px, %d bpp, %d character maps\n", input.name.c_str(), (int)input.font->line_height,
+               (int)dsc->bpp, (int)dsc->cmap_num);
+    }
+
+    check.close();
+    for (lv_font_t *font : loaded)
+        lv_binfont_destroy(font);
+    lv_deinit();
+    return 0;
+}
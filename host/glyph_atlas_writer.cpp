@@ -0,0 +1,168 @@
+#include "glyph_atlas_writer.hpp"
+#include <cstring>
+
+// Appends data at the next 4-byte boundary and returns its offset
+static uint32_t append(std::vector<uint8_t> *atlas, const void *data, size_t size)
+{
+    while (atlas->size() % 4)
+        atlas->push_back(0);
+    uint32_t offset = (uint32_t)atlas->size();
+    const uint8_t *p = (const uint8_t *)data;
+    atlas->insert(atlas->end(), p, p + size);
+    return offset;
+}
+
+// Glyph ids run from 0 to the highest one a character map can produce
+static uint32_t count_glyphs(const lv_font_fmt_txt_dsc_t *dsc)
+{
+    uint32_t last = 0;
+    for (int i = 0; i < dsc->cmap_num; i++)
+    {
+        const lv_font_fmt_txt_cmap_t &c = dsc->cmaps[i];
+        switch (c.type)
+        {
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+            last = LV_MAX(last, (uint32_t)c.glyph_id_start + c.range_length - 1);
+            break;
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+            last = LV_MAX(last, (uint32_t)c.glyph_id_start + c.list_length - 1);
+            break;
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+            for (int k = 0; k < c.range_length; k++)
+                last = LV_MAX(last, (uint32_t)c.glyph_id_start + ((const uint8_t *)c.glyph_id_ofs_list)[k]);
+            break;
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
+            for (int k = 0; k < c.list_length; k++)
+                last = LV_MAX(last, (uint32_t)c.glyph_id_start + ((const uint16_t *)c.glyph_id_ofs_list)[k]);
+            break;
+        }
+    }
+    return last + 1;
+}
+
+static bool pack_font(const GlyphAtlasInput &input, std::vector<uint8_t> *atlas, GlyphAtlasFont *packed,
+                      std::string *error)
+{
+    const lv_font_t *font = input.font;
+    if (!font || font->get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt || !font->dsc)
+    {
+        *error = "not an LVGL bitmap font";
+        return false;
+    }
+    const lv_font_fmt_txt_dsc_t *dsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+    if (dsc->bitmap_format != LV_FONT_FMT_TXT_PLAIN)
+    {
+        *error = "compressed bitmaps, convert the font with --no-compress";
+        return false;
+    }
+    if (input.name.empty() || input.name.size() > GLYPH_ATLAS_NAME_LEN)
+    {
+        *error = "name must have 1 to 16 characters";
+        return false;
+    }
+
+    memset(packed, 0, sizeof(*packed));
+    memcpy(packed->name, input.name.data(), input.name.size());
+    packed->line_height = (int16_t)font->line_height;
+    packed->base_line = (int16_t)font->base_line;
+    packed->underline_position = font->underline_position;
+    packed->underline_thickness = font->underline_thickness;
+    packed->bpp = (uint8_t)dsc->bpp;
+    packed->cmap_num = dsc->cmap_num;
+
+    const uint32_t glyph_count = count_glyphs(dsc);
+    packed->glyph_count = glyph_count;
+    std::vector<GlyphAtlasGlyph> glyphs(glyph_count);
+    uint32_t bitmap_size = 0;
+    for (uint32_t i = 0; i < glyph_count; i++)
+    {
+        const lv_font_fmt_txt_glyph_dsc_t &g = dsc->glyph_dsc[i];
+        glyphs[i] = {(uint32_t)g.bitmap_index, (uint32_t)g.adv_w, (uint16_t)g.box_w, (uint16_t)g.box_h,
+                     (int16_t)g.ofs_x, (int16_t)g.ofs_y};
+        uint32_t bytes = glyph_atlas_bitmap_bytes(g.box_w, g.box_h, dsc->bpp);
+        if (bytes)
+            bitmap_size = LV_MAX(bitmap_size, (uint32_t)g.bitmap_index + bytes);
+    }
+    packed->glyphs = append(atlas, glyphs.data(), glyphs.size() * sizeof(GlyphAtlasGlyph));
+    packed->bitmaps = append(atlas, dsc->glyph_bitmap, bitmap_size);
+    packed->bitmap_size = bitmap_size;
+
+    std::vector<GlyphAtlasCmap> cmaps(dsc->cmap_num);
+    for (int i = 0; i < dsc->cmap_num; i++)
+    {
+        const lv_font_fmt_txt_cmap_t &c = dsc->cmaps[i];
+        GlyphAtlasCmap &out = cmaps[i];
+        memset(&out, 0, sizeof(out));
+        out.range_start = c.range_start;
+        out.range_length = c.range_length;
+        out.glyph_id_start = c.glyph_id_start;
+        out.list_length = c.list_length;
+        out.type = (uint8_t)c.type;
+        if (c.unicode_list)
+            out.unicode_list = append(atlas, c.unicode_list, c.list_length * sizeof(uint16_t));
+        if (c.glyph_id_ofs_list && c.type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL)
+            out.glyph_id_ofs_list = append(atlas, c.glyph_id_ofs_list, c.range_length);
+        else if (c.glyph_id_ofs_list && c.type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL)
+            out.glyph_id_ofs_list = append(atlas, c.glyph_id_ofs_list, c.list_length * sizeof(uint16_t));
+    }
+    packed->cmaps = append(atlas, cmaps.data(), cmaps.size() * sizeof(GlyphAtlasCmap));
+
+    if (dsc->kern_dsc && dsc->kern_classes)
+    {
+        const lv_font_fmt_txt_kern_classes_t *k = (const lv_font_fmt_txt_kern_classes_t *)dsc->kern_dsc;
+        GlyphAtlasKernClasses out = {};
+        out.class_pair_values = append(atlas, k->class_pair_values, (size_t)k->left_class_cnt * k->right_class_cnt);
+        out.left_class_mapping = append(atlas, k->left_class_mapping, glyph_count);
+        out.right_class_mapping = append(atlas, k->right_class_mapping, glyph_count);
+        out.left_class_cnt = k->left_class_cnt;
+        out.right_class_cnt = k->right_class_cnt;
+        packed->kern_table = append(atlas, &out, sizeof(out));
+        packed->kern = GLYPH_ATLAS_KERN_CLASSES;
+        packed->kern_scale = dsc->kern_scale;
+    }
+    else if (dsc->kern_dsc)
+    {
+        const lv_font_fmt_txt_kern_pair_t *k = (const lv_font_fmt_txt_kern_pair_t *)dsc->kern_dsc;
+        GlyphAtlasKernPairs out = {};
+        out.glyph_ids = append(atlas, k->glyph_ids, (size_t)k->pair_cnt * 2 * (k->glyph_ids_size + 1));
+        out.values = append(atlas, k->values, k->pair_cnt);
+        out.pair_cnt = k->pair_cnt;
+        out.glyph_ids_size = k->glyph_ids_size;
+        packed->kern_table = append(atlas, &out, sizeof(out));
+        packed->kern = GLYPH_ATLAS_KERN_PAIRS;
+        packed->kern_scale = dsc->kern_scale;
+    }
+    return true;
+}
+
+bool glyph_atlas_pack(const std::vector<GlyphAtlasInput> &fonts, std::vector<uint8_t> *atlas, std::string *error)
+{
+    if (fonts.empty() || fonts.size() > GLYPH_ATLAS_MAX_FONTS)
+    {
+        *error = "an atlas holds 1 to " + std::to_string(GLYPH_ATLAS_MAX_FONTS) + " fonts";
+        return false;
+    }
+
+    // Header and font table first, filled in once the tables are placed
+    atlas->assign(sizeof(GlyphAtlasHeader) + fonts.size() * sizeof(GlyphAtlasFont), 0);
+    std::vector<GlyphAtlasFont> packed(fonts.size());
+    for (size_t i = 0; i < fonts.size(); i++)
+    {
+        if (!pack_font(fonts[i], atlas, &packed[i], error))
+        {
+            *error = fonts[i].name + ": " + *error;
+            return false;
+        }
+    }
+    while (atlas->size() % 4)
+        atlas->push_back(0);
+
+    GlyphAtlasHeader header = {};
+    header.magic = GLYPH_ATLAS_MAGIC;
+    header.version = GLYPH_ATLAS_VERSION;
+    header.font_count = (uint16_t)fonts.size();
+    header.size = (uint32_t)atlas->size();
+    memcpy(atlas->data(), &header, sizeof(header));
+    memcpy(atlas->data() + sizeof(header), packed.data(), packed.size() * sizeof(GlyphAtlasFont));
+    return true;
+}
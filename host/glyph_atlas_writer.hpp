@@ -0,0 +1,19 @@
+// Packs LVGL bitmap fonts into a glyph atlas (see main/glyph_atlas.hpp).
+// Shared by the glyph_atlas_pack tool and the atlas unit test.
+
+#pragma once
+
+#include "glyph_atlas.hpp"
+#include <string>
+#include <vector>
+
+struct GlyphAtlasInput
+{
+    std::string name;  // what GlyphAtlas::font() finds it by
+    const lv_font_t *font;
+};
+
+// Packs fonts in order. The fonts have to be uncompressed lv_font_fmt_txt
+// fonts, like the ones lv_font_conv writes with --no-compress. On failure
+// *error says which font could not be packed and why.
+bool glyph_atlas_pack(const std::vector<GlyphAtlasInput> &fonts, std::vector<uint8_t> *atlas, std::string *error);
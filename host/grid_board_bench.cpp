@@ -0,0 +1,548 @@
+// Headless benchmark of GridBoard.
+//
+// Runs the board against an in-memory RGB565 display sized for the selected
+// layout (1280x720 for the landscape presets), driven by a virtual tick,
+// pushes a script of messages and reports per message how long the board took
+// to settle, how many frames were rendered and how expensive they were, LVGL
+// heap high-water mark and object count. With --scroll, messages longer than
+// the board run as a marquee during the hold time. With --compiled, messages
+// are laid out ahead of time by Playlist and switched without parsing; the
+// switch time is reported either way. With --queue, messages are posted to a
+// BoardMessageQueue and taken by the board's message timer, woken through the
+// post callback as on the device; a message the board never takes fails the
+// run. --transition selects how cards enter
+// their slot; the per-frame render time and flushed area show what each
+// effect costs, --parallel caps how many cards spin at once. --emoji draws
+// emoji from an emoji atlas file and reports what blitting them into tiles
+// costs per cell. Frames can be
+// dumped as PPM files, and every settled frame is summarized by a checksum so
+// two runs can be compared without keeping images around.
+//
+// Usage: grid_board_bench [--mode objects|widget] [--tiles N] [--seed N]
+//                         [--layout 12x5|16x6|8x3|portrait]
+//                         [--scroll left|up] [--speed N] [--compiled]
+//                         [--queue]
+//                         [--transition drop|fade|slide|typewriter|flap]
+//                         [--parallel N] [--emoji FILE]
+//                         [--script FILE] [--hold MS] [--dump DIR]
+//                         [--dump-all] [--verbose]
+
+#include "emoji_atlas.hpp"
+#include "grid_board.hpp"
+#include "message_queue.hpp"
+#include "playlist.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define BENCH_SETTLE_TIMEOUT_MS 60000
+
+static const char *default_script[] = {
+    "HELLO WORLD",
+    "HELLO THERE",
+    "GRID BOARD ON TAB5 ❤️",
+    "",
+    "0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+    "SAME LENGTH",
+    "SAME LENGTH",
+    "NEWS TICKER: MESSAGES LONGER THAN THE BOARD SCROLL THROUGH IT IN SCROLL MODE, "
+    "OTHERWISE THEY ARE CUT OFF AFTER THE LAST CELL",
+};
+
+struct BenchOptions
+{
+    GridRenderMode mode = GRID_RENDER_OBJECTS;
+    const GridLayout *layout = &GRID_LAYOUT_12X5;
+    bool scroll = false;
+    bool compiled = false;
+    bool queued = false;
+    CardTransition transition = CARD_TRANSITION_DROP;
+    GridScrollDirection scroll_direction = GRID_SCROLL_LEFT;
+    int scroll_speed = 8;
+    int tiles = 0;
+    int parallel = MAX_PARALLEL_ANIMATIONS;
+    uint32_t seed = 1;
+    uint32_t hold_ms = 500;
+    const char *script = nullptr;
+    const char *emoji = nullptr;
+    const char *dump_dir = nullptr;
+    bool dump_all = false;
+};
+
+struct FrameCounters
+{
+    uint32_t flushes;
+    uint64_t flushed_px;
+    uint32_t frame_index;
+};
+
+static uint32_t virtual_ms = 0;
+static uint16_t *frame_buffer = nullptr;
+static int screen_width = 0;
+static int screen_height = 0;
+static FrameCounters counters{};
+static BenchOptions options;
+
+static uint32_t virtual_tick(void)
+{
+    return virtual_ms;
+}
+
+// FNV-1a over the whole frame buffer
+static uint32_t frame_checksum(void)
+{
+    const uint8_t *p = (const uint8_t *)frame_buffer;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < (size_t)screen_width * screen_height * 2; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void dump_frame(const char *name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.ppm", options.dump_dir, name);
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return;
+    }
+
+    fprintf(f, "P6\n%d %d\n255\n", screen_width, screen_height);
+    std::vector<uint8_t> row(screen_width * 3);
+    for (int y = 0; y < screen_height; y++)
+    {
+        for (int x = 0; x < screen_width; x++)
+        {
+            uint16_t c = frame_buffer[y * screen_width + x];
+            row[x * 3 + 0] = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
+            row[x * 3 + 1] = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
+            row[x * 3 + 2] = (uint8_t)((c & 0x1F) * 255 / 31);
+        }
+        fwrite(row.data(), 1, row.size(), f);
+    }
+    fclose(f);
+}
+
+// Direct mode: the buffer always holds the complete frame, so flushing only
+// has to account for the area that was redrawn
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *)
+{
+    counters.flushes++;
+    counters.flushed_px += (uint64_t)lv_area_get_width(area) * lv_area_get_height(area);
+
+    if (lv_display_flush_is_last(disp))
+    {
+        if (options.dump_dir && options.dump_all)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "frame_%05u", (unsigned)counters.frame_index);
+            dump_frame(name);
+        }
+        counters.frame_index++;
+    }
+    lv_display_flush_ready(disp);
+}
+
+static uint32_t count_objects(lv_obj_t *obj)
+{
+    uint32_t n = 1;
+    uint32_t children = lv_obj_get_child_count(obj);
+    for (uint32_t i = 0; i < children; i++)
+    {
+        n += count_objects(lv_obj_get_child(obj, i));
+    }
+    return n;
+}
+
+// Post callback of --queue. Stands in for lvgl_port_call_async(): the bench
+// posts between two lv_timer_handler() calls, on the LVGL thread already.
+static void take_messages(void *arg)
+{
+    ((GridBoard *)arg)->take_messages();
+}
+
+// Run LVGL on virtual time, jumping straight to the next timer deadline
+static void run_for(uint32_t ms)
+{
+    uint32_t end = virtual_ms + ms;
+    while (virtual_ms < end)
+    {
+        uint32_t next = lv_timer_handler();
+        if (next == 0)
+            next = 1;
+        if (next > end - virtual_ms)
+            next = end - virtual_ms;
+        virtual_ms += next;
+    }
+}
+
+static uint32_t run_until_settled(GridBoard *board)
+{
+    uint32_t start = virtual_ms;
+    while (board->is_animation_running() && virtual_ms - start < BENCH_SETTLE_TIMEOUT_MS)
+    {
+        run_for(1);
+    }
+    uint32_t settle_ms = virtual_ms - start;
+
+    // Let the final state reach the frame buffer
+    run_for(LV_DEF_REFR_PERIOD * 2);
+    return settle_ms;
+}
+
+static bool load_script(const char *path, std::vector<std::string> &messages)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#')
+            continue;
+        messages.push_back(line);  // an empty line clears the board
+    }
+    fclose(f);
+    return true;
+}
+
+static bool parse_args(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--mode") == 0 && value)
+        {
+            options.mode = strcmp(value, "widget") == 0 ? GRID_RENDER_WIDGET : GRID_RENDER_OBJECTS;
+            i++;
+        }
+        else if (strcmp(arg, "--layout") == 0 && value)
+        {
+            options.layout = grid_layout_find(value);
+            if (!options.layout)
+            {
+                fprintf(stderr, "Unknown layout: %s\n", value);
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--scroll") == 0 && value)
+        {
+            options.scroll = true;
+            options.scroll_direction = strcmp(value, "up") == 0 ? GRID_SCROLL_UP : GRID_SCROLL_LEFT;
+            i++;
+        }
+        else if (strcmp(arg, "--transition") == 0 && value)
+        {
+            if (!card_transition_find(value, &options.transition))
+            {
+                fprintf(stderr, "Unknown transition: %s\n", value);
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--compiled") == 0)
+        {
+            options.compiled = true;
+        }
+        else if (strcmp(arg, "--queue") == 0)
+        {
+            options.queued = true;
+        }
+        else if (strcmp(arg, "--speed") == 0 && value)
+        {
+            options.scroll_speed = atoi(value);
+            i++;
+        }
+        else if (strcmp(arg, "--parallel") == 0 && value)
+        {
+            options.parallel = atoi(value);
+            i++;
+        }
+        else if (strcmp(arg, "--tiles") == 0 && value)
+        {
+            options.tiles = atoi(value);
+            i++;
+        }
+        else if (strcmp(arg, "--seed") == 0 && value)
+        {
+            options.seed = (uint32_t)strtoul(value, nullptr, 0);
+            i++;
+        }
+        else if (strcmp(arg, "--hold") == 0 && value)
+        {
+            options.hold_ms = (uint32_t)atoi(value);
+            i++;
+        }
+        else if (strcmp(arg, "--script") == 0 && value)
+        {
+            options.script = value;
+            i++;
+        }
+        else if (strcmp(arg, "--emoji") == 0 && value)
+        {
+            options.emoji = value;
+            i++;
+        }
+        else if (strcmp(arg, "--dump") == 0 && value)
+        {
+            options.dump_dir = value;
+            i++;
+        }
+        else if (strcmp(arg, "--dump-all") == 0)
+        {
+            options.dump_all = true;
+        }
+        else if (strcmp(arg, "--verbose") == 0)
+        {
+            esp_log_host_level = 3;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown argument: %s\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    esp_log_host_level = 1;
+    if (!parse_args(argc, argv))
+        return 2;
+
+    std::vector<std::string> messages;
+    if (options.script)
+    {
+        if (!load_script(options.script, messages))
+        {
+            fprintf(stderr, "Cannot read script %s\n", options.script);
+            return 2;
+        }
+    }
+    else
+    {
+        messages.assign(default_script, default_script + sizeof(default_script) / sizeof(default_script[0]));
+    }
+
+    lv_init();
+    lv_tick_set_cb(virtual_tick);
+
+    screen_width = options.layout->screen_width;
+    screen_height = options.layout->screen_height;
+    size_t buf_size = (size_t)screen_width * screen_height * sizeof(uint16_t);
+    frame_buffer = (uint16_t *)malloc(buf_size);
+    lv_display_t *disp = lv_display_create(screen_width, screen_height);
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_buffers(disp, frame_buffer, nullptr, buf_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_cb);
+
+    // The atlas is read into memory, as the firmware maps it from flash
+    std::vector<uint8_t> emoji_data;
+    EmojiAtlas emoji_atlas;
+    if (options.emoji)
+    {
+        FILE *f = fopen(options.emoji, "rb");
+        int c;
+        while (f && (c = fgetc(f)) != EOF)
+            emoji_data.push_back((uint8_t)c);
+        if (f)
+            fclose(f);
+        if (!emoji_atlas.open(emoji_data.data(), emoji_data.size()))
+        {
+            fprintf(stderr, "Cannot load the emoji atlas %s\n", options.emoji);
+            return 2;
+        }
+    }
+
+    GridBoard *board = new GridBoard();
+    board->set_render_mode(options.mode);
+    if (options.emoji)
+        board->set_emoji_atlas(&emoji_atlas);
+    board->set_layout(*options.layout);
+    if (options.scroll)
+    {
+        board->set_long_text_mode(GRID_LONG_TEXT_SCROLL, options.scroll_direction);
+        board->set_scroll_speed(options.scroll_speed);
+    }
+    board->set_tile_cache_size(options.tiles);
+    board->set_transition(options.transition);
+    board->set_max_parallel_animations(options.parallel);
+    board->set_random_seed(options.seed);
+    BoardMessageQueue queue(4);
+    if (options.queued)
+    {
+        queue.set_post_callback(take_messages, board);
+        board->set_message_queue(&queue);
+    }
+    board->initialize(lv_screen_active());
+    run_for(LV_DEF_REFR_PERIOD * 2);
+
+    // One playlist entry per non-empty message; the empty ones clear the board
+    Playlist playlist;
+    std::vector<int> entry_of(messages.size(), -1);
+    if (options.compiled)
+    {
+        std::string source;
+        int entries = 0;
+        for (size_t i = 0; i < messages.size(); i++)
+        {
+            if (messages[i].empty())
+                continue;
+            source += "| " + messages[i] + "\n";
+            entry_of[i] = entries++;
+        }
+        if (entries > 0 && (!playlist.compile(source, *options.layout) || playlist.size() != entries))
+        {
+            fprintf(stderr, "Cannot compile the script as a playlist\n");
+            return 2;
+        }
+    }
+
+    printf("mode=%s layout=%s transition=%s tiles=%d parallel=%d draw_units=%d seed=%u messages=%d%s%s\n",
+           options.mode == GRID_RENDER_WIDGET ? "widget" : "objects", options.layout->name,
+           card_transition_name(board->get_transition()), options.tiles, options.parallel, LV_DRAW_SW_DRAW_UNIT_CNT,
+           (unsigned)options.seed, (int)messages.size(), options.compiled ? " compiled" : "",
+           options.queued ? " queued" : "");
+    printf("%-3s %8s %7s %9s %9s %11s %7s %9s %9s  %s\n", "#", "settle", "frames", "avg_us", "max_us",
+           "flushed_px", "objs", "heap", "heap_max", "checksum");
+
+    uint64_t total_frames = 0;
+    uint64_t total_render_us = 0;
+    uint32_t total_max_us = 0;
+    uint64_t total_px = 0;
+    uint64_t total_scroll_steps = 0;
+    uint64_t total_switch_us = 0;
+    uint64_t max_switch_us = 0;
+    bool all_settled = true;
+
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+        board->reset_stats();
+        counters.flushes = 0;
+        counters.flushed_px = 0;
+
+        int64_t switch_start = esp_timer_get_time();
+        if (entry_of[i] >= 0)
+        {
+            playlist.show(*board, entry_of[i]);
+        }
+        else if (options.queued)
+        {
+            queue.post(messages[i]);
+        }
+        else
+        {
+            board->process_text_and_animate(messages[i]);
+        }
+        uint64_t switch_us = esp_timer_get_time() - switch_start;
+        total_switch_us += switch_us;
+        if (switch_us > max_switch_us)
+            max_switch_us = switch_us;
+        if (options.queued)
+        {
+            // The post callback woke the message timer; a marquee that has not
+            // been through once yet keeps the message waiting
+            uint32_t start = virtual_ms;
+            do
+            {
+                run_for(1);
+            } while (queue.size() > 0 && virtual_ms - start < BENCH_SETTLE_TIMEOUT_MS);
+            if (queue.size() > 0)
+            {
+                fprintf(stderr, "Message %d was not taken from the queue\n", (int)i);
+                all_settled = false;
+            }
+        }
+        uint32_t settle_ms = run_until_settled(board);
+        if (board->is_animation_running())
+        {
+            fprintf(stderr, "Message %d did not settle within %d ms\n", (int)i, BENCH_SETTLE_TIMEOUT_MS);
+            all_settled = false;
+        }
+        run_for(options.hold_ms);
+
+        const GridBoardStats &s = board->get_stats();
+        lv_mem_monitor_t mon;
+        lv_mem_monitor(&mon);
+        uint32_t checksum = frame_checksum();
+
+        printf("%-3d %6ums %7lu %9lu %9lu %11llu %7lu %9lu %9lu  %08x  \"%s\"\n", (int)i, (unsigned)settle_ms,
+               (unsigned long)s.frames, (unsigned long)(s.frames ? s.render_time_us / s.frames : 0),
+               (unsigned long)s.render_time_max_us, (unsigned long long)counters.flushed_px,
+               (unsigned long)count_objects(lv_screen_active()),
+               (unsigned long)(mon.total_size - mon.free_size), (unsigned long)mon.max_used,
+               (unsigned)checksum, messages[i].c_str());
+
+        if (options.dump_dir)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "settled_%03d", (int)i);
+            dump_frame(name);
+        }
+
+        total_frames += s.frames;
+        total_render_us += s.render_time_us;
+        if (s.render_time_max_us > total_max_us)
+            total_max_us = s.render_time_max_us;
+        total_px += counters.flushed_px;
+        total_scroll_steps += s.scroll_steps;
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("total: %llu frames, avg %llu us, max %u us, %llu px flushed, LVGL heap high-water %lu of %lu bytes\n",
+           (unsigned long long)total_frames,
+           (unsigned long long)(total_frames ? total_render_us / total_frames : 0), (unsigned)total_max_us,
+           (unsigned long long)total_px, (unsigned long)mon.max_used, (unsigned long)mon.total_size);
+    printf("transition: %s, %llu px flushed per frame\n", card_transition_name(board->get_transition()),
+           (unsigned long long)(total_frames ? total_px / total_frames : 0));
+    if (const SplitFlapRenderer *flaps = board->get_flap_renderer())
+    {
+        const SplitFlapStats &fs = flaps->get_stats();
+        printf("flaps: %lu composed, %lu reused, %llu rows copied, %llu us composing\n",
+               (unsigned long)fs.composed, (unsigned long)fs.reused, (unsigned long long)fs.rows,
+               (unsigned long long)fs.compose_time_us);
+    }
+    if (options.emoji)
+    {
+        const GlyphTileCache *cache = board->get_tile_cache();
+        const uint32_t blits = cache ? cache->get_stats().emoji_blits : 0;
+        if (blits > 0)
+        {
+            printf("emoji: %d in the atlas, %lu tiles blitted, avg %llu us per cell\n", emoji_atlas.count(),
+                   (unsigned long)blits, (unsigned long long)(cache->get_stats().emoji_blit_us / blits));
+        }
+        else
+        {
+            printf("emoji: %d in the atlas, blended by LVGL whenever a card is drawn\n", emoji_atlas.count());
+        }
+    }
+    printf("switch: avg %llu us, max %llu us (%s)\n",
+           (unsigned long long)(messages.empty() ? 0 : total_switch_us / messages.size()),
+           (unsigned long long)max_switch_us, options.compiled ? "compiled" : (options.queued ? "queued" : "parsed"));
+    if (options.scroll)
+    {
+        printf("marquee: %llu scroll steps\n", (unsigned long long)total_scroll_steps);
+    }
+
+    delete board;
+    lv_display_delete(disp);
+    free(frame_buffer);
+    lv_deinit();
+    return all_settled ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file lv_conf.h
+ * @brief LVGL configuration of the host build
+ *
+ * Mirrors the LVGL settings of sdkconfig that affect rendering and memory, so
+ * host numbers are comparable with the device. Everything else keeps the
+ * LVGL defaults from lv_conf_internal.h.
+ */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE (64 * 1024U)
+
+#define LV_DEF_REFR_PERIOD 33
+#define LV_DPI_DEF 130
+
+/* HOST_DRAW_UNITS comes from CMake; threads stand in for the FreeRTOS tasks */
+#ifndef HOST_DRAW_UNITS
+#define HOST_DRAW_UNITS 1
+#endif
+#if HOST_DRAW_UNITS > 1
+#define LV_USE_OS LV_OS_PTHREAD
+#else
+#define LV_USE_OS LV_OS_NONE
+#endif
+#define LV_DRAW_SW_DRAW_UNIT_CNT HOST_DRAW_UNITS
+#define LV_DRAW_BUF_STRIDE_ALIGN 1
+#define LV_DRAW_BUF_ALIGN 4
+#define LV_CACHE_DEF_SIZE 0
+
+#define LV_USE_FLOAT 0
+#define LV_USE_LOG 0
+
+#define LV_FONT_FMT_TXT_LARGE 1
+
+/* glyph_atlas_pack reads lv_font_conv binary fonts through stdio */
+#define LV_USE_FS_STDIO 1
+#define LV_FS_STDIO_LETTER 'A'
+#define LV_USE_CANVAS 1
+
+#endif /* LV_CONF_H */
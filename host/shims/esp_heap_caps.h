@@ -0,0 +1,36 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief Host replacement of the capability-based heap, backed by malloc
+ */
+
+#ifndef ESP_HEAP_CAPS_HOST_H
+#define ESP_HEAP_CAPS_HOST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HEAP_CAPS_HOST_H */
@@ -0,0 +1,34 @@
+/**
+ * @file esp_log.h
+ * @brief Host replacement of the ESP-IDF logging macros
+ */
+
+#ifndef ESP_LOG_HOST_H
+#define ESP_LOG_HOST_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 0 = errors only, 1 = warnings, 2 = info (default), 3 = debug */
+extern int esp_log_host_level;
+
+#define ESP_HOST_LOG(level, letter, tag, format, ...)                          \
+    do {                                                                       \
+        if (esp_log_host_level >= (level)) {                                   \
+            printf(letter " (%s) " format "\n", tag, ##__VA_ARGS__);           \
+        }                                                                      \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_HOST_LOG(0, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_HOST_LOG(1, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_HOST_LOG(2, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_HOST_LOG(3, "D", tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_LOG_HOST_H */
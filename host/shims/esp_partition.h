@@ -0,0 +1,78 @@
+/**
+ * @file esp_partition.h
+ * @brief Host replacement of the partition API: there is no flash, so no
+ * partition is ever found. Atlases are opened from memory on the host.
+ */
+
+#ifndef ESP_PARTITION_HOST_H
+#define ESP_PARTITION_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum
+{
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+#define ESP_PARTITION_SUBTYPE_ANY 0xff
+typedef int esp_partition_subtype_t;
+
+typedef enum
+{
+    ESP_PARTITION_MMAP_DATA,
+    ESP_PARTITION_MMAP_INST,
+} esp_partition_mmap_memory_t;
+
+typedef uint32_t esp_partition_mmap_handle_t;
+
+typedef struct
+{
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+static inline const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                              esp_partition_subtype_t subtype, const char *label)
+{
+    (void)type;
+    (void)subtype;
+    (void)label;
+    return NULL;
+}
+
+static inline esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                                           esp_partition_mmap_memory_t memory, const void **out_ptr,
+                                           esp_partition_mmap_handle_t *out_handle)
+{
+    (void)partition;
+    (void)offset;
+    (void)size;
+    (void)memory;
+    (void)out_ptr;
+    (void)out_handle;
+    return ESP_FAIL;
+}
+
+static inline void esp_partition_munmap(esp_partition_mmap_handle_t handle)
+{
+    (void)handle;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_PARTITION_HOST_H */
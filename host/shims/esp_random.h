@@ -0,0 +1,21 @@
+/**
+ * @file esp_random.h
+ * @brief Host replacement of esp_random(), deterministic across runs
+ */
+
+#ifndef ESP_RANDOM_HOST_H
+#define ESP_RANDOM_HOST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_RANDOM_HOST_H */
@@ -0,0 +1,23 @@
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include <time.h>
+
+int esp_log_host_level = 2;
+
+// xorshift32 with a fixed start, so two runs see the same sequence
+uint32_t esp_random(void)
+{
+    static uint32_t state = 0x2545F491u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
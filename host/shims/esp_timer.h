@@ -0,0 +1,24 @@
+/**
+ * @file esp_timer.h
+ * @brief Host replacement of esp_timer_get_time()
+ *
+ * Returns wall-clock microseconds, so render timings measure real CPU time
+ * while LVGL itself runs on the virtual tick of the harness.
+ */
+
+#ifndef ESP_TIMER_HOST_H
+#define ESP_TIMER_HOST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_TIMER_HOST_H */
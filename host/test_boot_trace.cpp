@@ -0,0 +1,161 @@
+// Unit tests of the boot-phase tracer
+
+#include "boot_trace.h"
+#include "test_check.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Manual clock, in microseconds
+static int64_t now_us = 0;
+static int64_t fake_clock()
+{
+    return now_us;
+}
+
+static void start()
+{
+    boot_trace_reset();
+    boot_trace_set_clock(fake_clock);
+    now_us = 0;
+}
+
+static void collect(const char *line, void *arg)
+{
+    std::string *out = static_cast<std::string *>(arg);
+    *out += line;
+    *out += '\n';
+}
+
+static void test_record()
+{
+    start();
+    now_us = 1000;
+    int nvs = boot_trace_begin("nvs");
+    now_us = 3500;
+    boot_trace_end(nvs);
+    boot_trace_mark("ready");
+
+    CHECK(boot_trace_count() == 2);
+    const BootTracePhase *p = boot_trace_get(nvs);
+    CHECK(p && strcmp(p->name, "nvs") == 0 && p->begin_us == 1000 && p->end_us == 3500);
+    p = boot_trace_get(1);
+    CHECK(p && p->begin_us == 3500 && p->end_us == 3500);
+    CHECK(boot_trace_get(2) == nullptr);
+    CHECK(boot_trace_get(-1) == nullptr);
+
+    // An open phase stays open, and ending -1 is harmless
+    int open = boot_trace_begin("bridge");
+    CHECK(boot_trace_get(open)->end_us == -1);
+    boot_trace_end(-1);
+}
+
+static void test_full()
+{
+    start();
+    for (int i = 0; i < BOOT_TRACE_MAX_PHASES; i++)
+        CHECK(boot_trace_begin("phase") == i);
+    CHECK(boot_trace_begin("one too many") == -1);
+    boot_trace_mark("and another");
+    CHECK(boot_trace_count() == BOOT_TRACE_MAX_PHASES);
+    CHECK(boot_trace_dropped() == 2);
+
+    std::string report;
+    boot_trace_report(collect, &report);
+    CHECK(report.find("2 phases dropped") != std::string::npos);
+}
+
+// Startup as main_simple runs it: the display path on one task, SD and C6 on
+// others, overlapping it
+static void test_critical_path()
+{
+    start();
+    now_us = 300000;
+    int nvs = boot_trace_begin("nvs");
+    now_us = 310000;
+    boot_trace_end(nvs);
+    int display = boot_trace_begin("display");
+    now_us = 450000;
+    boot_trace_end(display);
+    int sd = boot_trace_begin("sd mount");  // background task from here on
+    int board = boot_trace_begin("board");
+    int font = boot_trace_begin("font");  // nested in board
+    now_us = 460000;
+    boot_trace_end(font);
+    now_us = 470000;
+    boot_trace_end(board);
+    now_us = 480000;
+    boot_trace_mark("first frame");
+    now_us = 700000;
+    boot_trace_end(sd);
+    now_us = 710000;
+    int c6 = boot_trace_begin("c6 init");
+    now_us = 1310000;
+    boot_trace_end(c6);
+
+    int path[BOOT_TRACE_MAX_PHASES];
+    int len = boot_trace_critical_path(path, BOOT_TRACE_MAX_PHASES);
+    CHECK(len == 4);
+    CHECK(len == 4 && path[0] == nvs && path[1] == display && path[2] == sd && path[3] == c6);
+
+    std::string report;
+    boot_trace_report(collect, &report);
+    CHECK(report.find("Critical path to \"c6 init\", 1310.0 ms") != std::string::npos);
+    CHECK(report.find("1000.0 ms traced, 310.0 ms untraced") != std::string::npos);
+    // Sorted by start time, phases started together keep their order
+    CHECK(report.find("c6 init") > report.find("first frame"));
+    CHECK(report.find("sd mount") < report.find("board"));
+    CHECK(report.find("board") < report.find("font"));
+
+    // A short path buffer keeps the phases closest to the target
+    len = boot_trace_critical_path(path, 2);
+    CHECK(len == 2 && path[0] == sd && path[1] == c6);
+}
+
+static void test_empty()
+{
+    start();
+    int path[4];
+    CHECK(boot_trace_critical_path(path, 4) == 0);
+    std::string report;
+    boot_trace_report(collect, &report);
+    CHECK(report.find("Critical path") == std::string::npos);
+}
+
+static void test_dump()
+{
+    start();
+    now_us = 5000;
+    int id = boot_trace_begin("nvs");
+    now_us = 7000;
+    boot_trace_end(id);
+
+    const char *path = "test_boot_trace.txt";
+    CHECK(boot_trace_dump(path));
+    FILE *f = fopen(path, "r");
+    CHECK(f != nullptr);
+    if (f)
+    {
+        char buf[1024];
+        size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+        buf[n] = 0;
+        fclose(f);
+        CHECK(strstr(buf, "Boot timeline") != nullptr);
+        CHECK(strstr(buf, "nvs") != nullptr);
+    }
+    remove(path);
+    CHECK(!boot_trace_dump("/nonexistent-dir/boot_trace.txt"));
+    CHECK(boot_trace_dump(nullptr));
+}
+
+int main()
+{
+    test_record();
+    test_full();
+    test_critical_path();
+    test_empty();
+    test_dump();
+    boot_trace_set_clock(nullptr);
+
+    return test_summary("boot trace");
+}
@@ -0,0 +1,214 @@
+// Unit tests of the card transitions and their dirty footprints, run through
+// the flip timeline the way the board drives it
+
+#include "card_transition.hpp"
+#include "flip_timeline.hpp"
+#include "test_check.h"
+#include <cstdio>
+#include <cstring>
+
+static const CardGeometry card = {96, 126};
+
+static int area(const SlotRect &r)
+{
+    return slot_rect_empty(r) ? 0 : (r.x2 - r.x1 + 1) * (r.y2 - r.y1 + 1);
+}
+
+// What a slot pixel shows in a pose: nothing, or a pixel of one of the cards
+// (or of a flap of some height), by its position in that source
+struct Appearance
+{
+    int source;  // 0 = slot, 1 = new card, 2 = old card, 3 = old top flap, 4 = new bottom flap
+    int x;
+    int y;
+    int detail;  // opacity or flap height
+    bool operator!=(const Appearance &o) const
+    {
+        return source != o.source || x != o.x || y != o.y || detail != o.detail;
+    }
+};
+
+static Appearance appearance(const CardPose &p, int x, int y)
+{
+    if (p.flap)
+    {
+        int hinge = card_flap_hinge(card);
+        int h = card_flap_height(p.flap, card);
+        if (card_flap_falling(p.flap))
+        {
+            if (y >= hinge)
+                return {2, x, y, 0};
+            return y < hinge - h ? Appearance{1, x, y, 0} : Appearance{3, x, y, h};
+        }
+        if (y < hinge)
+            return {1, x, y, 0};
+        return y < hinge + h ? Appearance{4, x, y, h} : Appearance{2, x, y, 0};
+    }
+    bool covered = p.opa > 0 && x >= p.x && x < p.x + card.width - p.cut && y >= p.y && y < p.y + card.height;
+    if (!covered)
+        return {0, 0, 0, 0};
+    return {1, x - p.x, y - p.y, p.opa};
+}
+
+// Every slot pixel that looks different between two poses, compared pixel
+// by pixel, has to be inside the footprint
+static bool footprint_covers(const CardPose &from, const CardPose &to, const SlotRect &dirty)
+{
+    for (int y = 0; y < card.height; y++)
+    {
+        for (int x = 0; x < card.width; x++)
+        {
+            bool inside = x >= dirty.x1 && x <= dirty.x2 && y >= dirty.y1 && y <= dirty.y2;
+            if (!inside && appearance(from, x, y) != appearance(to, x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Follows one cell's card like the board widget does
+class Recorder : public FlipTimelineListener {
+public:
+    CardPose pose = CARD_POSE_REST;
+    int moves = 0;
+    int lands = 0;
+    int lands_to_settle = 1;
+    long dirty_px = 0;
+    bool footprints_ok = true;
+
+    void on_flip_start(int cell) override {}
+    bool on_flip_landed(int cell) override { return ++lands >= lands_to_settle; }
+    void on_flip_move(int cell, const CardPose &next, const SlotRect &dirty) override
+    {
+        if (!footprint_covers(pose, next, dirty))
+            footprints_ok = false;
+        CHECK(slot_rect_empty(dirty) ||
+              (dirty.x1 >= 0 && dirty.y1 >= 0 && dirty.x2 < card.width && dirty.y2 < card.height));
+        pose = next;
+        moves++;
+        dirty_px += area(dirty);
+    }
+};
+
+static FlipTimelineConfig config(CardTransition transition)
+{
+    return {transition, card, card_transition_duration(transition), 10};
+}
+
+static void test_names()
+{
+    for (int i = 0; i < CARD_TRANSITION_COUNT; i++)
+    {
+        CardTransition found = CARD_TRANSITION_COUNT;
+        CHECK(card_transition_find(card_transition_name((CardTransition)i), &found) && found == i);
+        CHECK(card_transition_duration((CardTransition)i) > 0);
+    }
+    CardTransition found = CARD_TRANSITION_FADE;
+    CHECK(!card_transition_find("spin", &found) && found == CARD_TRANSITION_FADE);
+}
+
+static void test_poses()
+{
+    // Drop keeps the original motion: two slots above to 1.2 slots below
+    CardPose p = DropTransition::pose(0, 333, card);
+    CHECK(p.y == -252 && p.x == 0 && p.opa == CARD_OPA_COVER);
+    CHECK(DropTransition::pose(333, 333, card).y == 151);
+    CHECK(slot_rect_empty(card_visible_rect(p, card)));
+
+    CHECK(FadeTransition::pose(0, 200, card).opa == 0);
+    CHECK(FadeTransition::pose(100, 200, card).opa == 127);
+    CHECK(card_pose_equal(FadeTransition::pose(200, 200, card), CARD_POSE_REST));
+
+    CHECK(SlideTransition::pose(0, 250, card).x == card.width);
+    CHECK(card_pose_equal(SlideTransition::pose(250, 250, card), CARD_POSE_REST));
+
+    CHECK(TypewriterTransition::pose(0, 150, card).cut == card.width);
+    CHECK(TypewriterTransition::pose(75, 150, card).cut == card.width / 2);
+    CHECK(card_pose_equal(TypewriterTransition::pose(150, 150, card), CARD_POSE_REST));
+}
+
+static void test_footprints()
+{
+    // A drop above the slot touches nothing, one entering it only its rows
+    CardPose a = {0, -200, 0, CARD_OPA_COVER, 0};
+    CardPose b = {0, -150, 0, CARD_OPA_COVER, 0};
+    CHECK(slot_rect_empty(DropTransition::footprint(a, b, card)));
+    CardPose c = {0, -100, 0, CARD_OPA_COVER, 0};
+    SlotRect r = DropTransition::footprint(b, c, card);
+    CHECK(r.x1 == 0 && r.x2 == card.width - 1 && r.y1 == 0 && r.y2 == 25);
+
+    // The typewriter only redraws the strip it uncovered
+    CardPose t0 = {0, 0, 60, CARD_OPA_COVER, 0};
+    CardPose t1 = {0, 0, 50, CARD_OPA_COVER, 0};
+    r = TypewriterTransition::footprint(t0, t1, card);
+    CHECK(r.x1 == 36 && r.x2 == 45 && r.y1 == 0 && r.y2 == card.height - 1);
+
+    // A slide leaves the columns left of the card alone
+    CardPose s0 = {40, 0, 0, CARD_OPA_COVER, 0};
+    CardPose s1 = {30, 0, 0, CARD_OPA_COVER, 0};
+    r = SlideTransition::footprint(s0, s1, card);
+    CHECK(r.x1 == 30 && r.x2 == card.width - 1);
+
+    CardPose f0 = {0, 0, 0, 100, 0};
+    CHECK(slot_rect_empty(FadeTransition::footprint(f0, f0, card)));
+    f0.opa = 0;
+    CHECK(area(FadeTransition::footprint(f0, CARD_POSE_REST, card)) == card.width * card.height);
+
+    // The flap folds from the full top half to nothing, then unfolds the
+    // bottom half; between two frames only the rows it swept change
+    CHECK(card_flap_height(1, card) == card_flap_hinge(card));
+    CHECK(card_flap_height(512, card) == 0);
+    CHECK(card_flap_height(1024, card) == card.height - card_flap_hinge(card));
+    CHECK(card_flap_height(256, card) > 40 && card_flap_height(256, card) < 46);  // cos 45 degrees
+    CardPose p0 = {0, 0, 0, CARD_OPA_COVER, 100};
+    CardPose p1 = {0, 0, 0, CARD_OPA_COVER, 300};
+    r = FlapTransition::footprint(p0, p1, card);
+    CHECK(r.y1 == card_flap_hinge(card) - card_flap_height(100, card) && r.y2 == card_flap_hinge(card) - 1);
+    CardPose p2 = {0, 0, 0, CARD_OPA_COVER, 700};
+    r = FlapTransition::footprint(p1, p2, card);
+    CHECK(r.y1 == card_flap_hinge(card) - card_flap_height(300, card));
+    CHECK(r.y2 == card_flap_hinge(card) + card_flap_height(700, card) - 1);
+    CHECK(footprint_covers(p0, p1, FlapTransition::footprint(p0, p1, card)));
+    CHECK(footprint_covers(p1, p2, FlapTransition::footprint(p1, p2, card)));
+    CHECK(footprint_covers(CARD_POSE_REST, p0, FlapTransition::footprint(CARD_POSE_REST, p0, card)));
+}
+
+// Each effect spins through three candidates; the footprints always cover
+// the change, and only the fade has to repaint the whole card every frame
+static void test_timeline()
+{
+    for (int i = 0; i < CARD_TRANSITION_COUNT; i++)
+    {
+        CardTransition transition = (CardTransition)i;
+        FlipTimeline timeline(4, config(transition));
+        Recorder rec;
+        rec.lands_to_settle = 3;
+        timeline.set_listener(&rec);
+        timeline.start(2, 50);
+        rec.pose = timeline.state(2).pose;
+        for (int step = 0; step < 1000 && timeline.active_count(); step++)
+            timeline.advance(10);
+
+        CHECK(timeline.active_count() == 0);
+        CHECK(rec.lands == 3);
+        CHECK(rec.footprints_ok);
+        CHECK(card_pose_equal(timeline.state(2).pose, CARD_POSE_REST));
+        long full = (long)rec.moves * card.width * card.height;
+        if (transition == CARD_TRANSITION_FADE)
+            CHECK(rec.dirty_px == full);
+        else
+            CHECK(rec.dirty_px < full);
+        printf("%-10s %3d moves, %5.1f%% of the card redrawn\n", card_transition_name(transition), rec.moves,
+               full ? 100.0 * rec.dirty_px / full : 0.0);
+    }
+}
+
+int main()
+{
+    test_names();
+    test_poses();
+    test_footprints();
+    test_timeline();
+
+    return test_summary("card transition");
+}
@@ -0,0 +1,29 @@
+// Checks shared by the host tests. CHECK() reports a failed condition and
+// carries on; test_summary() prints the outcome and returns main()'s exit
+// code.
+#pragma once
+
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+    do                                                                         \
+    {                                                                          \
+        if (!(cond))                                                           \
+        {                                                                      \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);    \
+            failures++;                                                        \
+        }                                                                      \
+    } while (0)
+
+static inline int test_summary(const char *name)
+{
+    if (failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all %s tests passed\n", name);
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Unit tests of the display port's damage accumulation
+
+#include "esp_lvgl_port_damage.h"
+#include "test_check.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static lvgl_port_damage_area_t rect(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    return {x, y, x + w - 1, y + h - 1};
+}
+
+static bool contains(const lvgl_port_damage_area_t &outer, const lvgl_port_damage_area_t &inner)
+{
+    return outer.x1 <= inner.x1 && outer.y1 <= inner.y1 && outer.x2 >= inner.x2 && outer.y2 >= inner.y2;
+}
+
+static bool equal(const lvgl_port_damage_area_t &a, const lvgl_port_damage_area_t &b)
+{
+    return a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2;
+}
+
+static uint32_t add(lvgl_port_damage_t *damage, lvgl_port_damage_area_t area, lvgl_port_damage_area_t *out = nullptr)
+{
+    uint32_t merged = lvgl_port_damage_add(damage, &area);
+    if (out)
+        *out = area;
+    return merged;
+}
+
+static void test_separate()
+{
+    lvgl_port_damage_t damage;
+    lvgl_port_damage_init(&damage, 0);
+    lvgl_port_damage_area_t out;
+    CHECK(add(&damage, rect(0, 0, 10, 10), &out) == 0 && equal(out, rect(0, 0, 10, 10)));
+    CHECK(add(&damage, rect(50, 0, 10, 10)) == 0);
+    CHECK(damage.count == 2);
+
+    // Far apart areas stay apart whatever the cost
+    lvgl_port_damage_init(&damage, LVGL_PORT_DAMAGE_AREA_COST_DEFAULT);
+    add(&damage, rect(0, 0, 100, 100));
+    CHECK(add(&damage, rect(500, 500, 100, 100)) == 0 && damage.count == 2);
+}
+
+static void test_overlap()
+{
+    lvgl_port_damage_t damage;
+    lvgl_port_damage_init(&damage, 0);
+    lvgl_port_damage_area_t out;
+
+    // Inside a collected area: covered by it
+    add(&damage, rect(0, 0, 100, 100));
+    CHECK(add(&damage, rect(10, 10, 5, 5), &out) == 1 && equal(out, rect(0, 0, 100, 100)));
+    CHECK(damage.count == 1);
+
+    // Covering collected areas: replaces them
+    add(&damage, rect(200, 0, 10, 10));
+    CHECK(add(&damage, rect(150, 0, 100, 100), &out) == 1 && equal(out, rect(150, 0, 100, 100)));
+    CHECK(damage.count == 2);
+
+    // Edge to edge adds no pixel
+    lvgl_port_damage_clear(&damage);
+    add(&damage, rect(0, 0, 10, 20));
+    CHECK(add(&damage, rect(10, 0, 10, 20), &out) == 1 && equal(out, rect(0, 0, 20, 20)));
+
+    // Diagonal overlap: the bounding box is larger than both, so only a cost merges it
+    lvgl_port_damage_clear(&damage);
+    add(&damage, rect(0, 0, 10, 10));
+    CHECK(add(&damage, rect(5, 5, 10, 10)) == 0 && damage.count == 2);
+    lvgl_port_damage_init(&damage, 50);
+    add(&damage, rect(0, 0, 10, 10));
+    CHECK(add(&damage, rect(5, 5, 10, 10), &out) == 1 && equal(out, rect(0, 0, 15, 15)));
+}
+
+static void test_cost()
+{
+    // Two 90x120 card strips 10 px apart: the gap is 1200 px
+    lvgl_port_damage_t damage;
+    lvgl_port_damage_init(&damage, 1199);
+    add(&damage, rect(0, 0, 90, 120));
+    CHECK(add(&damage, rect(100, 0, 90, 120)) == 0);
+    lvgl_port_damage_init(&damage, 1200);
+    add(&damage, rect(0, 0, 90, 120));
+    CHECK(add(&damage, rect(100, 0, 90, 120)) == 1 && damage.count == 1);
+}
+
+static void test_chain()
+{
+    // The middle area bridges the gap between the outer ones
+    lvgl_port_damage_t damage;
+    lvgl_port_damage_init(&damage, 100);
+    lvgl_port_damage_area_t out;
+    add(&damage, rect(0, 0, 20, 20));
+    add(&damage, rect(60, 0, 20, 20));
+    CHECK(damage.count == 2);
+    CHECK(add(&damage, rect(22, 0, 36, 20), &out) == 2 && equal(out, rect(0, 0, 80, 20)));
+    CHECK(damage.count == 1);
+}
+
+static void test_board_row()
+{
+    // A row of 12 falling cards on a 1280 px wide board, each invalidating
+    // its own strip, becomes one band with the default cost
+    lvgl_port_damage_t damage;
+    lvgl_port_damage_init(&damage, LVGL_PORT_DAMAGE_AREA_COST_DEFAULT);
+    uint32_t merged = 0;
+    for (int card = 0; card < 12; card++)
+        merged += add(&damage, rect(20 + card * 104, 200, 96, 130));
+    CHECK(damage.count == 1 && merged == 11);
+    CHECK(equal(damage.areas[0], rect(20, 200, 11 * 104 + 96, 130)));
+
+    // Two rows far apart stay two bands
+    for (int card = 0; card < 12; card++)
+        add(&damage, rect(20 + card * 104, 500, 96, 130));
+    CHECK(damage.count == 2);
+}
+
+static void test_full()
+{
+    // More disjoint areas than slots: each extra one goes into its closest
+    lvgl_port_damage_t damage;
+    lvgl_port_damage_init(&damage, 0);
+    for (int i = 0; i < LVGL_PORT_DAMAGE_MAX_AREAS; i++)
+        add(&damage, rect(i * 20, 0, 10, 10));
+    CHECK(damage.count == LVGL_PORT_DAMAGE_MAX_AREAS);
+    lvgl_port_damage_area_t out;
+    CHECK(add(&damage, rect(0, 12, 10, 10), &out) == 1 && equal(out, rect(0, 0, 10, 22)));
+    CHECK(damage.count == LVGL_PORT_DAMAGE_MAX_AREAS);
+}
+
+static void test_random()
+{
+    // Every added area stays covered, collected areas never nest, the slots never overflow
+    srand(1);
+    for (int round = 0; round < 200; round++)
+    {
+        lvgl_port_damage_t damage;
+        lvgl_port_damage_init(&damage, (uint32_t)(rand() % 3) * 2000);
+        std::vector<lvgl_port_damage_area_t> added;
+        for (int i = 0; i < 40; i++)
+        {
+            lvgl_port_damage_area_t area = rect(rand() % 1200, rand() % 700, 1 + rand() % 150, 1 + rand() % 150);
+            added.push_back(area);
+            lvgl_port_damage_area_t out;
+            add(&damage, area, &out);
+            CHECK(contains(out, area));
+            CHECK(damage.count <= LVGL_PORT_DAMAGE_MAX_AREAS);
+        }
+        for (const lvgl_port_damage_area_t &area : added)
+        {
+            bool covered = false;
+            for (uint32_t i = 0; i < damage.count; i++)
+                covered = covered || contains(damage.areas[i], area);
+            CHECK(covered);
+        }
+        for (uint32_t i = 0; i < damage.count; i++)
+        {
+            for (uint32_t j = 0; j < damage.count; j++)
+                CHECK(i == j || !contains(damage.areas[i], damage.areas[j]));
+        }
+    }
+}
+
+int main()
+{
+    test_separate();
+    test_overlap();
+    test_cost();
+    test_chain();
+    test_board_row();
+    test_full();
+    test_random();
+    return test_summary("damage merge");
+}
@@ -0,0 +1,307 @@
+// Unit tests of the emoji atlas: packed images come back in place with the
+// right pixels, the alpha blit stays within 2 steps of an exact blend and
+// inside its target, malformed atlases do not load, and the tile cache bakes
+// emoji the atlas has into their tiles once.
+
+#include "emoji_atlas.hpp"
+#include "emoji_atlas_writer.hpp"
+#include "board_widget.hpp"
+#include "glyph_tile_cache.hpp"
+#include "grid_board.hpp"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "test_check.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define EMOJI_SIZE 32
+#define RED565 0xF800
+#define BLUE565 0x001F
+
+static EmojiAtlasInput solid(uint32_t codepoint, int width, int height, uint8_t r, uint8_t g, uint8_t b)
+{
+    EmojiAtlasInput image = {codepoint, width, height, {}};
+    for (int i = 0; i < width * height; i++)
+        image.rgba.insert(image.rgba.end(), {r, g, b, 255});
+    return image;
+}
+
+// Given out of order, the atlas sorts them
+static std::vector<EmojiAtlasInput> test_emoji()
+{
+    std::vector<EmojiAtlasInput> emoji;
+    emoji.push_back(solid(0x2764, 32, 32, 255, 0, 0));  // fills the image
+    emoji.push_back(solid(0x1F680, 16, 8, 0, 0, 255));  // small, centered and not scaled up
+
+    // Left half opaque green, right half transparent, scaled down by 2
+    EmojiAtlasInput half = {0x1F600, 64, 64, std::vector<uint8_t>(64 * 64 * 4, 0)};
+    for (int y = 0; y < 64; y++)
+        for (int x = 0; x < 32; x++)
+            memcpy(&half.rgba[(y * 64 + x) * 4], "\x00\xFF\x00\xFF", 4);
+    emoji.push_back(half);
+
+    // White and transparent checkerboard: half covered, still white
+    EmojiAtlasInput checker = {0x1F60A, 64, 64, std::vector<uint8_t>(64 * 64 * 4, 0)};
+    for (int y = 0; y < 64; y++)
+        for (int x = (y & 1); x < 64; x += 2)
+            memcpy(&checker.rgba[(y * 64 + x) * 4], "\xFF\xFF\xFF\xFF", 4);
+    emoji.push_back(checker);
+    return emoji;
+}
+
+static uint16_t color_at(const lv_image_dsc_t *image, int x, int y)
+{
+    return ((const uint16_t *)image->data)[y * image->header.w + x];
+}
+
+static uint8_t alpha_at(const lv_image_dsc_t *image, int x, int y)
+{
+    return image->data[image->header.w * image->header.h * 2 + y * image->header.w + x];
+}
+
+static void test_pack_and_find(const std::vector<uint8_t> &data)
+{
+    EmojiAtlas atlas;
+    CHECK(atlas.open(data.data(), data.size()));
+    CHECK(atlas.count() == 4 && atlas.width() == EMOJI_SIZE && atlas.height() == EMOJI_SIZE);
+    CHECK(atlas.size() == data.size());
+    CHECK(!atlas.find(0x1F601) && !atlas.find(0) && !atlas.find('A'));
+
+    const lv_image_dsc_t *heart = atlas.find(0x2764);
+    const lv_image_dsc_t *rocket = atlas.find(0x1F680);
+    const lv_image_dsc_t *half = atlas.find(0x1F600);
+    const lv_image_dsc_t *checker = atlas.find(0x1F60A);
+    CHECK(heart && rocket && half && checker);
+    if (!heart || !rocket || !half || !checker)
+        return;
+
+    // Used in place: the pixels are the atlas' bytes, not a copy
+    CHECK(heart->data > data.data() && heart->data + heart->data_size <= data.data() + data.size());
+    CHECK(heart->header.cf == LV_COLOR_FORMAT_RGB565A8 && heart->header.w == EMOJI_SIZE);
+    CHECK(heart->data_size == emoji_atlas_image_bytes(EMOJI_SIZE, EMOJI_SIZE));
+
+    CHECK(color_at(heart, 0, 0) == RED565 && alpha_at(heart, 0, 0) == 255);
+    CHECK(color_at(heart, 31, 31) == RED565 && alpha_at(heart, 31, 31) == 255);
+
+    // 16x8 in the middle of 32x32: columns 8..23, rows 12..19
+    CHECK(alpha_at(rocket, 7, 15) == 0 && alpha_at(rocket, 8, 15) == 255 && alpha_at(rocket, 23, 15) == 255);
+    CHECK(alpha_at(rocket, 24, 15) == 0 && alpha_at(rocket, 15, 11) == 0 && alpha_at(rocket, 15, 12) == 255);
+    CHECK(alpha_at(rocket, 15, 19) == 255 && alpha_at(rocket, 15, 20) == 0);
+    CHECK(color_at(rocket, 15, 15) == BLUE565);
+
+    CHECK(color_at(half, 15, 10) == 0x07E0 && alpha_at(half, 15, 10) == 255);
+    CHECK(alpha_at(half, 16, 10) == 0);
+
+    // Transparent pixels do not darken what they are averaged with
+    CHECK(color_at(checker, 5, 5) == 0xFFFF);
+    CHECK(abs(alpha_at(checker, 5, 5) - 128) <= 1);
+}
+
+// Exact blend of one RGB565 channel, in that channel's steps
+static int blend_channel(int fg, int bg, int alpha)
+{
+    return (fg * alpha + bg * (255 - alpha) + 127) / 255;
+}
+
+static void test_blit_accuracy()
+{
+    uint8_t pixel[3];
+    lv_image_dsc_t image = {};
+    image.header.magic = LV_IMAGE_HEADER_MAGIC;
+    image.header.cf = LV_COLOR_FORMAT_RGB565A8;
+    image.header.w = 1;
+    image.header.h = 1;
+    image.header.stride = 2;
+    image.data_size = 3;
+    image.data = pixel;
+
+    int worst = 0;
+    uint32_t seed = 12345;
+    for (int round = 0; round < 64; round++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        uint16_t fg = (uint16_t)(seed >> 8);
+        seed = seed * 1103515245u + 12345u;
+        uint16_t bg = (uint16_t)(seed >> 8);
+        memcpy(pixel, &fg, 2);
+        for (int alpha = 0; alpha <= 255; alpha++)
+        {
+            pixel[2] = (uint8_t)alpha;
+            uint16_t out = bg;
+            emoji_atlas_blit(&image, &out, 1, 1, 0, 0);
+            if (alpha == 0)
+                CHECK(out == bg);
+            if (alpha == 255)
+                CHECK(out == fg);
+            int dr = abs((out >> 11) - blend_channel(fg >> 11, bg >> 11, alpha));
+            int dg = abs(((out >> 5) & 0x3F) - blend_channel((fg >> 5) & 0x3F, (bg >> 5) & 0x3F, alpha));
+            int db = abs((out & 0x1F) - blend_channel(fg & 0x1F, bg & 0x1F, alpha));
+            worst = LV_MAX(worst, LV_MAX(dr, LV_MAX(dg, db)));
+        }
+    }
+    CHECK(worst <= 2);
+    printf("blit: at most %d step(s) off an exact blend\n", worst);
+}
+
+// Only the part of the image inside the target is written
+static void test_blit_clipping(const EmojiAtlas &atlas)
+{
+    const lv_image_dsc_t *heart = atlas.find(0x2764);
+    if (!heart)
+        return;
+
+    const int width = 40, height = 24, guard = 64;
+    static const struct
+    {
+        int x, y;
+    } places[] = {{-5, -7}, {20, 10}, {4, -31}, {39, 23}, {40, 0}, {-32, 0}, {4, 4}};
+    for (const auto &place : places)
+    {
+        std::vector<uint16_t> buffer(width * height + 2 * guard, 0x1234);
+        uint16_t *dst = buffer.data() + guard;
+        emoji_atlas_blit(heart, dst, width, height, place.x, place.y);
+        int wrong = 0;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                bool inside = x >= place.x && x < place.x + EMOJI_SIZE && y >= place.y && y < place.y + EMOJI_SIZE;
+                wrong += dst[y * width + x] != (inside ? RED565 : 0x1234);
+            }
+        }
+        for (int i = 0; i < guard; i++)
+            wrong += buffer[i] != 0x1234 || buffer[guard + width * height + i] != 0x1234;
+        CHECK(wrong == 0);
+    }
+}
+
+// Header, table and offsets are checked before anything reads the pixels
+static void test_malformed(const std::vector<uint8_t> &good)
+{
+    EmojiAtlas atlas;
+    CHECK(!atlas.open(good.data(), sizeof(EmojiAtlasHeader) - 1));
+    CHECK(!atlas.open(good.data(), good.size() - 1));  // truncated
+
+    std::vector<uint8_t> bad = good;
+    bad[0] ^= 0xFF;  // magic
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    EmojiAtlasHeader header;
+    memcpy(&header, good.data(), sizeof(header));
+    EmojiAtlasHeader changed = header;
+    changed.width = 0;
+    bad = good;
+    memcpy(bad.data(), &changed, sizeof(changed));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+    changed = header;
+    changed.count = 60000;  // table runs past the atlas
+    memcpy(bad.data(), &changed, sizeof(changed));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    const size_t table_at = sizeof(EmojiAtlasHeader);
+    EmojiAtlasEntry first, second;
+    memcpy(&first, good.data() + table_at, sizeof(first));
+    memcpy(&second, good.data() + table_at + sizeof(first), sizeof(second));
+
+    // Out of order, so find() could not search it
+    bad = good;
+    memcpy(bad.data() + table_at, &second, sizeof(second));
+    memcpy(bad.data() + table_at + sizeof(second), &first, sizeof(first));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    // Images off their alignment, over the table or past the end
+    const uint32_t offsets[] = {first.offset + 2, (uint32_t)table_at, (uint32_t)good.size() - 8};
+    for (uint32_t offset : offsets)
+    {
+        bad = good;
+        EmojiAtlasEntry moved = first;
+        moved.offset = offset;
+        memcpy(bad.data() + table_at, &moved, sizeof(moved));
+        CHECK(!atlas.open(bad.data(), bad.size()));
+    }
+
+    // After all that, the good one still opens
+    CHECK(atlas.open(good.data(), good.size()));
+
+    std::vector<uint8_t> out;
+    std::string error;
+    CHECK(!emoji_atlas_pack({}, EMOJI_SIZE, &out, &error));
+    CHECK(!emoji_atlas_pack({solid(0x2764, 4, 4, 0, 0, 0)}, 0, &out, &error));
+    CHECK(!emoji_atlas_pack({solid(0x2764, 4, 4, 0, 0, 0)}, EMOJI_ATLAS_MAX_SIZE + 1, &out, &error));
+    CHECK(!emoji_atlas_pack({solid(0x2764, 4, 4, 0, 0, 0), solid(0x2764, 8, 8, 0, 0, 0)}, EMOJI_SIZE, &out,
+                            &error) && !error.empty());
+    EmojiAtlasInput short_rgba = solid(0x2764, 4, 4, 0, 0, 0);
+    short_rgba.rgba.pop_back();
+    CHECK(!emoji_atlas_pack({short_rgba}, EMOJI_SIZE, &out, &error));
+}
+
+// Emoji the atlas has are blitted into their tile once; the text color does
+// not matter for them, other glyphs are rendered from their font as before
+static void test_tile_cache(const EmojiAtlas &atlas)
+{
+    const int width = 96, height = 126;
+    GlyphTileCache cache(8, width, height, lv_color_hex(BOARD_CARD_BG_COLOR));
+    cache.set_emoji_atlas(&atlas);
+    CHECK(cache.init(lv_screen_active()));
+
+    const lv_image_dsc_t *heart = cache.acquire("\xE2\x9D\xA4", &NotoEmoji64, lv_color_hex(0xFF4444));
+    CHECK(heart != nullptr);
+    if (!heart)
+        return;
+    const uint16_t *px = (const uint16_t *)heart->data;
+    const uint16_t background = lv_color_to_u16(lv_color_hex(BOARD_CARD_BG_COLOR));
+    CHECK(px[(height / 2) * width + width / 2] == RED565);
+    CHECK(px[0] == background && px[width * height - 1] == background);
+    // Centered like the label: the 32 px image starts at ((96 - 32) / 2, (126 - 32) / 2)
+    CHECK(px[47 * width + 32] == RED565 && px[47 * width + 31] == background && px[46 * width + 32] == background);
+    CHECK(cache.get_stats().emoji_blits == 1);
+
+    const lv_image_dsc_t *white_heart = cache.acquire("\xE2\x9D\xA4\xEF\xB8\x8F", &NotoEmoji64, lv_color_white());
+    CHECK(white_heart == heart);
+    CHECK(cache.get_stats().hits == 1 && cache.get_stats().emoji_blits == 1);
+
+    const lv_image_dsc_t *letter = cache.acquire("A", &ShareTech140, lv_color_white());
+    CHECK(letter != nullptr && letter != heart);
+    CHECK(cache.get_stats().emoji_blits == 1);
+    bool drawn = false;
+    for (int i = 0; letter && i < width * height; i++)
+        drawn |= ((const uint16_t *)letter->data)[i] != background;
+    CHECK(drawn);
+
+    cache.release(heart);
+    cache.release(white_heart);
+    cache.release(letter);
+}
+
+int main()
+{
+    esp_log_host_level = 0;
+    lv_init();
+    static uint16_t frame[64 * 64];
+    lv_display_t *disp = lv_display_create(64, 64);
+    lv_display_set_buffers(disp, frame, nullptr, sizeof(frame), LV_DISPLAY_RENDER_MODE_DIRECT);
+
+    std::vector<uint8_t> data;
+    std::string error;
+    bool packed = emoji_atlas_pack(test_emoji(), EMOJI_SIZE, &data, &error);
+    CHECK(packed);
+    if (!packed)
+        printf("pack: %s\n", error.c_str());
+
+    test_blit_accuracy();
+    if (packed)
+    {
+        test_pack_and_find(data);
+        test_malformed(data);
+        EmojiAtlas atlas;
+        CHECK(atlas.open(data.data(), data.size()));
+        test_blit_clipping(atlas);
+        test_tile_cache(atlas);
+    }
+
+    lv_display_delete(disp);
+    lv_deinit();
+    return test_summary("emoji atlas");
+}
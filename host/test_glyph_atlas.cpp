@@ -0,0 +1,253 @@
+// Unit tests of the glyph atlas: the built-in fonts packed into an atlas and
+// used from it have to give the same glyphs, kerning and rendered pixels as
+// the fonts compiled in from C, and malformed atlases must not load.
+
+#include "glyph_atlas.hpp"
+#include "glyph_atlas_writer.hpp"
+#include "grid_board.hpp"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "test_check.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define SCREEN_WIDTH 480
+#define SCREEN_HEIGHT 160
+
+static uint16_t frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *, uint8_t *)
+{
+    lv_display_flush_ready(disp);
+}
+
+static std::vector<uint8_t> pack_builtin()
+{
+    std::vector<uint8_t> atlas;
+    std::string error;
+    bool packed = glyph_atlas_pack({{GLYPH_ATLAS_FONT_TEXT, &ShareTech140}, {GLYPH_ATLAS_FONT_EMOJI, &NotoEmoji64}},
+                                   &atlas, &error);
+    CHECK(packed);
+    if (!packed)
+        printf("pack: %s\n", error.c_str());
+    return atlas;
+}
+
+// Every codepoint a font maps
+static std::vector<uint32_t> codepoints(const lv_font_t *font)
+{
+    std::vector<uint32_t> list;
+    const lv_font_fmt_txt_dsc_t *dsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+    for (int i = 0; i < dsc->cmap_num; i++)
+    {
+        const lv_font_fmt_txt_cmap_t &c = dsc->cmaps[i];
+        if (c.unicode_list)
+        {
+            for (int k = 0; k < c.list_length; k++)
+                list.push_back(c.range_start + c.unicode_list[k]);
+        }
+        else
+        {
+            for (int k = 0; k < c.range_length; k++)
+                list.push_back(c.range_start + k);
+        }
+    }
+    return list;
+}
+
+static bool same_bitmap(lv_font_glyph_dsc_t *a, lv_font_glyph_dsc_t *b)
+{
+    if (a->box_w == 0 || a->box_h == 0)
+        return true;
+    lv_draw_buf_t *buf_a = lv_draw_buf_create(a->box_w, a->box_h, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+    lv_draw_buf_t *buf_b = lv_draw_buf_create(b->box_w, b->box_h, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+    bool same = buf_a && buf_b && lv_font_get_glyph_bitmap(a, buf_a) && lv_font_get_glyph_bitmap(b, buf_b) &&
+                memcmp(buf_a->data, buf_b->data, (size_t)buf_a->header.stride * a->box_h) == 0;
+    lv_draw_buf_destroy(buf_a);
+    lv_draw_buf_destroy(buf_b);
+    return same;
+}
+
+// Metrics and bitmap of every glyph, and the kerning between text glyphs
+static void compare_glyphs(const lv_font_t *builtin, const lv_font_t *packed, bool kerning)
+{
+    CHECK(packed->line_height == builtin->line_height && packed->base_line == builtin->base_line);
+    std::vector<uint32_t> letters = codepoints(builtin);
+    int mismatches = 0;
+    for (uint32_t letter : letters)
+    {
+        lv_font_glyph_dsc_t a, b;
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        bool found_a = lv_font_get_glyph_dsc(builtin, &a, letter, 0);
+        bool found_b = lv_font_get_glyph_dsc(packed, &b, letter, 0);
+        if (found_a != found_b || a.adv_w != b.adv_w || a.box_w != b.box_w || a.box_h != b.box_h ||
+            a.ofs_x != b.ofs_x || a.ofs_y != b.ofs_y || !same_bitmap(&a, &b))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+    CHECK(!letters.empty());
+
+    // Not in the font: neither has it
+    lv_font_glyph_dsc_t none;
+    CHECK(!packed->get_glyph_dsc(packed, &none, 0x4E00, 0));
+
+    if (!kerning)
+        return;
+    int kerned = 0;
+    for (uint32_t left = 'A'; left <= 'Z'; left++)
+    {
+        for (uint32_t right = 'A'; right <= 'Z'; right++)
+        {
+            lv_font_glyph_dsc_t a, b;
+            lv_font_get_glyph_dsc(builtin, &a, left, right);
+            lv_font_get_glyph_dsc(packed, &b, left, right);
+            CHECK(a.adv_w == b.adv_w);
+            lv_font_glyph_dsc_t plain;
+            lv_font_get_glyph_dsc(builtin, &plain, left, 0);
+            kerned += a.adv_w != plain.adv_w;
+        }
+    }
+    CHECK(kerned > 0);  // "AV" and friends are kerned, so the table was used
+}
+
+// Renders text with a font and returns the frame
+static std::vector<uint16_t> render(lv_display_t *disp, lv_obj_t *label, const lv_font_t *font, const char *text)
+{
+    lv_obj_set_style_text_font(label, font, 0);
+    lv_label_set_text(label, text);
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(disp);
+    return std::vector<uint16_t>(frame, frame + SCREEN_WIDTH * SCREEN_HEIGHT);
+}
+
+static void test_rendering(const GlyphAtlas &atlas, lv_display_t *disp)
+{
+    lv_obj_t *label = lv_label_create(lv_screen_active());
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_obj_set_pos(label, 4, 4);
+    lv_obj_set_style_bg_color(lv_screen_active(), lv_color_black(), 0);
+
+    static const struct
+    {
+        const lv_font_t *builtin;
+        const char *name;
+        const char *text;
+    } cases[] = {
+        {&ShareTech140, GLYPH_ATLAS_FONT_TEXT, "AVA"},
+        {&ShareTech140, GLYPH_ATLAS_FONT_TEXT, "T\xC3\xB6 \xE2\x82\xAC"},  // To, euro sign
+        {&ShareTech140, GLYPH_ATLAS_FONT_TEXT, "12:45"},
+        {&NotoEmoji64, GLYPH_ATLAS_FONT_EMOJI, "\xF0\x9F\x98\x8A\xE2\x9D\xA4\xE2\x9C\x85\xF0\x9F\x9A\x80"},
+    };
+    for (const auto &c : cases)
+    {
+        std::vector<uint16_t> expected = render(disp, label, c.builtin, c.text);
+        std::vector<uint16_t> actual = render(disp, label, atlas.font(c.name), c.text);
+        bool drawn = false;
+        for (uint16_t px : expected)
+            drawn |= px != expected[0];
+        CHECK(drawn);
+        CHECK(actual == expected);
+    }
+    lv_obj_delete(label);
+}
+
+static void test_packed_fonts(const std::vector<uint8_t> &data, lv_display_t *disp)
+{
+    GlyphAtlas atlas;
+    CHECK(atlas.open(data.data(), data.size()));
+    CHECK(atlas.font_count() == 2);
+    CHECK(atlas.size() == data.size());
+    const lv_font_t *text = atlas.font(GLYPH_ATLAS_FONT_TEXT);
+    const lv_font_t *emoji = atlas.font(GLYPH_ATLAS_FONT_EMOJI);
+    CHECK(text && emoji && !atlas.font("symbols"));
+    if (!text || !emoji)
+        return;
+
+    // Used in place: the bitmaps are the atlas' bytes, not a copy
+    const uint8_t *bitmaps = ((const lv_font_fmt_txt_dsc_t *)text->dsc)->glyph_bitmap;
+    CHECK(bitmaps > data.data() && bitmaps < data.data() + data.size());
+
+    compare_glyphs(&ShareTech140, text, true);
+    compare_glyphs(&NotoEmoji64, emoji, false);
+    test_rendering(atlas, disp);
+}
+
+// Header, offsets and tables are checked before LVGL may read them
+static void test_malformed(const std::vector<uint8_t> &good)
+{
+    GlyphAtlas atlas;
+    CHECK(!atlas.open(good.data(), sizeof(GlyphAtlasHeader) - 1));
+    CHECK(!atlas.open(good.data(), good.size() - 1));  // truncated
+
+    std::vector<uint8_t> bad = good;
+    bad[0] ^= 0xFF;  // magic
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    GlyphAtlasFont font;
+    const size_t font_at = sizeof(GlyphAtlasHeader);
+    memcpy(&font, good.data() + font_at, sizeof(font));
+
+    // A glyph whose bitmap runs past the bitmaps ("!", the space has none)
+    bad = good;
+    GlyphAtlasGlyph glyph;
+    const size_t glyph_at = font.glyphs + 2 * sizeof(glyph);
+    memcpy(&glyph, bad.data() + glyph_at, sizeof(glyph));
+    CHECK(glyph.box_w > 0 && glyph.box_h > 0);
+    glyph.bitmap_index = font.bitmap_size - 1;
+    memcpy(bad.data() + glyph_at, &glyph, sizeof(glyph));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    // A character map producing glyph ids the font does not have
+    bad = good;
+    GlyphAtlasFont fewer = font;
+    fewer.glyph_count = 10;
+    memcpy(bad.data() + font_at, &fewer, sizeof(fewer));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    // A table off its alignment or outside the atlas
+    bad = good;
+    GlyphAtlasFont moved = font;
+    moved.cmaps += 2;
+    memcpy(bad.data() + font_at, &moved, sizeof(moved));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+    moved = font;
+    moved.kern_table = (uint32_t)good.size();
+    memcpy(bad.data() + font_at, &moved, sizeof(moved));
+    CHECK(!atlas.open(bad.data(), bad.size()));
+
+    // After all that, the good one still opens
+    CHECK(atlas.open(good.data(), good.size()));
+
+    // Compressed fonts are not packed
+    lv_font_fmt_txt_dsc_t compressed = *(const lv_font_fmt_txt_dsc_t *)ShareTech140.dsc;
+    compressed.bitmap_format = LV_FONT_FMT_TXT_COMPRESSED;
+    lv_font_t font_copy = ShareTech140;
+    font_copy.dsc = &compressed;
+    std::vector<uint8_t> out;
+    std::string error;
+    CHECK(!glyph_atlas_pack({{"text", &font_copy}}, &out, &error) && !error.empty());
+    CHECK(!glyph_atlas_pack({{"a_name_that_is_too_long", &ShareTech140}}, &out, &error));
+}
+
+int main()
+{
+    esp_log_host_level = 0;
+    lv_init();
+    lv_display_t *disp = lv_display_create(SCREEN_WIDTH, SCREEN_HEIGHT);
+    lv_display_set_buffers(disp, frame, nullptr, sizeof(frame), LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_cb);
+
+    std::vector<uint8_t> atlas = pack_builtin();
+    if (!atlas.empty())
+    {
+        test_packed_fonts(atlas, disp);
+        test_malformed(atlas);
+    }
+    printf("atlas of the built-in fonts: %u bytes\n", (unsigned)atlas.size());
+
+    lv_display_delete(disp);
+    lv_deinit();
+    return test_summary("glyph atlas");
+}
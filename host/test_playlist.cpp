@@ -0,0 +1,221 @@
+// Unit tests of the playlist: parsing, compiled layouts, scheduling and the
+// compiled cache. The board runs headless; nothing is rendered.
+
+#include "playlist.hpp"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "test_check.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+static const char *source =
+    "# morning and evening specials\n"
+    "HOME SWEET HOME \xE2\x9D\xA4\n"
+    "10s | NEXT TRAIN 12:45\n"
+    "20s p2 07:00-09:00 | GOOD MORNING \xF0\x9F\x98\x8A\n"
+    "p1 22:00-02:00 5s | GOOD NIGHT\n"
+    "\n"
+    "bogus | NOT SHOWN\n"
+    "p12 | NOT SHOWN EITHER\n"
+    "5s |   \n"
+    "| NEWS TICKER: THIS LINE IS FAR TOO LONG FOR ANY BOARD AND HAS TO SCROLL THROUGH IT INSTEAD\r\n";
+
+static GridBoard *new_board()
+{
+    GridBoard *board = new GridBoard();
+    board->set_random_seed(1);
+    board->initialize(lv_screen_active());
+    return board;
+}
+
+static void test_parse()
+{
+    Playlist playlist;
+    CHECK(playlist.compile(source, GRID_LAYOUT_12X5));
+    CHECK(playlist.size() == 5);
+    if (playlist.size() != 5)
+        return;
+
+    const PlaylistEntry &home = playlist.entry(0);
+    CHECK(home.duration_s == PLAYLIST_DEFAULT_DURATION_S && home.priority == 0 && home.window_start == -1);
+    CHECK(playlist.text(home) == "HOME SWEET HOME \xE2\x9D\xA4");
+    CHECK(home.cell_count == 14);  // the space is not a cell
+
+    const PlaylistEntry &train = playlist.entry(1);
+    CHECK(train.duration_s == 10 && playlist.text(train) == "NEXT TRAIN 12:45");
+
+    const PlaylistEntry &morning = playlist.entry(2);
+    CHECK(morning.duration_s == 20 && morning.priority == 2);
+    CHECK(morning.window_start == 7 * 60 && morning.window_end == 9 * 60);
+
+    const PlaylistEntry &night = playlist.entry(3);
+    CHECK(night.duration_s == 5 && night.priority == 1);
+    CHECK(night.window_start == 22 * 60 && night.window_end == 2 * 60);
+
+    const PlaylistEntry &ticker = playlist.entry(4);
+    CHECK(ticker.flags & PLAYLIST_ENTRY_SCROLL);
+    CHECK(ticker.cell_count <= grid_layout_cells(GRID_LAYOUT_12X5));
+    CHECK(playlist.text(ticker).back() == 'D');
+
+    Playlist empty;
+    CHECK(!empty.compile("# nothing\n\n", GRID_LAYOUT_12X5));
+}
+
+// A compiled message must leave the board exactly as the parsed one does
+static void test_compiled_matches_parsed()
+{
+    static const char *messages[] = {
+        "HELLO WORLD",
+        "WELCOME HOME \xF0\x9F\x98\x8A\xE2\x9D\xA4\xE2\x9D\xA4",
+        "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789",
+        "HELLO THERE",
+    };
+    std::string text;
+    for (const char *m : messages)
+        text += std::string("| ") + m + "\n";
+    for (const GridLayout *layout : {&GRID_LAYOUT_12X5, &GRID_LAYOUT_8X3})
+    {
+        TextAlign align = layout == &GRID_LAYOUT_12X5 ? TEXT_ALIGN_CENTER : TEXT_ALIGN_RIGHT;
+        Playlist playlist;
+        CHECK(playlist.compile(text, *layout, align));
+
+        GridBoard *parsed = new GridBoard();
+        parsed->set_layout(*layout);
+        parsed->set_text_align(align);
+        parsed->initialize(lv_screen_active());
+        GridBoard *compiled = new GridBoard();
+        compiled->set_layout(*layout);
+        compiled->initialize(lv_screen_active());
+        for (int i = 0; i < playlist.size(); i++)
+        {
+            int a = parsed->process_text_and_animate(messages[i]);
+            int b = playlist.show(*compiled, i);
+            CHECK(a == b);
+            CHECK(parsed->get_snapshot() == compiled->get_snapshot());
+        }
+        delete parsed;
+        delete compiled;
+    }
+}
+
+static void test_schedule()
+{
+    Playlist playlist;
+    CHECK(playlist.compile(source, GRID_LAYOUT_12X5));
+
+    // No clock: windowed entries never qualify, the rest take turns
+    CHECK(playlist.select(-1) == 0);
+    // 08:00: the morning entry outranks everything
+    CHECK(playlist.select(8 * 60) == 2);
+    // 23:30 and 01:00 are inside the window that wraps past midnight
+    CHECK(playlist.select(23 * 60 + 30) == 3);
+    CHECK(playlist.select(1 * 60) == 3);
+    CHECK(playlist.select(2 * 60) == 0);
+    CHECK(playlist.select(9 * 60) == 0);
+
+    GridBoard *board = new_board();
+    int64_t now = 0;
+    CHECK(playlist.tick(*board, now, 12 * 60));
+    // HOME SWEET HOME, wrapped into two centered rows from row 1
+    CHECK(strcmp(board->get_cell(1, 1), "H") == 0 && strcmp(board->get_cell(2, 3), "H") == 0);
+    // Not before the entry's time is up and the board is idle
+    CHECK(!playlist.tick(*board, now + 1000, 12 * 60));
+    while (board->is_animation_running())
+        board->advance_animations(FLIP_STEP_MS);
+    now += PLAYLIST_DEFAULT_DURATION_S * 1000;
+    CHECK(playlist.tick(*board, now, 12 * 60));
+    CHECK(strcmp(board->get_cell(1, 1), "N") == 0 && strcmp(board->get_cell(2, 3), "1") == 0);  // NEXT TRAIN 12:45
+    // Round robin: train -> ticker -> home
+    while (board->is_animation_running())
+        board->advance_animations(FLIP_STEP_MS);
+    now += 10 * 1000;
+    CHECK(playlist.tick(*board, now, 12 * 60));
+    CHECK(playlist.select(12 * 60) == 0);
+    delete board;
+}
+
+static void test_cache()
+{
+    const char *path = "test_playlist.txt";
+    const char *cache = "test_playlist.bin";
+    remove(cache);
+    FILE *f = fopen(path, "wb");
+    CHECK(f != nullptr);
+    if (!f)
+        return;
+    fputs(source, f);
+    fclose(f);
+
+    Playlist first;
+    CHECK(first.load(path, cache, GRID_LAYOUT_12X5));
+    CHECK(!first.loaded_from_cache());
+
+    Playlist second;
+    CHECK(second.load(path, cache, GRID_LAYOUT_12X5));
+    CHECK(second.loaded_from_cache());
+    CHECK(second.size() == first.size());
+    for (int i = 0; i < first.size() && i < second.size(); i++)
+    {
+        const PlaylistEntry &a = first.entry(i);
+        const PlaylistEntry &b = second.entry(i);
+        CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+        CHECK(memcmp(first.cells(a), second.cells(b), a.cell_count * sizeof(CompiledCell)) == 0);
+        CHECK(first.text(a) == second.text(b));
+    }
+
+    // Another alignment, another layout or an edited playlist compiles again
+    Playlist aligned;
+    CHECK(aligned.load(path, cache, GRID_LAYOUT_12X5, TEXT_ALIGN_LEFT));
+    CHECK(!aligned.loaded_from_cache());
+    CHECK(aligned.size() > 0 && aligned.cells(aligned.entry(0))[0].col == 0);
+    Playlist other;
+    CHECK(other.load(path, cache, GRID_LAYOUT_16X6));
+    CHECK(!other.loaded_from_cache());
+    f = fopen(path, "ab");
+    fputs("ONE MORE\n", f);
+    fclose(f);
+    Playlist edited;
+    CHECK(edited.load(path, cache, GRID_LAYOUT_16X6));
+    CHECK(!edited.loaded_from_cache());
+    CHECK(edited.size() == first.size() + 1);
+
+    // A truncated cache is rejected
+    f = fopen(cache, "r+b");
+    CHECK(f != nullptr);
+    if (f)
+    {
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fclose(f);
+        CHECK(truncate(cache, size / 2) == 0);
+    }
+    Playlist truncated;
+    CHECK(truncated.load(path, cache, GRID_LAYOUT_16X6));
+    CHECK(!truncated.loaded_from_cache());
+    CHECK(truncated.size() == edited.size());
+
+    Playlist missing;
+    CHECK(!missing.load("no_such_playlist.txt", cache, GRID_LAYOUT_12X5));
+    remove(path);
+    remove(cache);
+}
+
+int main()
+{
+    esp_log_host_level = 1;
+    lv_init();
+    static uint16_t buf[64 * 64];
+    lv_display_t *disp = lv_display_create(64, 64);
+    lv_display_set_buffers(disp, buf, nullptr, sizeof(buf), LV_DISPLAY_RENDER_MODE_PARTIAL);
+
+    test_parse();
+    test_compiled_matches_parsed();
+    test_schedule();
+    test_cache();
+
+    lv_display_delete(disp);
+    lv_deinit();
+    return test_summary("playlist");
+}
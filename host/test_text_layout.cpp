@@ -0,0 +1,161 @@
+// Unit tests of the word-wrapping message layout
+
+#include "text_layout.hpp"
+#include "test_check.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// The board as text, one line per row, '.' for an empty cell
+static std::string layout(const char *text, int cols, int rows, TextAlign align = TEXT_ALIGN_CENTER,
+                          TextLayoutResult *result = nullptr)
+{
+    Utf8Cell cells[TEXT_LAYOUT_MAX_CELLS];
+    int16_t positions[TEXT_LAYOUT_MAX_CELLS];
+    int count = utf8_segment(text, strlen(text), cells, TEXT_LAYOUT_MAX_CELLS);
+    TextLayoutResult r = text_layout(cells, count, cols, rows, align, positions);
+    if (result)
+        *result = r;
+
+    std::string board[GRID_MAX_ROWS];
+    for (int row = 0; row < rows; row++)
+        board[row] = std::string(cols, '.');
+    for (int i = 0; i < count; i++)
+    {
+        if (positions[i] == TEXT_LAYOUT_HIDDEN)
+            continue;
+        if (positions[i] < 0 || positions[i] >= cols * rows)
+        {
+            CHECK(!"position off the board");
+            continue;
+        }
+        std::string &line = board[positions[i] / cols];
+        int col = positions[i] % cols;
+        CHECK(line[col] == '.');  // no cell placed twice
+        line[col] = cells[i].len == 1 ? cells[i].text[0] : '#';
+    }
+    std::string out;
+    for (int row = 0; row < rows; row++)
+        out += board[row] + "|";
+    return out;
+}
+
+static void test_single_line()
+{
+    CHECK(layout("HELLO", 12, 1) == "...HELLO....|");
+    CHECK(layout("HELLO", 12, 3) == "............|...HELLO....|............|");
+    CHECK(layout("HELLO", 12, 1, TEXT_ALIGN_LEFT) == "HELLO.......|");
+    CHECK(layout("HELLO", 12, 1, TEXT_ALIGN_RIGHT) == ".......HELLO|");
+    CHECK(layout("HELLO WORLD!", 12, 1) == "HELLO WORLD!|");
+    CHECK(layout("", 4, 1) == "....|");
+}
+
+static void test_word_wrap()
+{
+    // Wraps between words, never inside one, and centers every line
+    TextLayoutResult r;
+    CHECK(layout("HELLO THERE WORLD", 12, 3, TEXT_ALIGN_CENTER, &r) == "HELLO THERE.|...WORLD....|............|");
+    CHECK(r.lines == 2 && r.placed == 16 && !r.overflow);
+    CHECK(layout("THE QUICK BROWN FOX", 8, 4) == "..THE...|.QUICK..|.BROWN..|..FOX...|");
+    CHECK(layout("THE QUICK BROWN FOX", 9, 2) == "THE QUICK|BROWN FOX|");
+    CHECK(layout("AB CD EF", 5, 2, TEXT_ALIGN_LEFT) == "AB CD|EF...|");
+    CHECK(layout("AB CD EF", 5, 2, TEXT_ALIGN_RIGHT) == "AB CD|...EF|");
+
+    // Blanks at a wrap and at the ends of lines take no cells
+    CHECK(layout("AB    CD", 4, 2) == ".AB.|.CD.|");
+    CHECK(layout("AB  ", 4, 1) == ".AB.|");
+    CHECK(layout("  AB", 4, 1) == "  AB|");  // an indent is kept while it fits
+}
+
+static void test_long_words()
+{
+    // A word wider than the board is split, on a row of its own
+    CHECK(layout("ABCDEFGHIJ", 4, 3) == "ABCD|EFGH|.IJ.|");
+    CHECK(layout("X ABCDEFGH Y", 4, 4) == ".X..|ABCD|EFGH|.Y..|");
+    CHECK(layout("ABCDEFGH", 4, 2) == "ABCD|EFGH|");
+    CHECK(layout("  ABCD", 4, 1) == "ABCD|");  // the indent goes when the word needs the room
+}
+
+static void test_breaks()
+{
+    TextLayoutResult r;
+    CHECK(layout("A\nBC", 4, 2) == ".A..|.BC.|");
+    CHECK(layout("A\n\nB", 3, 3, TEXT_ALIGN_CENTER, &r) == ".A.|...|.B.|");
+    CHECK(r.lines == 3 && !r.overflow);
+    CHECK(layout("\nA", 3, 2) == "...|.A.|");
+
+    // Trailing breaks neither move the text nor overflow
+    CHECK(layout("A\n\n\n", 3, 1, TEXT_ALIGN_CENTER, &r) == ".A.|");
+    CHECK(r.lines == 1 && !r.overflow);
+    CHECK(layout("AB\r\nCD", 2, 2) == "AB|CD|");
+    CHECK(layout("A\n  B", 4, 2, TEXT_ALIGN_LEFT) == "A...|  B.|");
+    CHECK(layout("A\tB", 3, 1) == "A\tB|");
+}
+
+static void test_overflow()
+{
+    TextLayoutResult r;
+    CHECK(layout("ONE TWO THREE", 5, 2, TEXT_ALIGN_CENTER, &r) == ".ONE.|.TWO.|");
+    CHECK(r.overflow && r.lines == 2 && r.placed == 6);
+    CHECK(layout("ABCDEFGHIJ", 4, 2, TEXT_ALIGN_CENTER, &r) == "ABCD|EFGH|");
+    CHECK(r.overflow);
+    CHECK(layout("A\nB\nC", 3, 2, TEXT_ALIGN_CENTER, &r) == ".A.|.B.|");
+    CHECK(r.overflow);
+    CHECK(layout("ABCD", 4, 1, TEXT_ALIGN_CENTER, &r) == "ABCD|");
+    CHECK(!r.overflow);
+
+    Utf8Cell cells[2];
+    int16_t positions[2];
+    utf8_segment("AB", 2, cells, 2);
+    r = text_layout(cells, 2, 0, 1, TEXT_ALIGN_CENTER, positions);
+    CHECK(r.overflow && r.placed == 0 && positions[0] == TEXT_LAYOUT_HIDDEN);
+
+    // More rows than any board has are capped
+    r = text_layout(cells, 2, 1, GRID_MAX_ROWS + 5, TEXT_ALIGN_CENTER, positions);
+    CHECK(!r.overflow && r.lines == 2);
+    CHECK(positions[0] == (GRID_MAX_ROWS - 2) / 2 && positions[1] == positions[0] + 1);
+}
+
+static void test_graphemes()
+{
+    // Emoji sequences are one cell and wrap like any letter
+    CHECK(layout("HI \xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7\xE2\x9D\xA4\xEF\xB8\x8F", 4,
+                 2) == ".HI.|.##.|");
+    CHECK(layout("\xE2\x9D\xA4 \xE2\x9D\xA4", 3, 1) == "# #|");
+}
+
+static void test_presets()
+{
+    // Every cell of a full board is placed, on every preset
+    for (const GridLayout *l : {&GRID_LAYOUT_12X5, &GRID_LAYOUT_16X6, &GRID_LAYOUT_8X3, &GRID_LAYOUT_PORTRAIT})
+    {
+        std::string text;
+        for (int row = 0; row < l->rows; row++)
+            text += std::string(l->cols, 'X') + "\n";
+        TextLayoutResult r;
+        std::string board = layout(text.c_str(), l->cols, l->rows, TEXT_ALIGN_CENTER, &r);
+        CHECK(!r.overflow && r.lines == l->rows && r.placed == grid_layout_cells(*l));
+        CHECK(board.find('.') == std::string::npos);
+    }
+}
+
+static void test_align_names()
+{
+    TextAlign align;
+    CHECK(text_align_find("right", &align) && align == TEXT_ALIGN_RIGHT);
+    CHECK(text_align_find(text_align_name(TEXT_ALIGN_LEFT), &align) && align == TEXT_ALIGN_LEFT);
+    CHECK(!text_align_find("justify", &align));
+}
+
+int main()
+{
+    test_single_line();
+    test_word_wrap();
+    test_long_words();
+    test_breaks();
+    test_overflow();
+    test_graphemes();
+    test_presets();
+    test_align_names();
+    return test_summary("text layout");
+}
@@ -0,0 +1,149 @@
+// Unit tests of the UTF-8 cell segmentation used for message parsing
+
+#include "utf8_segment.hpp"
+#include "test_check.h"
+#include <cstdio>
+#include <cstring>
+
+static int segment(const char *text, Utf8Cell *cells, int max_cells, Utf8SegmentStats *stats = nullptr)
+{
+    return utf8_segment(text, strlen(text), cells, max_cells, stats);
+}
+
+static void test_decode()
+{
+    uint32_t cp;
+    CHECK(utf8_decode("A", 1, &cp) == 1 && cp == 'A');
+    CHECK(utf8_decode("\xC3\xA9", 2, &cp) == 2 && cp == 0xE9);
+    CHECK(utf8_decode("\xE2\x9D\xA4", 3, &cp) == 3 && cp == 0x2764);
+    CHECK(utf8_decode("\xF0\x9F\x98\x80", 4, &cp) == 4 && cp == 0x1F600);
+
+    // Truncated, overlong, surrogate, out of range, stray continuation
+    CHECK(utf8_decode("\xF0\x9F\x98", 3, &cp) == 1 && cp == UTF8_INVALID);
+    CHECK(utf8_decode("\xC0\xAF", 2, &cp) == 1 && cp == UTF8_INVALID);
+    CHECK(utf8_decode("\xE0\x80\xAF", 3, &cp) == 1 && cp == UTF8_INVALID);
+    CHECK(utf8_decode("\xED\xA0\x80", 3, &cp) == 1 && cp == UTF8_INVALID);
+    CHECK(utf8_decode("\xF4\x90\x80\x80", 4, &cp) == 1 && cp == UTF8_INVALID);
+    CHECK(utf8_decode("\x80", 1, &cp) == 1 && cp == UTF8_INVALID);
+    CHECK(utf8_decode("\xE2\x28\xA1", 3, &cp) == 1 && cp == UTF8_INVALID);
+}
+
+static void test_ascii()
+{
+    Utf8Cell cells[64];
+    int n = segment("HELLO WORLD, THIS IS LONG", cells, 64);
+    CHECK(n == 25);
+    CHECK(strcmp(cells[0].text, "H") == 0 && cells[0].len == 1);
+    CHECK(strcmp(cells[24].text, "G") == 0);
+    CHECK(cells[5].codepoint == ' ');
+
+    // The fast path must respect max_cells
+    n = segment("ABCDEFGHIJKLMNOP", cells, 10);
+    CHECK(n == 10);
+    CHECK(strcmp(cells[9].text, "J") == 0);
+}
+
+static void test_quotes()
+{
+    Utf8Cell cells[16];
+    int n = segment("\xE2\x80\x98HI\xE2\x80\x99 \xE2\x80\x9CYO\xE2\x80\x9D", cells, 16);
+    CHECK(n == 9);
+    CHECK(strcmp(cells[0].text, "'") == 0);
+    CHECK(strcmp(cells[3].text, "'") == 0);
+    CHECK(strcmp(cells[5].text, "\"") == 0);
+    CHECK(strcmp(cells[8].text, "\"") == 0);
+}
+
+static void test_emoji_sequences()
+{
+    Utf8Cell cells[16];
+    Utf8SegmentStats stats = {};
+
+    // Heart with VS16 is one cell showing the plain heart
+    int n = segment("A\xE2\x9D\xA4\xEF\xB8\x8F" "B", cells, 16, &stats);
+    CHECK(n == 3);
+    CHECK(strcmp(cells[1].text, "\xE2\x9D\xA4") == 0);
+    CHECK(cells[1].codepoint == 0x2764);
+    CHECK(stats.folded == 1);
+
+    // Family: man ZWJ woman ZWJ girl
+    n = segment("\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7!", cells, 16);
+    CHECK(n == 2);
+    CHECK(cells[0].codepoint == 0x1F468);
+    CHECK(strcmp(cells[1].text, "!") == 0);
+
+    // Thumbs up with skin tone
+    n = segment("\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD", cells, 16);
+    CHECK(n == 1 && cells[0].codepoint == 0x1F44D);
+
+    // Two flags are two cells
+    n = segment("\xF0\x9F\x87\xBA\xF0\x9F\x87\xB8\xF0\x9F\x87\xA9\xF0\x9F\x87\xAA", cells, 16);
+    CHECK(n == 2);
+    CHECK(cells[0].codepoint == 0x1F1FA && cells[1].codepoint == 0x1F1E9);
+
+    // Keycap 1
+    n = segment("1\xEF\xB8\x8F\xE2\x83\xA3", cells, 16);
+    CHECK(n == 1 && strcmp(cells[0].text, "1") == 0);
+
+    // A selector with nothing before it is dropped
+    n = segment("\xEF\xB8\x8FX", cells, 16);
+    CHECK(n == 1 && strcmp(cells[0].text, "X") == 0);
+}
+
+static void test_invalid()
+{
+    Utf8Cell cells[16];
+    Utf8SegmentStats stats = {};
+
+    // Bad bytes are skipped, the text around them survives
+    int n = segment("A\xFF" "B\xC3", cells, 16, &stats);
+    CHECK(n == 2);
+    CHECK(strcmp(cells[0].text, "A") == 0 && strcmp(cells[1].text, "B") == 0);
+    CHECK(stats.invalid_bytes == 2);
+
+    // Truncated emoji at the end of a BLE write
+    stats = {};
+    n = segment("HI\xF0\x9F\x98", cells, 16, &stats);
+    CHECK(n == 2);
+    CHECK(stats.invalid_bytes == 3);
+}
+
+// Streaming one cell at a time gives the same cells as one pass
+static void test_stream()
+{
+    const char *text = "A\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9 \xE2\x9D\xA4\xEF\xB8\x8F"
+                       "\xF0\x9F\x87\xBA\xF0\x9F\x87\xB8\xE2\x80\x9CHI\xE2\x80\x9D";
+    size_t len = strlen(text);
+    Utf8Cell whole[32];
+    int n = utf8_segment(text, len, whole, 32);
+    CHECK(n == 9);
+
+    Utf8Cell cell;
+    size_t pos = 0;
+    int count = 0;
+    while (pos < len)
+    {
+        size_t used = 0;
+        int got = utf8_segment_next(text + pos, len - pos, &cell, 1, &used);
+        CHECK(used > 0);
+        if (got == 0 || used == 0)
+            break;
+        CHECK(count < n && strcmp(cell.text, whole[count].text) == 0);
+        count++;
+        pos += used;
+    }
+    CHECK(count == n);
+    CHECK(pos == len);
+}
+
+int main()
+{
+    test_decode();
+    test_ascii();
+    test_quotes();
+    test_emoji_sequences();
+    test_invalid();
+    test_stream();
+
+    return test_summary("utf8_segment");
+}
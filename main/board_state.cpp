@@ -0,0 +1,138 @@
+#include "board_state.hpp"
+#include "esp_log.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <cstring>
+
+static const char *TAG = "BOARD_STATE";
+
+#define BOARD_STATE_NAMESPACE "grid_board"
+#define BOARD_STATE_KEY "state"
+
+typedef struct
+{
+    BoardStateHeader header;
+    char text[BOARD_STATE_MAX_TEXT];
+} BoardStateBlob;
+
+static QueueHandle_t save_queue = nullptr;
+
+static size_t blob_size(const BoardStateBlob &blob)
+{
+    return sizeof(blob.header) + blob.header.len;
+}
+
+static bool matches(const BoardStateHeader &h, const GridLayout &layout)
+{
+    return h.version == BOARD_STATE_VERSION && h.cols == layout.cols && h.rows == layout.rows &&
+           h.slot_width == layout.slot_width && h.slot_height == layout.slot_height;
+}
+
+bool board_state_load(const GridLayout &layout, std::string *cells)
+{
+    nvs_handle_t handle;
+    if (nvs_open(BOARD_STATE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+        return false;
+
+    static BoardStateBlob blob;
+    size_t size = sizeof(blob);
+    esp_err_t ret = nvs_get_blob(handle, BOARD_STATE_KEY, &blob, &size);
+    nvs_close(handle);
+    if (ret != ESP_OK)
+    {
+        if (ret != ESP_ERR_NVS_NOT_FOUND)
+        {
+            ESP_LOGW(TAG, "Stored board unreadable: %s", esp_err_to_name(ret));
+        }
+        return false;
+    }
+    if (size < sizeof(blob.header) || size != blob_size(blob) || blob.header.len > BOARD_STATE_MAX_TEXT)
+    {
+        ESP_LOGW(TAG, "Stored board is corrupt (%u bytes)", (unsigned)size);
+        return false;
+    }
+    if (!matches(blob.header, layout))
+    {
+        ESP_LOGI(TAG, "Stored board is for a %dx%d layout, not restoring", blob.header.cols, blob.header.rows);
+        return false;
+    }
+
+    cells->assign(blob.text, blob.header.len);
+    return true;
+}
+
+static void save_task(void *arg)
+{
+    static BoardStateBlob pending;
+    static BoardStateBlob stored;
+    size_t stored_size = 0;
+
+    while (1)
+    {
+        if (xQueueReceive(save_queue, &pending, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        size_t size = blob_size(pending);
+        if (size == stored_size && memcmp(&pending, &stored, size) == 0)
+            continue;
+
+        nvs_handle_t handle;
+        esp_err_t ret = nvs_open(BOARD_STATE_NAMESPACE, NVS_READWRITE, &handle);
+        if (ret == ESP_OK)
+        {
+            // Skip the write if flash already holds this board, e.g. after a reboot
+            size_t flash_size = sizeof(stored);
+            if (stored_size == 0 && nvs_get_blob(handle, BOARD_STATE_KEY, &stored, &flash_size) == ESP_OK &&
+                flash_size == size && memcmp(&pending, &stored, size) == 0)
+            {
+                stored_size = size;
+                nvs_close(handle);
+                continue;
+            }
+
+            ret = nvs_set_blob(handle, BOARD_STATE_KEY, &pending, size);
+            if (ret == ESP_OK)
+            {
+                ret = nvs_commit(handle);
+            }
+            nvs_close(handle);
+        }
+        if (ret != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Saving board failed: %s", esp_err_to_name(ret));
+            continue;
+        }
+        memcpy(&stored, &pending, size);
+        stored_size = size;
+        ESP_LOGD(TAG, "Board saved, %u bytes", (unsigned)size);
+    }
+}
+
+void board_state_save(const GridLayout &layout, const std::string &cells)
+{
+    if (cells.size() > BOARD_STATE_MAX_TEXT)
+        return;
+
+    if (!save_queue)
+    {
+        save_queue = xQueueCreate(1, sizeof(BoardStateBlob));
+        if (!save_queue || xTaskCreate(save_task, "board_state", 3072, nullptr, 1, nullptr) != pdPASS)
+        {
+            ESP_LOGE(TAG, "Cannot start board state task");
+            return;
+        }
+    }
+
+    static BoardStateBlob blob;
+    memset(&blob.header, 0, sizeof(blob.header));
+    blob.header.version = BOARD_STATE_VERSION;
+    blob.header.cols = layout.cols;
+    blob.header.rows = layout.rows;
+    blob.header.slot_width = layout.slot_width;
+    blob.header.slot_height = layout.slot_height;
+    blob.header.len = (uint16_t)cells.size();
+    memcpy(blob.text, cells.data(), cells.size());
+    xQueueOverwrite(save_queue, &blob);
+}
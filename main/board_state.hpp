@@ -0,0 +1,38 @@
+#pragma once
+
+#include "grid_layout.hpp"
+#include <stdint.h>
+#include <string>
+
+#define BOARD_STATE_VERSION 1
+// Cells are stored as UTF-8, at most 4 bytes each
+#define BOARD_STATE_MAX_TEXT (GRID_MAX_CELLS * 4)
+
+// NVS blob: the layout shape the cells were shown in, then the cell text
+typedef struct __attribute__((packed))
+{
+    uint8_t version;
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t reserved;
+    int16_t slot_width;
+    int16_t slot_height;
+    uint16_t len;  // bytes of cell text that follow
+} BoardStateHeader;
+
+/**
+ * Last shown board contents, kept in NVS across reboots.
+ *
+ * The cells (GridBoard::get_snapshot()) are read back before the display
+ * starts so the first frame already shows the previous board. Saving never
+ * blocks the caller: the snapshot is handed to a low-priority task that
+ * writes it only if it differs from what is stored, so flash writes stay off
+ * the LVGL task and identical messages cost nothing.
+ */
+
+// Load the stored cells. Returns false if there are none or they were saved
+// for a different layout.
+bool board_state_load(const GridLayout &layout, std::string *cells);
+
+// Queue the cells for saving; a newer snapshot replaces one not yet written
+void board_state_save(const GridLayout &layout, const std::string &cells);
@@ -0,0 +1,420 @@
+#include "board_widget.hpp"
+#include "esp_log.h"
+#include <cstring>
+
+static const char *TAG = "BOARD_WIDGET";
+
+// Colors shared with the object-tree mode in grid_board.cpp
+#define SLOT_BG_COLOR     0x2A2A2A
+#define SLOT_BORDER_COLOR 0x3A3A3A
+#define SLOT_BORDER_WIDTH 1
+
+BoardWidget::BoardWidget(const GridGeometry &geometry)
+    : obj(nullptr), cells(nullptr), tile_cache(nullptr), flap_renderer(nullptr), emoji_atlas(nullptr),
+      geometry(geometry), cols(geometry.layout.cols), rows(geometry.layout.rows),
+      slot_width(geometry.layout.slot_width), slot_height(geometry.layout.slot_height),
+      row_offset(0), col_offset(0)
+{
+    cells = new BoardCell[cols * rows];
+    memset(cells, 0, sizeof(BoardCell) * cols * rows);
+    for (int i = 0; i < cols * rows; i++)
+    {
+        cells[i].pose = CARD_POSE_REST;
+    }
+}
+
+BoardWidget::~BoardWidget()
+{
+    if (obj)
+    {
+        lv_obj_delete(obj);
+    }
+    delete[] cells;
+}
+
+lv_obj_t *BoardWidget::create(lv_obj_t *parent)
+{
+    obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, geometry.width, geometry.height);
+    lv_obj_set_pos(obj, geometry.x0, geometry.y0);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(obj, draw_event_cb, LV_EVENT_DRAW_MAIN, this);
+
+    ESP_LOGI(TAG, "Board widget created: %s layout, %dx%d cells, %d bytes of cell state",
+             geometry.layout.name, cols, rows, (int)(sizeof(BoardCell) * cols * rows));
+    return obj;
+}
+
+void BoardWidget::get_slot_area(int row, int col, lv_area_t *area) const
+{
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    area->x1 = coords.x1 + geometry.col_x[col];
+    area->y1 = coords.y1 + geometry.row_y[row];
+    area->x2 = area->x1 + slot_width - 1;
+    area->y2 = area->y1 + slot_height - 1;
+}
+
+// Rows and columns whose slots can intersect clip, as inclusive ranges. Empty
+// ranges come back with first > last.
+void BoardWidget::get_slot_range(const lv_area_t &clip, int *row0, int *row1, int *col0, int *col1) const
+{
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int x1 = clip.x1 - coords.x1;
+    int x2 = clip.x2 - coords.x1;
+    int y1 = clip.y1 - coords.y1;
+    int y2 = clip.y2 - coords.y1;
+
+    *col0 = 0;
+    while (*col0 < cols && geometry.col_x[*col0] + slot_width <= x1)
+        (*col0)++;
+    *col1 = cols - 1;
+    while (*col1 >= 0 && geometry.col_x[*col1] > x2)
+        (*col1)--;
+    *row0 = 0;
+    while (*row0 < rows && geometry.row_y[*row0] + slot_height <= y1)
+        (*row0)++;
+    *row1 = rows - 1;
+    while (*row1 >= 0 && geometry.row_y[*row1] > y2)
+        (*row1)--;
+}
+
+// row, col address the cell array; the slot it is drawn in depends on the
+// scroll offset. rect is relative to the card's resting position inside the
+// slot border.
+void BoardWidget::invalidate_cell(int row, int col, const SlotRect *rect)
+{
+    if (!obj)
+        return;
+
+    int r = row - row_offset;
+    int c = col - col_offset;
+    lv_area_t area;
+    get_slot_area(r < 0 ? r + rows : r, c < 0 ? c + cols : c, &area);
+    if (rect)
+    {
+        if (slot_rect_empty(*rect))
+            return;
+        lv_area_t slot = area;
+        area.x1 = slot.x1 + SLOT_BORDER_WIDTH + rect->x1;
+        area.y1 = slot.y1 + SLOT_BORDER_WIDTH + rect->y1;
+        area.x2 = slot.x1 + SLOT_BORDER_WIDTH + rect->x2;
+        area.y2 = slot.y1 + SLOT_BORDER_WIDTH + rect->y2;
+        if (!lv_area_intersect(&area, &area, &slot))
+            return;
+    }
+    lv_obj_invalidate_area(obj, &area);
+}
+
+void BoardWidget::set_scroll_offset(int row_offset, int col_offset)
+{
+    if (row_offset == this->row_offset && col_offset == this->col_offset)
+        return;
+
+    bool rows_moved = row_offset != this->row_offset;
+    this->row_offset = row_offset;
+    this->col_offset = col_offset;
+    if (!obj)
+        return;
+
+    if (rows_moved)
+    {
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    // A horizontal shift only changes the rows that hold any card
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    for (int row = 0; row < rows; row++)
+    {
+        const BoardCell *line = &cells[row * cols];
+        for (int col = 0; col < cols; col++)
+        {
+            if (line[col].phase != BOARD_CELL_EMPTY)
+            {
+                int screen_row = row - row_offset;
+                lv_area_t area = coords;
+                area.y1 = coords.y1 + geometry.row_y[screen_row < 0 ? screen_row + rows : screen_row];
+                area.y2 = area.y1 + slot_height - 1;
+                lv_obj_invalidate_area(obj, &area);
+                break;
+            }
+        }
+    }
+}
+
+void BoardWidget::set_cell(int row, int col, const char *glyph, const lv_font_t *font, lv_color_t color)
+{
+    BoardCell &cell = cell_at(row, col);
+    strncpy(cell.glyph, glyph, sizeof(cell.glyph) - 1);
+    cell.glyph[sizeof(cell.glyph) - 1] = '\0';
+    cell.font = font;
+    cell.color = color;
+    cell.emoji = nullptr;
+    if (emoji_atlas)
+    {
+        uint32_t i = 0;
+        cell.emoji = emoji_atlas->find(lv_text_encoded_next(cell.glyph, &i));
+    }
+    if (tile_cache)
+    {
+        const lv_image_dsc_t *tile = tile_cache->acquire(cell.glyph, font, color);
+        if (flap_renderer && cell.phase == BOARD_CELL_MOVING)
+        {
+            // The card it replaces is what the next flap falls from
+            tile_cache->release(cell.prev_tile);
+            cell.prev_tile = cell.tile;
+            flap_renderer->forget(&cell - cells);
+        }
+        else
+        {
+            tile_cache->release(cell.tile);
+        }
+        cell.tile = tile;
+    }
+    if (cell.phase == BOARD_CELL_EMPTY)
+    {
+        cell.phase = BOARD_CELL_SETTLED;
+    }
+    invalidate_cell(row, col);
+}
+
+void BoardWidget::set_cell_pose(int row, int col, const CardPose &pose, const SlotRect *dirty)
+{
+    BoardCell &cell = cell_at(row, col);
+    if (card_pose_equal(cell.pose, pose))
+        return;
+
+    cell.pose = pose;
+    invalidate_cell(row, col, dirty);
+}
+
+void BoardWidget::set_cell_phase(int row, int col, BoardCellPhase phase)
+{
+    BoardCell &cell = cell_at(row, col);
+    cell.phase = phase;
+    if (phase != BOARD_CELL_MOVING && tile_cache)
+    {
+        tile_cache->release(cell.prev_tile);
+        cell.prev_tile = nullptr;
+    }
+}
+
+void BoardWidget::clear_cell(int row, int col)
+{
+    BoardCell &cell = cell_at(row, col);
+    if (cell.phase == BOARD_CELL_EMPTY)
+        return;
+
+    cell.phase = BOARD_CELL_EMPTY;
+    cell.glyph[0] = '\0';
+    cell.emoji = nullptr;
+    if (tile_cache)
+    {
+        tile_cache->release(cell.tile);
+        tile_cache->release(cell.prev_tile);
+    }
+    cell.tile = nullptr;
+    cell.prev_tile = nullptr;
+    cell.pose = CARD_POSE_REST;
+    invalidate_cell(row, col);
+}
+
+void BoardWidget::draw_event_cb(lv_event_t *e)
+{
+    BoardWidget *widget = (BoardWidget *)lv_event_get_user_data(e);
+    widget->draw(lv_event_get_layer(e));
+}
+
+// Paint every slot intersecting the current clip area. Cards are clipped to the
+// inside of their slot the same way the slot object clips its child card in the
+// object-tree mode.
+void BoardWidget::draw(lv_layer_t *layer)
+{
+    const lv_area_t clip_ori = layer->_clip_area;
+
+    lv_draw_rect_dsc_t slot_dsc;
+    lv_draw_rect_dsc_init(&slot_dsc);
+    slot_dsc.bg_color = lv_color_hex(SLOT_BG_COLOR);
+    slot_dsc.border_color = lv_color_hex(SLOT_BORDER_COLOR);
+    slot_dsc.border_width = SLOT_BORDER_WIDTH;
+    slot_dsc.radius = 0;
+
+    lv_draw_rect_dsc_t card_dsc;
+    lv_draw_rect_dsc_init(&card_dsc);
+    card_dsc.bg_color = lv_color_hex(BOARD_CARD_BG_COLOR);
+    card_dsc.radius = 0;
+
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+    label_dsc.align = LV_TEXT_ALIGN_CENTER;
+
+    lv_draw_image_dsc_t tile_dsc;
+    lv_draw_image_dsc_init(&tile_dsc);
+
+    // Only visit the slots under the clip area, not the whole grid
+    int row0, row1, col0, col1;
+    get_slot_range(clip_ori, &row0, &row1, &col0, &col1);
+
+    for (int row = row0; row <= row1; row++)
+    {
+        for (int col = col0; col <= col1; col++)
+        {
+            lv_area_t slot_area;
+            get_slot_area(row, col, &slot_area);
+
+            lv_area_t cell_clip;
+            if (!lv_area_intersect(&cell_clip, &clip_ori, &slot_area))
+                continue;
+
+            lv_draw_rect(layer, &slot_dsc, &slot_area);
+
+            const BoardCell &cell = cell_on_screen(row, col);
+            if (cell.phase == BOARD_CELL_EMPTY || cell.pose.opa <= LV_OPA_MIN)
+                continue;
+
+            lv_area_t inner = slot_area;
+            inner.x1 += SLOT_BORDER_WIDTH;
+            inner.y1 += SLOT_BORDER_WIDTH;
+            inner.x2 -= SLOT_BORDER_WIDTH;
+            inner.y2 -= SLOT_BORDER_WIDTH;
+            if (!lv_area_intersect(&cell_clip, &cell_clip, &inner))
+                continue;
+
+            lv_area_t card_area;
+            card_area.x1 = inner.x1 + cell.pose.x;
+            card_area.x2 = card_area.x1 + slot_width - 1;
+            card_area.y1 = inner.y1 + cell.pose.y;
+            card_area.y2 = card_area.y1 + slot_height - 1;
+
+            // A cut hides the right part of the card
+            if (cell.pose.cut > 0)
+            {
+                lv_area_t shown = card_area;
+                shown.x2 -= cell.pose.cut;
+                if (!lv_area_intersect(&cell_clip, &cell_clip, &shown))
+                    continue;
+            }
+
+            if (cell.pose.flap && draw_flap(layer, cell, card_area, cell_clip, &tile_dsc, &card_dsc))
+                continue;
+
+            layer->_clip_area = cell_clip;
+            if (cell.tile)
+            {
+                // Background and glyph are already composited into the tile
+                tile_dsc.src = cell.tile;
+                tile_dsc.opa = cell.pose.opa;
+                lv_draw_image(layer, &tile_dsc, &card_area);
+                layer->_clip_area = clip_ori;
+                continue;
+            }
+
+            card_dsc.bg_opa = cell.pose.opa;
+            lv_draw_rect(layer, &card_dsc, &card_area);
+
+            if (cell.emoji)
+            {
+                // Centered like the label, blended by LVGL every time it is drawn
+                lv_area_t emoji_area;
+                emoji_area.x1 = card_area.x1 + (slot_width - (int32_t)cell.emoji->header.w) / 2;
+                emoji_area.y1 = card_area.y1 + (slot_height - (int32_t)cell.emoji->header.h) / 2;
+                emoji_area.x2 = emoji_area.x1 + cell.emoji->header.w - 1;
+                emoji_area.y2 = emoji_area.y1 + cell.emoji->header.h - 1;
+                tile_dsc.src = cell.emoji;
+                tile_dsc.opa = cell.pose.opa;
+                lv_draw_image(layer, &tile_dsc, &emoji_area);
+            }
+            else if (cell.glyph[0] != '\0' && cell.font)
+            {
+                lv_area_t text_area = card_area;
+                text_area.y1 += (slot_height - cell.font->line_height) / 2;
+                text_area.y2 = text_area.y1 + cell.font->line_height - 1;
+                label_dsc.text = cell.glyph;
+                label_dsc.font = cell.font;
+                label_dsc.color = cell.color;
+                label_dsc.opa = cell.pose.opa;
+                lv_draw_label(layer, &label_dsc, &text_area);
+            }
+            layer->_clip_area = clip_ori;
+        }
+    }
+}
+
+// One piece of a split-flap card: image drawn at (x, y), limited to the rows
+// row1..row2 of the clip area
+void BoardWidget::draw_piece(lv_layer_t *layer, lv_draw_image_dsc_t *dsc, const lv_image_dsc_t *image, int32_t x,
+                             int32_t y, const lv_area_t &clip, int32_t row1, int32_t row2)
+{
+    lv_area_t piece_clip = clip;
+    piece_clip.y1 = LV_MAX(clip.y1, row1);
+    piece_clip.y2 = LV_MIN(clip.y2, row2);
+    if (!image || piece_clip.y1 > piece_clip.y2)
+        return;
+
+    lv_area_t area = {x, y, x + (int32_t)image->header.w - 1, y + (int32_t)image->header.h - 1};
+    layer->_clip_area = piece_clip;
+    dsc->src = image;
+    lv_draw_image(layer, dsc, &area);
+}
+
+// Split-flap frame: the new card's top half above the flap, the old card's
+// bottom half below it, the flap from SplitFlapRenderer in between. Returns
+// false if the cell has no tiles to build it from, then it is drawn as a
+// plain card.
+bool BoardWidget::draw_flap(lv_layer_t *layer, const BoardCell &cell, const lv_area_t &card_area,
+                            const lv_area_t &clip, lv_draw_image_dsc_t *tile_dsc, lv_draw_rect_dsc_t *card_dsc)
+{
+    if (!flap_renderer || !tile_cache || !cell.tile)
+        return false;
+
+    const lv_area_t clip_ori = layer->_clip_area;
+    const CardGeometry card = {(int16_t)slot_width, (int16_t)slot_height};
+    const int32_t hinge = card_area.y1 + card_flap_hinge(card);
+    const int32_t height = card_flap_height(cell.pose.flap, card);
+    const bool falling = card_flap_falling(cell.pose.flap);
+    tile_dsc->opa = LV_OPA_COVER;
+
+    // New top half, down to the flap
+    draw_piece(layer, tile_dsc, tile_cache->top_half(cell.tile), card_area.x1, card_area.y1, clip, card_area.y1,
+               falling ? hinge - height - 1 : hinge - 1);
+
+    // Old bottom half, from below the flap; a blank card if there was none
+    int32_t bottom_row = falling ? hinge : hinge + height;
+    if (cell.prev_tile)
+    {
+        draw_piece(layer, tile_dsc, tile_cache->bottom_half(cell.prev_tile), card_area.x1, hinge, clip, bottom_row,
+                   card_area.y2);
+    }
+    else
+    {
+        lv_area_t blank = {card_area.x1, bottom_row, card_area.x2, card_area.y2};
+        lv_area_t blank_clip;
+        if (lv_area_intersect(&blank_clip, &clip, &blank))
+        {
+            layer->_clip_area = blank_clip;
+            card_dsc->bg_opa = LV_OPA_COVER;
+            lv_draw_rect(layer, card_dsc, &blank);
+        }
+    }
+
+    // The flap, scaled from whichever half is turning
+    int cell_index = &cell - cells;
+    if (falling)
+    {
+        const lv_image_dsc_t *flap = flap_renderer->compose(cell_index, tile_cache->top_half(cell.prev_tile), height);
+        draw_piece(layer, tile_dsc, flap, card_area.x1, hinge - height, clip, hinge - height, hinge - 1);
+    }
+    else
+    {
+        const lv_image_dsc_t *flap = flap_renderer->compose(cell_index, tile_cache->bottom_half(cell.tile), height);
+        draw_piece(layer, tile_dsc, flap, card_area.x1, hinge, clip, hinge, hinge + height - 1);
+    }
+
+    layer->_clip_area = clip_ori;
+    return true;
+}
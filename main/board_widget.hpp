@@ -0,0 +1,103 @@
+#pragma once
+
+#include "lvgl.h"
+#include "card_transition.hpp"
+#include "emoji_atlas.hpp"
+#include "glyph_tile_cache.hpp"
+#include "grid_layout.hpp"
+#include "split_flap.hpp"
+#include <stdint.h>
+
+// Card background, also baked into cached glyph tiles
+#define BOARD_CARD_BG_COLOR 0x121212
+
+// Animation phase of a single board cell
+typedef enum : uint8_t
+{
+    BOARD_CELL_EMPTY = 0,   // slot background only
+    BOARD_CELL_MOVING,      // card is in a transition, its pose changes every frame
+    BOARD_CELL_SETTLED,     // card rests on its final glyph
+} BoardCellPhase;
+
+// Compact per-cell state, everything the draw callback needs for one slot
+typedef struct
+{
+    char glyph[8];              // UTF-8 text of the card
+    const lv_font_t *font;
+    lv_color_t color;
+    const lv_image_dsc_t *emoji; // color emoji drawn instead of the label, nullptr = none
+    const lv_image_dsc_t *tile; // pre-composited card image, nullptr = draw label
+    const lv_image_dsc_t *prev_tile; // card the flap falls from, only while moving with a flap renderer
+    CardPose pose;              // where in the slot the card is drawn, CARD_POSE_REST = resting
+    BoardCellPhase phase;
+} BoardCell;
+
+/**
+ * Single LVGL object that renders the whole split-flap grid.
+ *
+ * Instead of one lv_obj per slot, card and label, the widget keeps a flat
+ * BoardCell array and paints every cell from one LV_EVENT_DRAW_MAIN handler.
+ * Cell updates invalidate only the rectangle of the slot that changed, and a
+ * card in a transition only the footprint its effect reports for the frame.
+ * With a GlyphTileCache attached, cards are drawn as pre-rendered RGB565
+ * tiles, so a moving card costs one image blit instead of a label render.
+ * With a SplitFlapRenderer as well, cards in a flap pose are drawn as real
+ * split-flap characters from half tiles. Emoji an EmojiAtlas has are drawn
+ * from its color images, baked into their tile if there is a tile cache.
+ */
+class BoardWidget {
+public:
+    explicit BoardWidget(const GridGeometry &geometry);
+    ~BoardWidget();
+
+    // Create the LVGL object at the geometry's board origin
+    lv_obj_t *create(lv_obj_t *parent);
+    void set_tile_cache(GlyphTileCache *cache) { tile_cache = cache; }
+    void set_flap_renderer(SplitFlapRenderer *renderer) { flap_renderer = renderer; }  // needs the tile cache
+    void set_emoji_atlas(const EmojiAtlas *atlas) { emoji_atlas = atlas; }  // before the first set_cell()
+
+    void set_cell(int row, int col, const char *glyph, const lv_font_t *font, lv_color_t color);
+    // dirty is the part of the slot the change touches, nullptr = all of it
+    void set_cell_pose(int row, int col, const CardPose &pose, const SlotRect *dirty = nullptr);
+    void set_cell_phase(int row, int col, BoardCellPhase phase);
+    void clear_cell(int row, int col);
+
+    // Draw the cell array as a ring: screen slot (row, col) shows cell
+    // ((row + row_offset) % rows, (col + col_offset) % cols). Scrolling the
+    // board by one slot is an offset change, only the cells that come into
+    // view have to be written.
+    void set_scroll_offset(int row_offset, int col_offset);
+
+    lv_obj_t *get_obj() const { return obj; }
+
+private:
+    static void draw_event_cb(lv_event_t *e);
+    void draw(lv_layer_t *layer);
+    bool draw_flap(lv_layer_t *layer, const BoardCell &cell, const lv_area_t &card_area, const lv_area_t &clip,
+                   lv_draw_image_dsc_t *tile_dsc, lv_draw_rect_dsc_t *card_dsc);
+    void draw_piece(lv_layer_t *layer, lv_draw_image_dsc_t *dsc, const lv_image_dsc_t *image, int32_t x, int32_t y,
+                    const lv_area_t &clip, int32_t row1, int32_t row2);
+    void get_slot_area(int row, int col, lv_area_t *area) const;
+    void get_slot_range(const lv_area_t &clip, int *row0, int *row1, int *col0, int *col1) const;
+    void invalidate_cell(int row, int col, const SlotRect *rect = nullptr);
+    BoardCell &cell_at(int row, int col) { return cells[row * cols + col]; }
+    const BoardCell &cell_on_screen(int row, int col) const
+    {
+        int r = row + row_offset;
+        int c = col + col_offset;
+        return cells[(r >= rows ? r - rows : r) * cols + (c >= cols ? c - cols : c)];
+    }
+
+    lv_obj_t *obj;
+    BoardCell *cells;
+    GlyphTileCache *tile_cache;
+    SplitFlapRenderer *flap_renderer;
+    const EmojiAtlas *emoji_atlas;
+    GridGeometry geometry;
+    int cols;
+    int rows;
+    int slot_width;
+    int slot_height;
+    int row_offset;
+    int col_offset;
+};
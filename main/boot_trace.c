@@ -0,0 +1,237 @@
+/**
+ * @file boot_trace.c
+ * @brief Boot-phase tracer
+ */
+
+#include "boot_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+
+static const char *TAG = "BOOT_TRACE";
+
+static BootTracePhase phases[BOOT_TRACE_MAX_PHASES];
+static int next_phase = 0;
+static int dropped = 0;
+static int64_t (*clock_now)(void) = esp_timer_get_time;
+
+// Claim a slot; tasks may trace concurrently, so the index is taken atomically
+static int claim(const char *name, int64_t now)
+{
+    int id = __atomic_fetch_add(&next_phase, 1, __ATOMIC_RELAXED);
+    if (id >= BOOT_TRACE_MAX_PHASES) {
+        __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    phases[id].begin_us = now;
+    phases[id].end_us = -1;
+    phases[id].name = name;
+    return id;
+}
+
+int boot_trace_begin(const char *name)
+{
+    return claim(name, clock_now());
+}
+
+void boot_trace_end(int id)
+{
+    if (id < 0 || id >= BOOT_TRACE_MAX_PHASES) {
+        return;
+    }
+    phases[id].end_us = clock_now();
+}
+
+void boot_trace_mark(const char *name)
+{
+    int64_t now = clock_now();
+    int id = claim(name, now);
+    if (id >= 0) {
+        phases[id].end_us = now;
+    }
+}
+
+int boot_trace_count(void)
+{
+    int count = __atomic_load_n(&next_phase, __ATOMIC_RELAXED);
+    return count < BOOT_TRACE_MAX_PHASES ? count : BOOT_TRACE_MAX_PHASES;
+}
+
+int boot_trace_dropped(void)
+{
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+const BootTracePhase *boot_trace_get(int id)
+{
+    if (id < 0 || id >= boot_trace_count()) {
+        return NULL;
+    }
+    return &phases[id];
+}
+
+static bool closed(const BootTracePhase *p)
+{
+    return p->name && p->end_us >= p->begin_us;
+}
+
+int boot_trace_critical_path(int *path, int max)
+{
+    int count = boot_trace_count();
+    int target = -1;
+    for (int i = 0; i < count; i++) {
+        if (closed(&phases[i]) && (target < 0 || phases[i].end_us > phases[target].end_us)) {
+            target = i;
+        }
+    }
+    if (target < 0 || max <= 0) {
+        return 0;
+    }
+
+    // Collected backwards from the target, reversed at the end
+    int len = 0;
+    path[len++] = target;
+    int64_t t = phases[target].begin_us;
+    while (len < max) {
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            const BootTracePhase *p = &phases[i];
+            // Marks take no time, so they never hold anything up
+            if (!closed(p) || p->end_us == p->begin_us || p->end_us > t || i == path[len - 1]) {
+                continue;
+            }
+            if (best < 0 || p->end_us > phases[best].end_us ||
+                (p->end_us == phases[best].end_us && p->begin_us < phases[best].begin_us)) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        path[len++] = best;
+        t = phases[best].begin_us;
+    }
+
+    for (int i = 0; i < len / 2; i++) {
+        int tmp = path[i];
+        path[i] = path[len - 1 - i];
+        path[len - 1 - i] = tmp;
+    }
+    return len;
+}
+
+void boot_trace_report(void (*emit)(const char *line, void *arg), void *arg)
+{
+    char line[96];
+    int count = boot_trace_count();
+
+    // Insertion sort by start time; there are only a few dozen phases
+    int order[BOOT_TRACE_MAX_PHASES];
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (!phases[i].name) {
+            continue;
+        }
+        int j = n++;
+        while (j > 0 && phases[order[j - 1]].begin_us > phases[i].begin_us) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    emit("Boot timeline (ms since reset):", arg);
+    emit("    begin      end     time  phase", arg);
+    for (int i = 0; i < n; i++) {
+        const BootTracePhase *p = &phases[order[i]];
+        if (!closed(p)) {
+            snprintf(line, sizeof(line), "%9.1f     open           %s", p->begin_us / 1000.0, p->name);
+        } else if (p->end_us == p->begin_us) {
+            snprintf(line, sizeof(line), "%9.1f                    %s", p->begin_us / 1000.0, p->name);
+        } else {
+            snprintf(line, sizeof(line), "%9.1f %8.1f %8.1f  %s", p->begin_us / 1000.0, p->end_us / 1000.0,
+                     (p->end_us - p->begin_us) / 1000.0, p->name);
+        }
+        emit(line, arg);
+    }
+    if (boot_trace_dropped()) {
+        snprintf(line, sizeof(line), "(%d phases dropped, trace holds %d)", boot_trace_dropped(),
+                 BOOT_TRACE_MAX_PHASES);
+        emit(line, arg);
+    }
+
+    int path[BOOT_TRACE_MAX_PHASES];
+    int len = boot_trace_critical_path(path, BOOT_TRACE_MAX_PHASES);
+    if (len == 0) {
+        return;
+    }
+    const BootTracePhase *target = &phases[path[len - 1]];
+    double total = target->end_us / 1000.0;
+    snprintf(line, sizeof(line), "Critical path to \"%s\", %.1f ms:", target->name, total);
+    emit(line, arg);
+
+    int64_t t = 0;
+    int64_t untraced = 0;
+    for (int i = 0; i < len; i++) {
+        const BootTracePhase *p = &phases[path[i]];
+        if (p->begin_us > t) {
+            snprintf(line, sizeof(line), "%9.1f ms %5.1f%%  (untraced)", (p->begin_us - t) / 1000.0,
+                     total > 0 ? (p->begin_us - t) / 10.0 / total : 0.0);
+            emit(line, arg);
+            untraced += p->begin_us - t;
+        }
+        if (p->end_us > p->begin_us) {
+            snprintf(line, sizeof(line), "%9.1f ms %5.1f%%  %s", (p->end_us - p->begin_us) / 1000.0,
+                     total > 0 ? (p->end_us - p->begin_us) / 10.0 / total : 0.0, p->name);
+            emit(line, arg);
+        }
+        t = p->end_us;
+    }
+    snprintf(line, sizeof(line), "%9.1f ms traced, %.1f ms untraced", total - untraced / 1000.0,
+             untraced / 1000.0);
+    emit(line, arg);
+}
+
+static void emit_log(const char *line, void *arg)
+{
+    FILE *file = (FILE *)arg;
+    ESP_LOGI(TAG, "%s", line);
+    if (file) {
+        fprintf(file, "%s\n", line);
+    }
+}
+
+bool boot_trace_dump(const char *path)
+{
+    FILE *file = NULL;
+    if (path) {
+        file = fopen(path, "w");
+        if (!file) {
+            ESP_LOGW(TAG, "Cannot write %s", path);
+        }
+    }
+    boot_trace_report(emit_log, file);
+    if (file) {
+        bool ok = ferror(file) == 0;
+        ok = fclose(file) == 0 && ok;
+        if (ok) {
+            ESP_LOGI(TAG, "Boot trace written to %s", path);
+        }
+        return ok;
+    }
+    return path == NULL;
+}
+
+void boot_trace_reset(void)
+{
+    __atomic_store_n(&next_phase, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&dropped, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < BOOT_TRACE_MAX_PHASES; i++) {
+        phases[i].name = NULL;
+    }
+}
+
+void boot_trace_set_clock(int64_t (*now)(void))
+{
+    clock_now = now ? now : esp_timer_get_time;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file boot_trace.h
+ * @brief Boot-phase tracer: named begin/end stamps of the startup steps
+ *
+ * Each phase takes one slot of a static array, stamped with esp_timer
+ * microseconds (time since reset). Recording is lock-free and allocation-free,
+ * so any task may trace from any point of startup, including before the
+ * scheduler starts. Once the board is idle the trace is reported as a
+ * timeline sorted by start time, followed by the critical path: the chain of
+ * phases, each ending before the next one starts, that leads up to the last
+ * phase to finish, and the untraced gaps between them.
+ *
+ * Plain C with no FreeRTOS dependency, so the host build can unit-test it.
+ */
+
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Phases beyond this are dropped (and counted) */
+#define BOOT_TRACE_MAX_PHASES 48
+
+typedef struct
+{
+    const char *name;   /**< Static string, not copied */
+    int64_t begin_us;
+    int64_t end_us;     /**< -1 while the phase is open, begin_us for a mark */
+} BootTracePhase;
+
+/**
+ * @brief Start a phase
+ *
+ * @return Id to pass to boot_trace_end(), -1 if the trace is full
+ */
+int boot_trace_begin(const char *name);
+
+/**
+ * @brief End a phase started with boot_trace_begin(); ignores -1
+ */
+void boot_trace_end(int id);
+
+/**
+ * @brief Record an instant, e.g. the first rendered frame
+ */
+void boot_trace_mark(const char *name);
+
+/**
+ * @brief Number of recorded phases
+ */
+int boot_trace_count(void);
+
+/**
+ * @brief Phases dropped because the trace was full
+ */
+int boot_trace_dropped(void);
+
+/**
+ * @brief Recorded phase by id, NULL if out of range
+ */
+const BootTracePhase *boot_trace_get(int id);
+
+/**
+ * @brief Critical path up to the last phase to end
+ *
+ * Walks back from the phase that ends last: the predecessor of a phase is the
+ * closed phase that ends latest at or before its start (the longer one on a
+ * tie). Nested and overlapping phases are skipped this way, so each step is
+ * time the target actually waited for.
+ *
+ * @param path Receives phase ids, earliest first
+ * @return Number of ids written
+ */
+int boot_trace_critical_path(int *path, int max);
+
+/**
+ * @brief Format the timeline and critical path, one line per call of emit
+ */
+void boot_trace_report(void (*emit)(const char *line, void *arg), void *arg);
+
+/**
+ * @brief Write the report to the log and, if path is not NULL, to a file
+ *
+ * @return false if the file could not be written
+ */
+bool boot_trace_dump(const char *path);
+
+/**
+ * @brief Forget all phases (tests)
+ */
+void boot_trace_reset(void);
+
+/**
+ * @brief Replace the esp_timer clock (tests); NULL restores it
+ */
+void boot_trace_set_clock(int64_t (*now)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_TRACE_H
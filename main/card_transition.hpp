@@ -0,0 +1,310 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// How a card comes into its slot. Every candidate a spinning cell shows
+// enters with the same transition.
+typedef enum : uint8_t
+{
+    CARD_TRANSITION_DROP = 0,    // falls through the slot from above
+    CARD_TRANSITION_FADE,        // fades in where it rests
+    CARD_TRANSITION_SLIDE,       // slides in from the right edge
+    CARD_TRANSITION_TYPEWRITER,  // revealed left to right
+    CARD_TRANSITION_FLAP,        // split-flap: the top half folds down over the hinge
+    CARD_TRANSITION_COUNT,
+} CardTransition;
+
+#define CARD_OPA_COVER 255
+
+// Where and how a card is drawn inside its slot, relative to its resting
+// position. A zero offset, no cut, full opacity and no flap is a card at rest.
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t cut;    // pixels hidden at the card's right edge
+    uint8_t opa;    // 0 = invisible .. CARD_OPA_COVER
+    uint16_t flap;  // split-flap fall in Q10, 1..1024; 0 = no flap
+} CardPose;
+
+static constexpr CardPose CARD_POSE_REST = {0, 0, 0, CARD_OPA_COVER, 0};
+
+// Rectangle inside a slot, inclusive like lv_area_t, origin at the card's
+// resting top left. Empty if x1 > x2 or y1 > y2.
+typedef struct
+{
+    int16_t x1;
+    int16_t y1;
+    int16_t x2;
+    int16_t y2;
+} SlotRect;
+
+static constexpr SlotRect SLOT_RECT_EMPTY = {0, 0, -1, -1};
+
+// Size of the card a transition moves
+typedef struct
+{
+    int16_t width;
+    int16_t height;
+} CardGeometry;
+
+inline bool card_pose_equal(const CardPose &a, const CardPose &b)
+{
+    return a.x == b.x && a.y == b.y && a.cut == b.cut && a.opa == b.opa && a.flap == b.flap;
+}
+
+inline bool slot_rect_empty(const SlotRect &r)
+{
+    return r.x1 > r.x2 || r.y1 > r.y2;
+}
+
+// Bounding box of both, ignoring empty ones
+inline SlotRect slot_rect_union(const SlotRect &a, const SlotRect &b)
+{
+    if (slot_rect_empty(a))
+        return b;
+    if (slot_rect_empty(b))
+        return a;
+    return {a.x1 < b.x1 ? a.x1 : b.x1, a.y1 < b.y1 ? a.y1 : b.y1, a.x2 > b.x2 ? a.x2 : b.x2,
+            a.y2 > b.y2 ? a.y2 : b.y2};
+}
+
+// Part of the slot a card covers in a pose, empty if it is outside or transparent
+inline SlotRect card_visible_rect(const CardPose &pose, const CardGeometry &card)
+{
+    if (pose.opa == 0)
+        return SLOT_RECT_EMPTY;
+    SlotRect r = {pose.x, pose.y, (int16_t)(pose.x + card.width - 1 - pose.cut),
+                  (int16_t)(pose.y + card.height - 1)};
+    if (r.x1 < 0)
+        r.x1 = 0;
+    if (r.y1 < 0)
+        r.y1 = 0;
+    if (r.x2 > card.width - 1)
+        r.x2 = card.width - 1;
+    if (r.y2 > card.height - 1)
+        r.y2 = card.height - 1;
+    return slot_rect_empty(r) ? SLOT_RECT_EMPTY : r;
+}
+
+// Cubic ease-out, integer only: 1 - (1 - t)^3 in Q10
+inline int32_t card_ease_out_q10(uint16_t elapsed_ms, uint16_t duration_ms)
+{
+    if (elapsed_ms >= duration_ms)
+        return 1024;
+    int32_t inv = (int32_t)(duration_ms - elapsed_ms) * 1024 / duration_ms;  // 1 - t, Q10
+    int32_t inv3 = (inv * inv >> 10) * inv >> 10;
+    return 1024 - inv3;
+}
+
+/*
+ * Transition effects. Each one is a stateless type with:
+ *
+ *   duration_ms   default length of one transition
+ *   pose()        the card's pose after elapsed_ms of a transition
+ *                 length_ms long
+ *   footprint()   the part of the slot that has to be redrawn when the card
+ *                 goes from one pose to the next
+ *
+ * The timeline is instantiated once per effect, so both run inlined in its
+ * per-cell loop. footprint() is what keeps a transition cheap to render:
+ * only that rectangle of the slot is invalidated, not the whole slot.
+ */
+
+// The original split-flap drop: from two slots above to past the bottom edge
+struct DropTransition
+{
+    static constexpr uint16_t duration_ms = 333;
+
+    static CardPose pose(uint16_t elapsed_ms, uint16_t length_ms, const CardGeometry &card)
+    {
+        int32_t start = -card.height * 2;
+        int32_t end = card.height * 6 / 5;  // go beyond bottom
+        int32_t y = start + ((end - start) * card_ease_out_q10(elapsed_ms, length_ms) >> 10);
+        return {0, (int16_t)y, 0, CARD_OPA_COVER, 0};
+    }
+
+    // The rows the card leaves and the rows it enters; nothing while it is
+    // still above the slot
+    static SlotRect footprint(const CardPose &from, const CardPose &to, const CardGeometry &card)
+    {
+        if (from.y == to.y)
+            return SLOT_RECT_EMPTY;
+        return slot_rect_union(card_visible_rect(from, card), card_visible_rect(to, card));
+    }
+};
+
+// Fades in at rest; every pixel of the card changes with the opacity
+struct FadeTransition
+{
+    static constexpr uint16_t duration_ms = 200;
+
+    static CardPose pose(uint16_t elapsed_ms, uint16_t length_ms, const CardGeometry &)
+    {
+        uint32_t opa = elapsed_ms >= length_ms ? CARD_OPA_COVER : (uint32_t)elapsed_ms * CARD_OPA_COVER / length_ms;
+        return {0, 0, 0, (uint8_t)opa, 0};
+    }
+
+    static SlotRect footprint(const CardPose &from, const CardPose &to, const CardGeometry &card)
+    {
+        if (from.opa == to.opa)
+            return SLOT_RECT_EMPTY;
+        return {0, 0, (int16_t)(card.width - 1), (int16_t)(card.height - 1)};
+    }
+};
+
+// Enters from the right edge and eases to rest; left of the card's leading
+// edge nothing changes
+struct SlideTransition
+{
+    static constexpr uint16_t duration_ms = 250;
+
+    static CardPose pose(uint16_t elapsed_ms, uint16_t length_ms, const CardGeometry &card)
+    {
+        int32_t x = card.width - (card.width * card_ease_out_q10(elapsed_ms, length_ms) >> 10);
+        return {(int16_t)x, 0, 0, CARD_OPA_COVER, 0};
+    }
+
+    static SlotRect footprint(const CardPose &from, const CardPose &to, const CardGeometry &card)
+    {
+        if (from.x == to.x)
+            return SLOT_RECT_EMPTY;
+        return slot_rect_union(card_visible_rect(from, card), card_visible_rect(to, card));
+    }
+};
+
+// Uncovered column by column like a line being typed; only the newly
+// revealed strip changes
+struct TypewriterTransition
+{
+    static constexpr uint16_t duration_ms = 150;
+
+    static CardPose pose(uint16_t elapsed_ms, uint16_t length_ms, const CardGeometry &card)
+    {
+        int32_t shown = elapsed_ms >= length_ms ? card.width : (int32_t)card.width * elapsed_ms / length_ms;
+        return {0, 0, (int16_t)(card.width - shown), CARD_OPA_COVER, 0};
+    }
+
+    static SlotRect footprint(const CardPose &from, const CardPose &to, const CardGeometry &card)
+    {
+        if (from.cut == to.cut)
+            return SLOT_RECT_EMPTY;
+        int16_t more = from.cut > to.cut ? from.cut : to.cut;
+        int16_t less = from.cut > to.cut ? to.cut : from.cut;
+        return {(int16_t)(card.width - more), 0, (int16_t)(card.width - 1 - less), (int16_t)(card.height - 1)};
+    }
+};
+
+// Split-flap geometry. The hinge is the row the top half ends at. In the
+// first half of the fall (flap < 512) the flap is the old card's top half
+// folding down onto the hinge, in the second half the new card's bottom half
+// unfolding below it.
+inline int16_t card_flap_hinge(const CardGeometry &card)
+{
+    return card.height / 2;
+}
+
+inline bool card_flap_falling(uint16_t flap)
+{
+    return flap < 512;
+}
+
+// Projected height of the flap, from the hinge: the half's height times the
+// cosine of the flap angle, which is proportional to the fall. cos() uses
+// Bhaskara's approximation 4(1 - u^2) / (4 + u^2) for a quarter turn u in Q10,
+// good to a tenth of a percent.
+inline int16_t card_flap_height(uint16_t flap, const CardGeometry &card)
+{
+    int32_t half = card_flap_falling(flap) ? card_flap_hinge(card) : card.height - card_flap_hinge(card);
+    int32_t u = card_flap_falling(flap) ? flap * 2 : 2048 - flap * 2;
+    int32_t u2 = u * u >> 10;
+    return (int16_t)(half * 4 * (1024 - u2) / (4096 + u2));
+}
+
+// Rows the flap covers, empty without a flap
+inline SlotRect card_flap_rect(const CardPose &pose, const CardGeometry &card)
+{
+    if (pose.flap == 0)
+        return SLOT_RECT_EMPTY;
+    int16_t hinge = card_flap_hinge(card);
+    int16_t h = card_flap_height(pose.flap, card);
+    if (card_flap_falling(pose.flap))
+        return {0, (int16_t)(hinge - h), (int16_t)(card.width - 1), (int16_t)(hinge - 1)};
+    return {0, hinge, (int16_t)(card.width - 1), (int16_t)(hinge + h - 1)};
+}
+
+// A real split-flap character. The new card is drawn from precomputed half
+// tiles around a flap that is a row-scaled copy of one half, see
+// SplitFlapRenderer. Needs the board widget with a tile cache.
+struct FlapTransition
+{
+    static constexpr uint16_t duration_ms = 180;
+
+    static CardPose pose(uint16_t elapsed_ms, uint16_t length_ms, const CardGeometry &)
+    {
+        if (elapsed_ms >= length_ms)
+            return CARD_POSE_REST;
+        // Gravity: the flap starts slowly and hits the stop fast
+        int32_t t = (int32_t)elapsed_ms * 1024 / length_ms;
+        int32_t fall = t * t >> 10;
+        return {0, 0, 0, CARD_OPA_COVER, (uint16_t)(fall < 1 ? 1 : fall)};
+    }
+
+    // Only the rows the flap sweeps; the halves above and below it stay.
+    // Coming from or going to rest, the whole card changes halves.
+    static SlotRect footprint(const CardPose &from, const CardPose &to, const CardGeometry &card)
+    {
+        if (from.flap == to.flap)
+            return SLOT_RECT_EMPTY;
+        if (from.flap == 0 || to.flap == 0)
+            return {0, 0, (int16_t)(card.width - 1), (int16_t)(card.height - 1)};
+        return slot_rect_union(card_flap_rect(from, card), card_flap_rect(to, card));
+    }
+};
+
+// Call fn with a value of the effect type selected at run time. The one
+// switch happens here, everything fn does with the type is resolved at
+// compile time.
+template <typename Fn>
+inline auto card_transition_dispatch(CardTransition transition, Fn &&fn) -> decltype(fn(DropTransition{}))
+{
+    switch (transition)
+    {
+    case CARD_TRANSITION_FADE:
+        return fn(FadeTransition{});
+    case CARD_TRANSITION_SLIDE:
+        return fn(SlideTransition{});
+    case CARD_TRANSITION_TYPEWRITER:
+        return fn(TypewriterTransition{});
+    case CARD_TRANSITION_FLAP:
+        return fn(FlapTransition{});
+    default:
+        return fn(DropTransition{});
+    }
+}
+
+inline uint16_t card_transition_duration(CardTransition transition)
+{
+    return card_transition_dispatch(transition, [](auto effect) { return decltype(effect)::duration_ms; });
+}
+
+inline const char *card_transition_name(CardTransition transition)
+{
+    static const char *const names[CARD_TRANSITION_COUNT] = {"drop", "fade", "slide", "typewriter", "flap"};
+    return transition < CARD_TRANSITION_COUNT ? names[transition] : "drop";
+}
+
+// By name as card_transition_name() gives it; false if unknown
+inline bool card_transition_find(const char *name, CardTransition *transition)
+{
+    for (int i = 0; i < CARD_TRANSITION_COUNT; i++)
+    {
+        if (strcmp(name, card_transition_name((CardTransition)i)) == 0)
+        {
+            *transition = (CardTransition)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,202 @@
+#include "emoji_atlas.hpp"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <cstring>
+
+static const char *TAG = "EMOJI_ATLAS";
+
+// fg over bg with alpha 0..32. Red, green and blue are spread over a 32-bit
+// word with room above each field, so one multiply blends all three.
+static inline uint16_t blend_rgb565(uint16_t fg, uint16_t bg, uint32_t alpha)
+{
+    uint32_t f = (fg | ((uint32_t)fg << 16)) & 0x07E0F81Fu;
+    uint32_t b = (bg | ((uint32_t)bg << 16)) & 0x07E0F81Fu;
+    uint32_t mix = ((((f - b) * alpha) >> 5) + b) & 0x07E0F81Fu;
+    return (uint16_t)((mix >> 16) | mix);
+}
+
+void emoji_atlas_blit(const lv_image_dsc_t *image, uint16_t *dst, int dst_width, int dst_height, int x, int y)
+{
+    const int width = image->header.w;
+    const int height = image->header.h;
+    const int x0 = LV_MAX(x, 0);
+    const int y0 = LV_MAX(y, 0);
+    const int x1 = LV_MIN(x + width, dst_width);
+    const int y1 = LV_MIN(y + height, dst_height);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    const uint16_t *colors = (const uint16_t *)image->data;
+    const uint8_t *alphas = image->data + width * height * sizeof(uint16_t);
+    for (int row = y0; row < y1; row++)
+    {
+        const uint16_t *src = colors + (row - y) * width + (x0 - x);
+        const uint8_t *a = alphas + (row - y) * width + (x0 - x);
+        uint16_t *out = dst + row * dst_width + x0;
+        for (int n = x1 - x0; n > 0; n--, src++, a++, out++)
+        {
+            if (*a == 0)
+                continue;
+            if (*a == 255)
+                *out = *src;
+            else
+                *out = blend_rgb565(*src, *out, (*a + 4u) >> 3);
+        }
+    }
+}
+
+EmojiAtlas::EmojiAtlas()
+    : atlas(nullptr), atlas_size(0), entries(nullptr), images(nullptr), image_count(0), image_width(0),
+      image_height(0), map_handle(0)
+{
+}
+
+EmojiAtlas::~EmojiAtlas()
+{
+    close();
+}
+
+void EmojiAtlas::close()
+{
+    delete[] images;
+    images = nullptr;
+    entries = nullptr;
+    image_count = 0;
+    image_width = 0;
+    image_height = 0;
+    atlas = nullptr;
+    atlas_size = 0;
+    if (map_handle)
+    {
+        esp_partition_munmap(map_handle);
+        map_handle = 0;
+    }
+}
+
+bool EmojiAtlas::map_partition(const char *label)
+{
+    close();
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!part)
+    {
+        ESP_LOGW(TAG, "No \"%s\" partition", label);
+        return false;
+    }
+
+    // Map the header to learn the size, then exactly the atlas
+    const void *ptr = nullptr;
+    esp_partition_mmap_handle_t handle;
+    if (esp_partition_mmap(part, 0, sizeof(EmojiAtlasHeader), ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Cannot map partition \"%s\"", label);
+        return false;
+    }
+    EmojiAtlasHeader header;
+    memcpy(&header, ptr, sizeof(header));
+    esp_partition_munmap(handle);
+    if (header.magic != EMOJI_ATLAS_MAGIC || header.size < sizeof(header) || header.size > part->size)
+    {
+        ESP_LOGW(TAG, "Partition \"%s\" holds no emoji atlas", label);
+        return false;
+    }
+
+    if (esp_partition_mmap(part, 0, header.size, ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Cannot map %u bytes of partition \"%s\"", (unsigned)header.size, label);
+        return false;
+    }
+    if (!open(ptr, header.size))
+    {
+        esp_partition_munmap(handle);
+        return false;
+    }
+    map_handle = handle;
+    return true;
+}
+
+bool EmojiAtlas::open(const void *data, size_t size)
+{
+    close();
+    EmojiAtlasHeader header;
+    if (!data || size < sizeof(header))
+    {
+        ESP_LOGE(TAG, "Atlas too small");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != EMOJI_ATLAS_MAGIC || header.version != EMOJI_ATLAS_VERSION)
+    {
+        ESP_LOGE(TAG, "Not an emoji atlas of version %d", EMOJI_ATLAS_VERSION);
+        return false;
+    }
+    if (header.size > size || header.size < sizeof(header) || header.count == 0 || header.width == 0 ||
+        header.height == 0 || header.width > EMOJI_ATLAS_MAX_SIZE || header.height > EMOJI_ATLAS_MAX_SIZE)
+    {
+        ESP_LOGE(TAG, "Atlas header is inconsistent: %u of %u bytes, %u emoji of %ux%u", (unsigned)header.size,
+                 (unsigned)size, header.count, header.width, header.height);
+        return false;
+    }
+
+    const uint8_t *base = (const uint8_t *)data;
+    const uint32_t image_bytes = emoji_atlas_image_bytes(header.width, header.height);
+    const uint64_t table_end = sizeof(header) + (uint64_t)header.count * sizeof(EmojiAtlasEntry);
+    if (table_end > header.size)
+    {
+        ESP_LOGE(TAG, "Emoji table out of range");
+        return false;
+    }
+
+    // Sorted for the binary search in find(), every image inside the atlas
+    const EmojiAtlasEntry *table = (const EmojiAtlasEntry *)(base + sizeof(header));
+    for (int i = 0; i < header.count; i++)
+    {
+        const EmojiAtlasEntry &e = table[i];
+        if ((i > 0 && e.codepoint <= table[i - 1].codepoint) || e.offset % 4 != 0 || e.offset < table_end ||
+            (uint64_t)e.offset + image_bytes > header.size)
+        {
+            ESP_LOGE(TAG, "Emoji %d of the atlas is malformed", i);
+            return false;
+        }
+    }
+
+    images = new lv_image_dsc_t[header.count];
+    memset(images, 0, sizeof(lv_image_dsc_t) * header.count);
+    for (int i = 0; i < header.count; i++)
+    {
+        lv_image_dsc_t &image = images[i];
+        image.header.magic = LV_IMAGE_HEADER_MAGIC;
+        image.header.cf = LV_COLOR_FORMAT_RGB565A8;
+        image.header.w = header.width;
+        image.header.h = header.height;
+        image.header.stride = header.width * sizeof(uint16_t);  // of the color plane
+        image.data_size = image_bytes;
+        image.data = base + table[i].offset;
+    }
+
+    atlas = base;
+    atlas_size = header.size;
+    entries = table;
+    image_count = header.count;
+    image_width = header.width;
+    image_height = header.height;
+    ESP_LOGI(TAG, "Emoji atlas: %d emoji of %dx%d, %u KB, used in place", image_count, image_width, image_height,
+             (unsigned)(atlas_size / 1024));
+    return true;
+}
+
+const lv_image_dsc_t *EmojiAtlas::find(uint32_t codepoint) const
+{
+    int lo = 0;
+    int hi = image_count - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (entries[mid].codepoint == codepoint)
+            return &images[mid];
+        if (entries[mid].codepoint < codepoint)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return nullptr;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "lvgl.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Emoji atlas: color emoji as RGB565A8 images packed into one binary image
+ * that is used where it lies, normally memory-mapped from the "emoji" flash
+ * partition. host/emoji_atlas_pack writes it from PNG files.
+ *
+ * Layout, little endian, offsets from the start of the atlas:
+ *
+ *   EmojiAtlasHeader
+ *   EmojiAtlasEntry        x count, sorted by codepoint, no duplicates
+ *   images                 4-byte aligned, width x height RGB565 pixels
+ *                          followed by width x height A8 alpha values
+ *
+ * Every image has the atlas' size. The pixels are LVGL's RGB565A8 layout,
+ * so an image can be drawn by LVGL as it is or blitted into a card tile
+ * with emoji_atlas_blit().
+ */
+
+#define EMOJI_ATLAS_MAGIC 0x414A4D45u  // "EMJA"
+#define EMOJI_ATLAS_VERSION 1
+#define EMOJI_ATLAS_MAX_SIZE 256
+#define EMOJI_ATLAS_PARTITION "emoji"
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint16_t width;
+    uint16_t height;
+    uint32_t size;  // the whole atlas in bytes
+} EmojiAtlasHeader;
+
+typedef struct
+{
+    uint32_t codepoint;
+    uint32_t offset;  // of the image
+} EmojiAtlasEntry;
+
+static_assert(sizeof(EmojiAtlasHeader) == 16, "emoji atlas header layout");
+static_assert(sizeof(EmojiAtlasEntry) == 8, "emoji atlas entry layout");
+
+// Bytes of one image: the RGB565 plane and the alpha plane
+inline uint32_t emoji_atlas_image_bytes(uint32_t width, uint32_t height)
+{
+    return width * height * 3;
+}
+
+/**
+ * Alpha-blends an RGB565A8 image onto an RGB565 buffer of dst_width x
+ * dst_height pixels with its top left corner at (x, y), clipped to the
+ * buffer. Fully transparent pixels are skipped and opaque ones copied; the
+ * rest is blended with 5-bit alpha, at most 2 steps off an exact blend.
+ */
+void emoji_atlas_blit(const lv_image_dsc_t *image, uint16_t *dst, int dst_width, int dst_height, int x, int y);
+
+/**
+ * Emoji images of an emoji atlas, ready for LVGL.
+ *
+ * open() checks the atlas and sets up an lv_image_dsc_t per emoji whose
+ * pixels point into the atlas; nothing of the atlas is copied. The atlas
+ * has to stay in place while the images are in use: map_partition() keeps
+ * its mapping until close() or destruction.
+ */
+class EmojiAtlas {
+public:
+    EmojiAtlas();
+    ~EmojiAtlas();
+
+    // Use an atlas that is already in memory. False if it is malformed.
+    bool open(const void *data, size_t size);
+    // Memory-map the atlas in a data partition and open it
+    bool map_partition(const char *label = EMOJI_ATLAS_PARTITION);
+    void close();
+
+    // Image of an emoji, nullptr if the atlas has none for the codepoint
+    const lv_image_dsc_t *find(uint32_t codepoint) const;
+    int count() const { return image_count; }
+    int width() const { return image_width; }
+    int height() const { return image_height; }
+    size_t size() const { return atlas_size; }
+
+private:
+    const uint8_t *atlas;
+    size_t atlas_size;
+    const EmojiAtlasEntry *entries;
+    lv_image_dsc_t *images;  // one per entry
+    int image_count;
+    int image_width;
+    int image_height;
+    uint32_t map_handle;  // esp_partition_mmap_handle_t, 0 if not mapped
+};
@@ -0,0 +1,139 @@
+#include "flip_timeline.hpp"
+#include <cstring>
+
+FlipTimeline::FlipTimeline(int cell_count, const FlipTimelineConfig &config)
+    : config(config), cell_count(cell_count), num_active(0), pending_ms(0), listener(nullptr)
+{
+    cells = new FlipCellState[cell_count];
+    active = new int16_t[cell_count];
+    active_pos = new int16_t[cell_count];
+    memset(cells, 0, sizeof(FlipCellState) * cell_count);
+    for (int i = 0; i < cell_count; i++)
+    {
+        active_pos[i] = -1;
+    }
+}
+
+FlipTimeline::~FlipTimeline()
+{
+    delete[] cells;
+    delete[] active;
+    delete[] active_pos;
+}
+
+void FlipTimeline::start(int cell, uint16_t delay_ms)
+{
+    if (cell < 0 || cell >= cell_count)
+        return;
+
+    FlipCellState &c = cells[cell];
+    c.phase = FLIP_DELAY;
+    c.elapsed_ms = 0;
+    c.delay_ms = delay_ms;
+    c.pose = pose_at(0);
+    c.drops = 0;
+
+    if (active_pos[cell] < 0)
+    {
+        active_pos[cell] = num_active;
+        active[num_active++] = cell;
+    }
+}
+
+void FlipTimeline::cancel(int cell)
+{
+    if (cell < 0 || cell >= cell_count || active_pos[cell] < 0)
+        return;
+
+    cells[cell].phase = FLIP_IDLE;
+    deactivate(active_pos[cell]);
+}
+
+void FlipTimeline::deactivate(int active_index)
+{
+    int cell = active[active_index];
+    int last = active[--num_active];
+    active[active_index] = last;
+    active_pos[last] = active_index;
+    active_pos[cell] = -1;
+}
+
+CardPose FlipTimeline::pose_at(uint16_t elapsed_ms) const
+{
+    return card_transition_dispatch(config.transition, [&](auto effect) {
+        return decltype(effect)::pose(elapsed_ms, config.duration_ms, config.card);
+    });
+}
+
+void FlipTimeline::advance(uint32_t elapsed_ms)
+{
+    pending_ms += elapsed_ms;
+    while (pending_ms >= config.step_ms)
+    {
+        pending_ms -= config.step_ms;
+        step();
+    }
+    if (num_active == 0)
+    {
+        pending_ms = 0;
+    }
+}
+
+void FlipTimeline::step()
+{
+    card_transition_dispatch(config.transition, [this](auto effect) { step_cells<decltype(effect)>(); });
+}
+
+template <typename Effect>
+void FlipTimeline::step_cells()
+{
+    // Iterate backwards so deactivating a cell (swap with the last) is safe
+    for (int i = num_active - 1; i >= 0; i--)
+    {
+        if (i >= num_active)
+            continue;  // listener cancelled cells during this step
+
+        int cell = active[i];
+        FlipCellState &c = cells[cell];
+        c.elapsed_ms += config.step_ms;
+
+        if (c.phase == FLIP_DELAY)
+        {
+            if (c.elapsed_ms < c.delay_ms)
+                continue;
+            c.elapsed_ms -= c.delay_ms;
+            c.phase = FLIP_FALLING;
+            if (listener)
+                listener->on_flip_start(cell);
+        }
+
+        if (c.phase != FLIP_FALLING)
+            continue;
+
+        if (c.elapsed_ms >= config.duration_ms)
+        {
+            c.drops++;
+            bool settled = listener ? listener->on_flip_landed(cell) : true;
+            if (c.phase != FLIP_FALLING)
+                continue;  // cancelled or restarted from the callback
+            if (settled)
+            {
+                c.phase = FLIP_IDLE;
+                c.pose = CARD_POSE_REST;
+                if (active_pos[cell] >= 0)
+                    deactivate(active_pos[cell]);
+                continue;
+            }
+            c.elapsed_ms -= config.duration_ms;
+        }
+
+        CardPose pose = Effect::pose(c.elapsed_ms, config.duration_ms, config.card);
+        if (!card_pose_equal(pose, c.pose))
+        {
+            SlotRect dirty = Effect::footprint(c.pose, pose, config.card);
+            c.pose = pose;
+            if (listener)
+                listener->on_flip_move(cell, pose, dirty);
+        }
+    }
+}
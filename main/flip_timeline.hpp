@@ -0,0 +1,90 @@
+#pragma once
+
+#include "card_transition.hpp"
+#include <stdint.h>
+
+// Phase of one cell's flip state machine
+typedef enum : uint8_t
+{
+    FLIP_IDLE = 0,     // not animating (blank or settled)
+    FLIP_DELAY,        // waiting for its start delay
+    FLIP_FALLING,      // card in its transition
+} FlipPhase;
+
+// Per-cell animation state, kept small so a whole board fits in a few cache lines
+typedef struct
+{
+    uint16_t elapsed_ms;   // time spent in the current phase
+    uint16_t delay_ms;     // start delay, only meaningful in FLIP_DELAY
+    CardPose pose;         // current card pose
+    FlipPhase phase;
+    uint8_t drops;         // completed drops since start
+} FlipCellState;
+
+typedef struct
+{
+    CardTransition transition;
+    CardGeometry card;      // size of the card the transition moves
+    uint16_t duration_ms;   // length of one transition
+    uint16_t step_ms;       // fixed simulation step
+} FlipTimelineConfig;
+
+// Receives the events of the timeline, in cell order within a step
+class FlipTimelineListener {
+public:
+    virtual ~FlipTimelineListener() {}
+    virtual void on_flip_start(int cell) = 0;
+    // A transition ended. Return true if the cell settles, false to run it again.
+    virtual bool on_flip_landed(int cell) = 0;
+    // The card's pose changed; only dirty, in slot coordinates, needs redrawing
+    virtual void on_flip_move(int cell, const CardPose &pose, const SlotRect &dirty) = 0;
+};
+
+/**
+ * Board-level animation timeline.
+ *
+ * Replaces one lv_anim and one lv_timer per card with a single state array
+ * advanced in fixed steps. advance() is driven from one LVGL timer on the
+ * device or directly from host code. Only active cells are visited, so the
+ * cost of a step does not grow with the size of the grid, only with the
+ * number of cards in flight. The timeline holds no clock or random source of
+ * its own, so the same inputs always replay the same animation.
+ *
+ * The card motion is one of the effects in card_transition.hpp. step() picks
+ * the loop instantiated for the configured effect, so computing a cell's pose
+ * and its dirty footprint costs no call per cell.
+ */
+class FlipTimeline {
+public:
+    FlipTimeline(int cell_count, const FlipTimelineConfig &config);
+    ~FlipTimeline();
+
+    void set_listener(FlipTimelineListener *l) { listener = l; }
+
+    void start(int cell, uint16_t delay_ms);
+    void cancel(int cell);
+
+    // Advance by elapsed_ms of wall time; runs as many fixed steps as fit
+    void advance(uint32_t elapsed_ms);
+    void step();
+
+    int active_count() const { return num_active; }
+    const FlipCellState &state(int cell) const { return cells[cell]; }
+    const FlipTimelineConfig &get_config() const { return config; }
+    void set_config(const FlipTimelineConfig &c) { config = c; }  // only while no cell is active
+    // Pose of a card elapsed_ms into the configured transition
+    CardPose pose_at(uint16_t elapsed_ms) const;
+
+private:
+    template <typename Effect> void step_cells();
+    void deactivate(int active_index);
+
+    FlipTimelineConfig config;
+    FlipCellState *cells;
+    int16_t *active;        // indices of cells in DELAY/FALLING
+    int16_t *active_pos;    // position of each cell in active[], -1 if idle
+    int cell_count;
+    int num_active;
+    uint32_t pending_ms;    // wall time not yet consumed by a full step
+    FlipTimelineListener *listener;
+};
@@ -0,0 +1,299 @@
+#include "glyph_atlas.hpp"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <cstddef>
+#include <cstring>
+
+static const char *TAG = "GLYPH_ATLAS";
+
+// The glyph table is handed to LVGL as is
+#if !LV_FONT_FMT_TXT_LARGE
+#error "The glyph atlas needs LV_FONT_FMT_TXT_LARGE, its glyph table is LVGL's large glyph descriptor"
+#endif
+static_assert(sizeof(GlyphAtlasGlyph) == sizeof(lv_font_fmt_txt_glyph_dsc_t), "glyph table layout");
+static_assert(offsetof(GlyphAtlasGlyph, box_w) == offsetof(lv_font_fmt_txt_glyph_dsc_t, box_w), "glyph table layout");
+static_assert(offsetof(GlyphAtlasGlyph, ofs_y) == offsetof(lv_font_fmt_txt_glyph_dsc_t, ofs_y), "glyph table layout");
+
+GlyphAtlas::GlyphAtlas() : atlas(nullptr), atlas_size(0), fonts{}, count(0), map_handle(0)
+{
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    close();
+}
+
+void GlyphAtlas::close()
+{
+    for (int i = 0; i < count; i++)
+    {
+        delete[] fonts[i].cmaps;
+        fonts[i].cmaps = nullptr;
+    }
+    count = 0;
+    atlas = nullptr;
+    atlas_size = 0;
+    if (map_handle)
+    {
+        esp_partition_munmap(map_handle);
+        map_handle = 0;
+    }
+}
+
+bool GlyphAtlas::check_range(uint32_t offset, uint64_t bytes) const
+{
+    return offset % 4 == 0 && (uint64_t)offset + bytes <= atlas_size;
+}
+
+bool GlyphAtlas::map_partition(const char *label)
+{
+    close();
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!part)
+    {
+        ESP_LOGW(TAG, "No \"%s\" partition", label);
+        return false;
+    }
+
+    // Map the header to learn the size, then exactly the atlas
+    const void *ptr = nullptr;
+    esp_partition_mmap_handle_t handle;
+    if (esp_partition_mmap(part, 0, sizeof(GlyphAtlasHeader), ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Cannot map partition \"%s\"", label);
+        return false;
+    }
+    GlyphAtlasHeader header;
+    memcpy(&header, ptr, sizeof(header));
+    esp_partition_munmap(handle);
+    if (header.magic != GLYPH_ATLAS_MAGIC || header.size < sizeof(header) || header.size > part->size)
+    {
+        ESP_LOGW(TAG, "Partition \"%s\" holds no glyph atlas", label);
+        return false;
+    }
+
+    if (esp_partition_mmap(part, 0, header.size, ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Cannot map %u bytes of partition \"%s\"", (unsigned)header.size, label);
+        return false;
+    }
+    if (!open(ptr, header.size))
+    {
+        esp_partition_munmap(handle);
+        return false;
+    }
+    map_handle = handle;
+    return true;
+}
+
+bool GlyphAtlas::open(const void *data, size_t size)
+{
+    close();
+    GlyphAtlasHeader header;
+    if (!data || size < sizeof(header))
+    {
+        ESP_LOGE(TAG, "Atlas too small");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != GLYPH_ATLAS_MAGIC || header.version != GLYPH_ATLAS_VERSION)
+    {
+        ESP_LOGE(TAG, "Not a glyph atlas of version %d", GLYPH_ATLAS_VERSION);
+        return false;
+    }
+    if (header.size > size || header.font_count == 0 || header.font_count > GLYPH_ATLAS_MAX_FONTS)
+    {
+        ESP_LOGE(TAG, "Atlas header is inconsistent: %u of %u bytes, %u fonts", (unsigned)header.size,
+                 (unsigned)size, header.font_count);
+        return false;
+    }
+
+    atlas = (const uint8_t *)data;
+    atlas_size = header.size;
+    if (!check_range(sizeof(header), (uint64_t)header.font_count * sizeof(GlyphAtlasFont)))
+    {
+        ESP_LOGE(TAG, "Font table out of range");
+        close();
+        return false;
+    }
+
+    const GlyphAtlasFont *packed = (const GlyphAtlasFont *)(atlas + sizeof(header));
+    for (int i = 0; i < header.font_count; i++)
+    {
+        if (!load_font(packed[i], &fonts[i]))
+        {
+            ESP_LOGE(TAG, "Font %d of the atlas is malformed", i);
+            delete[] fonts[i].cmaps;
+            fonts[i].cmaps = nullptr;
+            close();
+            return false;
+        }
+        count = i + 1;
+    }
+
+    ESP_LOGI(TAG, "Glyph atlas: %d fonts, %u KB, used in place", count, (unsigned)(atlas_size / 1024));
+    return true;
+}
+
+// Check every table and offset of a font before LVGL gets to read it, then
+// point LVGL's font descriptors at the tables
+bool GlyphAtlas::load_font(const GlyphAtlasFont &packed, LoadedFont *loaded)
+{
+    const uint32_t glyph_count = packed.glyph_count;
+    if ((packed.bpp != 1 && packed.bpp != 2 && packed.bpp != 4 && packed.bpp != 8) || glyph_count == 0 ||
+        packed.cmap_num == 0)
+        return false;
+    if (!check_range(packed.glyphs, (uint64_t)glyph_count * sizeof(GlyphAtlasGlyph)) ||
+        !check_range(packed.bitmaps, packed.bitmap_size) ||
+        !check_range(packed.cmaps, (uint64_t)packed.cmap_num * sizeof(GlyphAtlasCmap)))
+        return false;
+
+    const GlyphAtlasGlyph *glyphs = (const GlyphAtlasGlyph *)(atlas + packed.glyphs);
+    for (uint32_t i = 0; i < glyph_count; i++)
+    {
+        uint32_t bytes = glyph_atlas_bitmap_bytes(glyphs[i].box_w, glyphs[i].box_h, packed.bpp);
+        if (bytes && (uint64_t)glyphs[i].bitmap_index + bytes > packed.bitmap_size)
+            return false;
+    }
+
+    // Character maps: every glyph id they can produce has to exist
+    const GlyphAtlasCmap *cmaps = (const GlyphAtlasCmap *)(atlas + packed.cmaps);
+    for (int i = 0; i < packed.cmap_num; i++)
+    {
+        const GlyphAtlasCmap &c = cmaps[i];
+        uint32_t last_id;
+        switch (c.type)
+        {
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+            last_id = c.glyph_id_start + c.range_length - 1;
+            break;
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+            if (!c.list_length || !check_range(c.unicode_list, c.list_length * 2ull))
+                return false;
+            last_id = c.glyph_id_start + c.list_length - 1;
+            break;
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+        {
+            if (!check_range(c.glyph_id_ofs_list, c.range_length))
+                return false;
+            const uint8_t *ofs = atlas + c.glyph_id_ofs_list;
+            last_id = c.glyph_id_start;
+            for (int k = 0; k < c.range_length; k++)
+                last_id = LV_MAX(last_id, (uint32_t)c.glyph_id_start + ofs[k]);
+            break;
+        }
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
+        {
+            if (!c.list_length || !check_range(c.unicode_list, c.list_length * 2ull) ||
+                !check_range(c.glyph_id_ofs_list, c.list_length * 2ull))
+                return false;
+            const uint16_t *ofs = (const uint16_t *)(atlas + c.glyph_id_ofs_list);
+            last_id = c.glyph_id_start;
+            for (int k = 0; k < c.list_length; k++)
+                last_id = LV_MAX(last_id, (uint32_t)c.glyph_id_start + ofs[k]);
+            break;
+        }
+        default:
+            return false;
+        }
+        if (c.range_length == 0 || last_id >= glyph_count)
+            return false;
+    }
+
+    loaded->cmaps = new lv_font_fmt_txt_cmap_t[packed.cmap_num];
+    memset(loaded->cmaps, 0, sizeof(lv_font_fmt_txt_cmap_t) * packed.cmap_num);
+    for (int i = 0; i < packed.cmap_num; i++)
+    {
+        const GlyphAtlasCmap &c = cmaps[i];
+        lv_font_fmt_txt_cmap_t &cmap = loaded->cmaps[i];
+        cmap.range_start = c.range_start;
+        cmap.range_length = c.range_length;
+        cmap.glyph_id_start = c.glyph_id_start;
+        cmap.unicode_list = c.unicode_list ? (const uint16_t *)(atlas + c.unicode_list) : nullptr;
+        cmap.glyph_id_ofs_list = c.glyph_id_ofs_list ? atlas + c.glyph_id_ofs_list : nullptr;
+        cmap.list_length = c.list_length;
+        cmap.type = (lv_font_fmt_txt_cmap_type_t)c.type;
+    }
+
+    memset(&loaded->dsc, 0, sizeof(loaded->dsc));
+    lv_font_fmt_txt_dsc_t &dsc = loaded->dsc;
+    dsc.glyph_bitmap = atlas + packed.bitmaps;
+    dsc.glyph_dsc = (const lv_font_fmt_txt_glyph_dsc_t *)glyphs;
+    dsc.cmaps = loaded->cmaps;
+    dsc.cmap_num = packed.cmap_num;
+    dsc.bpp = packed.bpp;
+    dsc.bitmap_format = LV_FONT_FMT_TXT_PLAIN;
+
+    if (packed.kern == GLYPH_ATLAS_KERN_CLASSES)
+    {
+        if (!check_range(packed.kern_table, sizeof(GlyphAtlasKernClasses)))
+            return false;
+        const GlyphAtlasKernClasses *k = (const GlyphAtlasKernClasses *)(atlas + packed.kern_table);
+        if (!check_range(k->class_pair_values, (uint64_t)k->left_class_cnt * k->right_class_cnt) ||
+            !check_range(k->left_class_mapping, glyph_count) || !check_range(k->right_class_mapping, glyph_count))
+            return false;
+        // Class 0 is "no kerning", the others index the value table from 1
+        for (uint32_t i = 0; i < glyph_count; i++)
+        {
+            if (atlas[k->left_class_mapping + i] > k->left_class_cnt ||
+                atlas[k->right_class_mapping + i] > k->right_class_cnt)
+                return false;
+        }
+        lv_font_fmt_txt_kern_classes_t &kc = loaded->kern_classes;
+        kc.class_pair_values = (const int8_t *)(atlas + k->class_pair_values);
+        kc.left_class_mapping = atlas + k->left_class_mapping;
+        kc.right_class_mapping = atlas + k->right_class_mapping;
+        kc.left_class_cnt = k->left_class_cnt;
+        kc.right_class_cnt = k->right_class_cnt;
+        dsc.kern_dsc = &kc;
+        dsc.kern_classes = 1;
+        dsc.kern_scale = packed.kern_scale;
+    }
+    else if (packed.kern == GLYPH_ATLAS_KERN_PAIRS)
+    {
+        if (!check_range(packed.kern_table, sizeof(GlyphAtlasKernPairs)))
+            return false;
+        const GlyphAtlasKernPairs *k = (const GlyphAtlasKernPairs *)(atlas + packed.kern_table);
+        if (k->glyph_ids_size > 1 || k->pair_cnt >= (1u << 30) ||
+            !check_range(k->glyph_ids, (uint64_t)k->pair_cnt * 2 * (k->glyph_ids_size + 1)) ||
+            !check_range(k->values, k->pair_cnt))
+            return false;
+        lv_font_fmt_txt_kern_pair_t &kp = loaded->kern_pairs;
+        kp.glyph_ids = atlas + k->glyph_ids;
+        kp.values = (const int8_t *)(atlas + k->values);
+        kp.pair_cnt = k->pair_cnt;
+        kp.glyph_ids_size = k->glyph_ids_size;
+        dsc.kern_dsc = &kp;
+        dsc.kern_classes = 0;
+        dsc.kern_scale = packed.kern_scale;
+    }
+    else if (packed.kern != GLYPH_ATLAS_KERN_NONE)
+    {
+        return false;
+    }
+
+    memset(&loaded->font, 0, sizeof(loaded->font));
+    lv_font_t &font = loaded->font;
+    font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+    font.get_glyph_bitmap = lv_font_get_bitmap_fmt_txt;
+    font.line_height = packed.line_height;
+    font.base_line = packed.base_line;
+    font.subpx = LV_FONT_SUBPX_NONE;
+    font.underline_position = packed.underline_position;
+    font.underline_thickness = packed.underline_thickness;
+    font.dsc = &loaded->dsc;
+
+    memcpy(loaded->name, packed.name, GLYPH_ATLAS_NAME_LEN);
+    loaded->name[GLYPH_ATLAS_NAME_LEN] = '\0';
+    return true;
+}
+
+const lv_font_t *GlyphAtlas::font(const char *name) const
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(fonts[i].name, name) == 0)
+            return &fonts[i].font;
+    }
+    return nullptr;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "lvgl.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Glyph atlas: LVGL bitmap fonts packed into one binary image that is used
+ * where it lies, normally memory-mapped from the "glyphs" flash partition.
+ * host/glyph_atlas_pack writes it from the built-in fonts or from fonts
+ * converted with lv_font_conv --format bin.
+ *
+ * Layout, little endian, every table 4-byte aligned, offsets from the start
+ * of the atlas:
+ *
+ *   GlyphAtlasHeader
+ *   GlyphAtlasFont         x font_count
+ *   per font, anywhere after the fonts:
+ *     GlyphAtlasGlyph      x glyph_count, glyph 0 is the "no glyph" entry
+ *     bitmaps              bpp bits per pixel, rows not padded
+ *     GlyphAtlasCmap       x cmap_num, plus the lists they point to
+ *     kerning              GlyphAtlasKernClasses or GlyphAtlasKernPairs
+ *
+ * The tables are LVGL's own lv_font_fmt_txt tables, so the font renders with
+ * LVGL's lv_font_get_glyph_dsc_fmt_txt() and lv_font_get_bitmap_fmt_txt()
+ * exactly like the fonts compiled in from C.
+ */
+
+#define GLYPH_ATLAS_MAGIC 0x54414C47u  // "GLAT"
+#define GLYPH_ATLAS_VERSION 1
+#define GLYPH_ATLAS_MAX_FONTS 4
+#define GLYPH_ATLAS_NAME_LEN 16
+#define GLYPH_ATLAS_PARTITION "glyphs"
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t font_count;
+    uint32_t size;  // the whole atlas in bytes
+    uint32_t reserved;
+} GlyphAtlasHeader;
+
+typedef enum : uint8_t
+{
+    GLYPH_ATLAS_KERN_NONE = 0,
+    GLYPH_ATLAS_KERN_CLASSES,
+    GLYPH_ATLAS_KERN_PAIRS,
+} GlyphAtlasKern;
+
+typedef struct
+{
+    char name[GLYPH_ATLAS_NAME_LEN];  // NUL padded, e.g. "text"
+    int16_t line_height;
+    int16_t base_line;
+    int8_t underline_position;
+    int8_t underline_thickness;
+    uint8_t bpp;          // 1, 2, 4 or 8
+    uint8_t kern;         // GlyphAtlasKern
+    uint16_t kern_scale;
+    uint16_t cmap_num;
+    uint32_t glyph_count;
+    uint32_t glyphs;      // offset of the GlyphAtlasGlyph table
+    uint32_t bitmaps;     // offset of the glyph bitmaps
+    uint32_t bitmap_size;
+    uint32_t cmaps;       // offset of the GlyphAtlasCmap table
+    uint32_t kern_table;  // offset of the kerning header, 0 without kerning
+} GlyphAtlasFont;
+
+// Same layout as lv_font_fmt_txt_glyph_dsc_t with LV_FONT_FMT_TXT_LARGE
+typedef struct
+{
+    uint32_t bitmap_index;  // from the font's bitmaps
+    uint32_t adv_w;         // 1/16 px
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+} GlyphAtlasGlyph;
+
+// lv_font_fmt_txt_cmap_t with offsets for pointers, 0 for none
+typedef struct
+{
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    uint32_t unicode_list;       // uint16_t x list_length
+    uint32_t glyph_id_ofs_list;  // uint8_t x range_length (FORMAT0_FULL) or uint16_t x list_length (SPARSE_FULL)
+    uint16_t list_length;
+    uint8_t type;                // lv_font_fmt_txt_cmap_type_t
+    uint8_t reserved;
+} GlyphAtlasCmap;
+
+// lv_font_fmt_txt_kern_classes_t with offsets for pointers
+typedef struct
+{
+    uint32_t class_pair_values;    // int8_t x left_class_cnt x right_class_cnt
+    uint32_t left_class_mapping;   // uint8_t x glyph_count
+    uint32_t right_class_mapping;  // uint8_t x glyph_count
+    uint8_t left_class_cnt;
+    uint8_t right_class_cnt;
+    uint16_t reserved;
+} GlyphAtlasKernClasses;
+
+// lv_font_fmt_txt_kern_pair_t with offsets for pointers
+typedef struct
+{
+    uint32_t glyph_ids;  // pair_cnt pairs of uint8_t (glyph_ids_size 0) or uint16_t (1)
+    uint32_t values;     // int8_t x pair_cnt
+    uint32_t pair_cnt;
+    uint8_t glyph_ids_size;
+    uint8_t reserved[3];
+} GlyphAtlasKernPairs;
+
+static_assert(sizeof(GlyphAtlasHeader) == 16, "atlas header layout");
+static_assert(sizeof(GlyphAtlasFont) == 52, "atlas font layout");
+static_assert(sizeof(GlyphAtlasGlyph) == 16, "atlas glyph layout");
+static_assert(sizeof(GlyphAtlasCmap) == 20, "atlas cmap layout");
+static_assert(sizeof(GlyphAtlasKernClasses) == 16, "atlas kerning layout");
+static_assert(sizeof(GlyphAtlasKernPairs) == 16, "atlas kerning layout");
+
+// Bytes of a glyph bitmap: box_w x box_h pixels, rows not padded
+inline uint32_t glyph_atlas_bitmap_bytes(uint32_t box_w, uint32_t box_h, uint32_t bpp)
+{
+    return (box_w * box_h * bpp + 7) / 8;
+}
+
+/**
+ * Fonts of a glyph atlas, ready for LVGL.
+ *
+ * open() checks the atlas and sets up an lv_font_t per font whose tables
+ * point into the atlas; nothing of the atlas is copied. The atlas has to
+ * stay in place while the fonts are in use: map_partition() keeps its
+ * mapping until close() or destruction.
+ */
+class GlyphAtlas {
+public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    // Use an atlas that is already in memory. False if it is malformed.
+    bool open(const void *data, size_t size);
+    // Memory-map the atlas in a data partition and open it
+    bool map_partition(const char *label = GLYPH_ATLAS_PARTITION);
+    void close();
+
+    // Font packed under name, nullptr if there is none
+    const lv_font_t *font(const char *name) const;
+    int font_count() const { return count; }
+    size_t size() const { return atlas_size; }
+
+private:
+    typedef struct
+    {
+        char name[GLYPH_ATLAS_NAME_LEN + 1];
+        lv_font_t font;
+        lv_font_fmt_txt_dsc_t dsc;
+        lv_font_fmt_txt_cmap_t *cmaps;
+        lv_font_fmt_txt_kern_classes_t kern_classes;
+        lv_font_fmt_txt_kern_pair_t kern_pairs;
+    } LoadedFont;
+
+    bool load_font(const GlyphAtlasFont &packed, LoadedFont *loaded);
+    bool check_range(uint32_t offset, uint64_t bytes) const;
+
+    const uint8_t *atlas;
+    size_t atlas_size;
+    LoadedFont fonts[GLYPH_ATLAS_MAX_FONTS];
+    int count;
+    uint32_t map_handle;  // esp_partition_mmap_handle_t, 0 if not mapped
+};
@@ -0,0 +1,283 @@
+#include "glyph_tile_cache.hpp"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <cstring>
+
+static const char *TAG = "TILE_CACHE";
+
+GlyphTileCache::GlyphTileCache(int capacity, int tile_width, int tile_height, lv_color_t card_color)
+    : tiles(nullptr), buckets(nullptr), pixels(nullptr), canvas(nullptr), emoji_atlas(nullptr),
+      capacity(capacity), bucket_count(capacity * 2), tile_width(tile_width), tile_height(tile_height),
+      card_color(card_color), lru_head(-1), lru_tail(-1), stats{}
+{
+}
+
+GlyphTileCache::~GlyphTileCache()
+{
+    if (canvas)
+    {
+        lv_obj_delete(canvas);
+    }
+    heap_caps_free(pixels);
+    delete[] tiles;
+    delete[] buckets;
+}
+
+bool GlyphTileCache::init(lv_obj_t *parent)
+{
+    size_t tile_bytes = (size_t)tile_width * tile_height * sizeof(uint16_t);
+    pixels = (uint8_t *)heap_caps_malloc(tile_bytes * capacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!pixels)
+    {
+        ESP_LOGE(TAG, "Failed to allocate %d tiles (%u bytes) in PSRAM", capacity, (unsigned)(tile_bytes * capacity));
+        return false;
+    }
+
+    tiles = new Tile[capacity];
+    buckets = new int16_t[bucket_count];
+    for (int i = 0; i < bucket_count; i++)
+    {
+        buckets[i] = -1;
+    }
+
+    for (int i = 0; i < capacity; i++)
+    {
+        Tile &tile = tiles[i];
+        memset(&tile, 0, sizeof(tile));
+        tile.image.header.magic = LV_IMAGE_HEADER_MAGIC;
+        tile.image.header.cf = LV_COLOR_FORMAT_RGB565;
+        tile.image.header.w = tile_width;
+        tile.image.header.h = tile_height;
+        tile.image.header.stride = tile_width * sizeof(uint16_t);
+        tile.image.data_size = tile_bytes;
+        tile.image.data = pixels + tile_bytes * i;
+        tile.top = tile.image;
+        tile.top.header.h = tile_height / 2;
+        tile.top.data_size = tile.top.header.stride * tile.top.header.h;
+        tile.bottom = tile.image;
+        tile.bottom.header.h = tile_height - tile.top.header.h;
+        tile.bottom.data_size = tile.bottom.header.stride * tile.bottom.header.h;
+        tile.bottom.data = tile.image.data + tile.top.data_size;
+        tile.hash_next = -1;
+        tile.lru_prev = -1;
+        tile.lru_next = -1;
+        lru_push_front(i);
+    }
+
+    // Off-screen canvas, only used as a render target for new tiles
+    canvas = lv_canvas_create(parent);
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+
+    ESP_LOGI(TAG, "Tile cache: %d tiles of %dx%d RGB565, %u KB PSRAM",
+             capacity, tile_width, tile_height, (unsigned)(tile_bytes * capacity / 1024));
+    return true;
+}
+
+int GlyphTileCache::bucket_of(uint32_t codepoint, uint16_t color) const
+{
+    uint32_t h = codepoint * 2654435761u ^ (uint32_t)color * 40503u;
+    return (int)(h % (uint32_t)bucket_count);
+}
+
+int GlyphTileCache::find(uint32_t codepoint, uint16_t color) const
+{
+    for (int i = buckets[bucket_of(codepoint, color)]; i >= 0; i = tiles[i].hash_next)
+    {
+        if (tiles[i].codepoint == codepoint && tiles[i].color == color)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void GlyphTileCache::hash_insert(int index)
+{
+    int b = bucket_of(tiles[index].codepoint, tiles[index].color);
+    tiles[index].hash_next = buckets[b];
+    buckets[b] = index;
+}
+
+void GlyphTileCache::hash_remove(int index)
+{
+    int b = bucket_of(tiles[index].codepoint, tiles[index].color);
+    int16_t *link = &buckets[b];
+    while (*link >= 0)
+    {
+        if (*link == index)
+        {
+            *link = tiles[index].hash_next;
+            break;
+        }
+        link = &tiles[*link].hash_next;
+    }
+    tiles[index].hash_next = -1;
+}
+
+void GlyphTileCache::lru_unlink(int index)
+{
+    Tile &tile = tiles[index];
+    if (tile.lru_prev >= 0)
+        tiles[tile.lru_prev].lru_next = tile.lru_next;
+    else
+        lru_head = tile.lru_next;
+    if (tile.lru_next >= 0)
+        tiles[tile.lru_next].lru_prev = tile.lru_prev;
+    else
+        lru_tail = tile.lru_prev;
+    tile.lru_prev = -1;
+    tile.lru_next = -1;
+}
+
+void GlyphTileCache::lru_push_front(int index)
+{
+    Tile &tile = tiles[index];
+    tile.lru_prev = -1;
+    tile.lru_next = lru_head;
+    if (lru_head >= 0)
+        tiles[lru_head].lru_prev = index;
+    lru_head = index;
+    if (lru_tail < 0)
+        lru_tail = index;
+}
+
+// Least recently used tile that is not pinned by a card on screen. Unused
+// tiles start at the tail, so they are consumed before anything is evicted.
+int GlyphTileCache::take_victim()
+{
+    for (int i = lru_tail; i >= 0; i = tiles[i].lru_prev)
+    {
+        if (tiles[i].pins == 0)
+        {
+            if (tiles[i].used)
+            {
+                hash_remove(i);
+                stats.evictions++;
+            }
+            return i;
+        }
+    }
+    return -1;
+}
+
+void GlyphTileCache::render(Tile &tile, const char *utf8, const lv_font_t *font, lv_color_t color)
+{
+    lv_canvas_set_buffer(canvas, (void *)tile.image.data, tile_width, tile_height, LV_COLOR_FORMAT_RGB565);
+    lv_canvas_fill_bg(canvas, card_color, LV_OPA_COVER);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.text = utf8;
+    dsc.font = font;
+    dsc.color = color;
+    dsc.align = LV_TEXT_ALIGN_CENTER;
+
+    // Same vertical placement as a centered label on the card
+    lv_area_t area;
+    area.x1 = 0;
+    area.x2 = tile_width - 1;
+    area.y1 = (tile_height - font->line_height) / 2;
+    area.y2 = area.y1 + font->line_height - 1;
+    lv_draw_label(&layer, &dsc, &area);
+
+    lv_canvas_finish_layer(canvas, &layer);
+    lv_image_cache_drop(&tile.image);
+    lv_image_cache_drop(&tile.top);
+    lv_image_cache_drop(&tile.bottom);
+}
+
+// Card background with the emoji image blitted into its middle, the same
+// place a centered label would put the glyph
+void GlyphTileCache::render_emoji(Tile &tile, const lv_image_dsc_t *emoji)
+{
+    int64_t start = esp_timer_get_time();
+    uint16_t *dst = (uint16_t *)tile.image.data;
+    uint16_t background = lv_color_to_u16(card_color);
+    for (int i = 0; i < tile_width * tile_height; i++)
+        dst[i] = background;
+    emoji_atlas_blit(emoji, dst, tile_width, tile_height, (tile_width - (int)emoji->header.w) / 2,
+                     (tile_height - (int)emoji->header.h) / 2);
+    stats.emoji_blits++;
+    stats.emoji_blit_us += esp_timer_get_time() - start;
+
+    lv_image_cache_drop(&tile.image);
+    lv_image_cache_drop(&tile.top);
+    lv_image_cache_drop(&tile.bottom);
+}
+
+const lv_image_dsc_t *GlyphTileCache::acquire(const char *utf8, const lv_font_t *font, lv_color_t color)
+{
+    if (!tiles || !utf8 || !font)
+        return nullptr;
+
+    uint32_t i = 0;
+    uint32_t codepoint = lv_text_encoded_next(utf8, &i);
+    uint16_t color16 = lv_color_to_u16(color);
+    // An emoji image has its own colors, one tile serves every text color
+    const lv_image_dsc_t *emoji = emoji_atlas ? emoji_atlas->find(codepoint) : nullptr;
+    if (emoji)
+        color16 = 0;
+
+    int index = find(codepoint, color16);
+    if (index >= 0)
+    {
+        stats.hits++;
+    }
+    else
+    {
+        stats.misses++;
+        index = take_victim();
+        if (index < 0)
+        {
+            stats.full++;
+            return nullptr;
+        }
+        Tile &tile = tiles[index];
+        tile.codepoint = codepoint;
+        tile.color = color16;
+        tile.used = true;
+        if (emoji)
+            render_emoji(tile, emoji);
+        else
+            render(tile, utf8, font, color);
+        hash_insert(index);
+    }
+
+    lru_unlink(index);
+    lru_push_front(index);
+    tiles[index].pins++;
+    return &tiles[index].image;
+}
+
+const GlyphTileCache::Tile *GlyphTileCache::tile_of(const lv_image_dsc_t *image) const
+{
+    const Tile *tile = (const Tile *)image;
+    if (!image || !tiles || tile < tiles || tile >= tiles + capacity)
+        return nullptr;
+    return tile;
+}
+
+void GlyphTileCache::release(const lv_image_dsc_t *image)
+{
+    Tile *tile = (Tile *)tile_of(image);
+    if (tile && tile->pins > 0)
+    {
+        tile->pins--;
+    }
+}
+
+const lv_image_dsc_t *GlyphTileCache::top_half(const lv_image_dsc_t *image) const
+{
+    const Tile *tile = tile_of(image);
+    return tile ? &tile->top : nullptr;
+}
+
+const lv_image_dsc_t *GlyphTileCache::bottom_half(const lv_image_dsc_t *image) const
+{
+    const Tile *tile = tile_of(image);
+    return tile ? &tile->bottom : nullptr;
+}
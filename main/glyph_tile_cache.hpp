@@ -0,0 +1,93 @@
+#pragma once
+
+#include "lvgl.h"
+#include "emoji_atlas.hpp"
+#include <stdint.h>
+
+// Hit/miss counters of the tile cache
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t full;        // acquire() failed because every tile was pinned
+    uint32_t emoji_blits; // tiles made from an emoji atlas image
+    uint64_t emoji_blit_us;
+} GlyphTileCacheStats;
+
+/**
+ * Cache of fully composited card images.
+ *
+ * Each tile is a card-sized RGB565 image (card background + glyph in its
+ * color) rendered once through an off-screen canvas and kept in PSRAM. Tiles
+ * are keyed by (codepoint, RGB565 color) and evicted least-recently-used.
+ * A tile handed out by acquire() stays pinned until release(), so a card on
+ * screen never loses its pixels. Every tile also comes with its top and
+ * bottom half as images of their own, for the split-flap renderer; they
+ * share the tile's pixels and are ready as soon as the tile is.
+ * With an EmojiAtlas attached, emoji it has are alpha-blitted into the tile
+ * in their own colors instead of being rendered from the font; the blit is
+ * paid once per tile, not per frame.
+ */
+class GlyphTileCache {
+public:
+    GlyphTileCache(int capacity, int tile_width, int tile_height, lv_color_t card_color);
+    ~GlyphTileCache();
+
+    // Allocate the tile pool and the off-screen canvas used to rasterize tiles
+    bool init(lv_obj_t *parent);
+    // Color emoji for the tiles, call before the first acquire()
+    void set_emoji_atlas(const EmojiAtlas *atlas) { emoji_atlas = atlas; }
+
+    // Return the pinned tile for glyph/color, rendering it on a miss.
+    // Returns nullptr if the cache is not initialized or all tiles are pinned.
+    const lv_image_dsc_t *acquire(const char *utf8, const lv_font_t *font, lv_color_t color);
+    void release(const lv_image_dsc_t *image);
+
+    // Upper tile_height / 2 rows and the rest of a tile from acquire(),
+    // valid while it is pinned; nullptr for nullptr
+    const lv_image_dsc_t *top_half(const lv_image_dsc_t *image) const;
+    const lv_image_dsc_t *bottom_half(const lv_image_dsc_t *image) const;
+
+    const GlyphTileCacheStats &get_stats() const { return stats; }
+
+private:
+    typedef struct
+    {
+        lv_image_dsc_t image;   // must stay first, release() maps image -> tile
+        lv_image_dsc_t top;     // views into image's pixels
+        lv_image_dsc_t bottom;
+        uint32_t codepoint;
+        uint16_t color;
+        uint16_t pins;
+        int16_t hash_next;      // next tile in the same bucket
+        int16_t lru_prev;       // towards most recently used
+        int16_t lru_next;       // towards least recently used
+        bool used;
+    } Tile;
+
+    int find(uint32_t codepoint, uint16_t color) const;
+    int take_victim();
+    void render(Tile &tile, const char *utf8, const lv_font_t *font, lv_color_t color);
+    void render_emoji(Tile &tile, const lv_image_dsc_t *emoji);
+    void hash_insert(int index);
+    void hash_remove(int index);
+    void lru_unlink(int index);
+    void lru_push_front(int index);
+    int bucket_of(uint32_t codepoint, uint16_t color) const;
+    const Tile *tile_of(const lv_image_dsc_t *image) const;
+
+    Tile *tiles;
+    int16_t *buckets;
+    uint8_t *pixels;
+    lv_obj_t *canvas;
+    const EmojiAtlas *emoji_atlas;
+    int capacity;
+    int bucket_count;
+    int tile_width;
+    int tile_height;
+    lv_color_t card_color;
+    int16_t lru_head;
+    int16_t lru_tail;
+    GlyphTileCacheStats stats;
+};
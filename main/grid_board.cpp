@@ -1,6 +1,10 @@
 #include "grid_board.hpp"
 #include "esp_log.h"
 #include "esp_random.h"
+#include "esp_timer.h"
+#include "flip_timeline.hpp"
+#include "text_layout.hpp"
+#include "utf8_segment.hpp"
 #include <algorithm>
 #include <random>
 #include <cstring>
@@ -8,15 +12,42 @@
 static const char *TAG = "LVGL";
 
 // Static character sets
-const char *GridBoard::card_chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.,:;!?@#$%&*()-+=/\\\"'<>[]{}|_^~ °±•…×÷−≠≤≥€£¥™®©";
+const char *GridBoard::card_chars[] = {
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K",
+    "L", "M", "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z", ".", ",", ":", ";", "!", "?",
+    "@", "#", "$", "%", "&", "*", "(", ")", "-", "+", "=", "/", "\\", "\"", "'", "<", ">", "[", "]", "{", "}",
+    "|", "_", "^", "~", " ", "°", "±", "•", "…", "×", "÷", "−", "≠", "≤", "≥", "€", "£", "¥", "™", "®", "©"};
 const char *GridBoard::emoji_chars[] = {
-    "✅", "✔", "✖", "❌", "❤", "️", "📀", "📁", "📂", "📃", "📄", "📅", "📆", "📇", "📈", "📉", "📊", "📋", "📌", "📍", "📎", "📏", "📐", "📑", "📒", "📓", "📔", "📕", "📖", "📗", "📘", "📙", "📚", "📛", "📜", "📝", "📞", "📟", "📠", "📡", "📢", "📣", "📤", "📥", "📦", "📧", "📨", "📩", "📪", "📫", "📬", "📭", "📮", "📯", "📰", "📱", "📲", "📳", "📴", "📵", "📶", "📷", "📸", "📹", "📺", "📻", "📼", "📽", "📿", "😀", "😁", "😂", "😃", "😄", "😅", "😆", "😇", "😈", "😉", "😊", "😋", "😌", "😍", "😎", "😏", "😐", "😑", "😒", "😓", "😔", "😕", "😖", "😗", "😘", "😙", "😚", "😛", "😜", "😝", "😞", "😟", "😠", "😡", "😢", "😣", "😤", "😥", "😦", "😧", "😨", "😩", "😪", "😫", "😬", "😭", "😮", "😯", "😰", "😱", "😲", "😳", "😴", "😵", "😶", "😷", "😸", "😹", "😺", "😻", "😼", "😽", "😾", "😿", "🙀", "🙁", "🙂", "🙃", "🙄", "🙅", "🙆", "🙇", "🙈", "🙉", "🙊", "🙋", "🙌", "🙍", "🙎", "🙏", "🚀", "🚁", "🚂", "🚃", "🚄", "🚅", "🚆", "🚇", "🚈", "🚉", "🚊", "🚋", "🚌", "🚍", "🚎", "🚏", "🚐", "🚑", "🚒", "🚓", "🚔", "🚕", "🚖", "🚗", "🚘", "🚙", "🚚", "🚛", "🚜", "🚝", "🚞", "🚟", "🚠", "🚡", "🚢", "🚣", "🚤", "🚥", "🚦", "🚧", "🚨", "🚩", "🚪", "🚫", "🚬", "🚭", "🚮", "🚯", "🚰", "🚱", "🚲", "🚳", "🚴", "🚵", "🚶", "🚷", "🚸", "🚹", "🚺", "🚻", "🚼", "🚽", "🚾", "🚿", "🛀", "🛁", "🛂", "🛃", "🛄", "🛅", "🛋", "🛌", "🛍", "🛎", "🛏", "🛐", "🛑", "🛒", "🛕", "🛖", "🛗", "🛜", "🛝", "🛞", "🛟", "🛠", "🛡", "🛢", "🛣", "🛤", "🛥", "🛩", "🛫", "🛬", "🛰", "🛳", "🛴", "🛵", "🛶", "🛷", "🛸", "🛹", "🛺", "🛻", "🛼"};
+    "✅", "✔", "✖", "❌", "❤", "📀", "📁", "📂", "📃", "📄", "📅", "📆", "📇", "📈", "📉", "📊", "📋", "📌", "📍", "📎", "📏", "📐", "📑", "📒", "📓", "📔", "📕", "📖", "📗", "📘", "📙", "📚", "📛", "📜", "📝", "📞", "📟", "📠", "📡", "📢", "📣", "📤", "📥", "📦", "📧", "📨", "📩", "📪", "📫", "📬", "📭", "📮", "📯", "📰", "📱", "📲", "📳", "📴", "📵", "📶", "📷", "📸", "📹", "📺", "📻", "📼", "📽", "📿", "😀", "😁", "😂", "😃", "😄", "😅", "😆", "😇", "😈", "😉", "😊", "😋", "😌", "😍", "😎", "😏", "😐", "😑", "😒", "😓", "😔", "😕", "😖", "😗", "😘", "😙", "😚", "😛", "😜", "😝", "😞", "😟", "😠", "😡", "😢", "😣", "😤", "😥", "😦", "😧", "😨", "😩", "😪", "😫", "😬", "😭", "😮", "😯", "😰", "😱", "😲", "😳", "😴", "😵", "😶", "😷", "😸", "😹", "😺", "😻", "😼", "😽", "😾", "😿", "🙀", "🙁", "🙂", "🙃", "🙄", "🙅", "🙆", "🙇", "🙈", "🙉", "🙊", "🙋", "🙌", "🙍", "🙎", "🙏", "🚀", "🚁", "🚂", "🚃", "🚄", "🚅", "🚆", "🚇", "🚈", "🚉", "🚊", "🚋", "🚌", "🚍", "🚎", "🚏", "🚐", "🚑", "🚒", "🚓", "🚔", "🚕", "🚖", "🚗", "🚘", "🚙", "🚚", "🚛", "🚜", "🚝", "🚞", "🚟", "🚠", "🚡", "🚢", "🚣", "🚤", "🚥", "🚦", "🚧", "🚨", "🚩", "🚪", "🚫", "🚬", "🚭", "🚮", "🚯", "🚰", "🚱", "🚲", "🚳", "🚴", "🚵", "🚶", "🚷", "🚸", "🚹", "🚺", "🚻", "🚼", "🚽", "🚾", "🚿", "🛀", "🛁", "🛂", "🛃", "🛄", "🛅", "🛋", "🛌", "🛍", "🛎", "🛏", "🛐", "🛑", "🛒", "🛕", "🛖", "🛗", "🛜", "🛝", "🛞", "🛟", "🛠", "🛡", "🛢", "🛣", "🛤", "🛥", "🛩", "🛫", "🛬", "🛰", "🛳", "🛴", "🛵", "🛶", "🛷", "🛸", "🛹", "🛺", "🛻", "🛼"};
 
 const int GridBoard::total_emoji_cards = sizeof(GridBoard::emoji_chars) / sizeof(GridBoard::emoji_chars[0]);
-const int GridBoard::total_cards = strlen(GridBoard::card_chars);
+const int GridBoard::total_cards = sizeof(GridBoard::card_chars) / sizeof(GridBoard::card_chars[0]);
 
-static std::random_device rd;
-static std::mt19937 g(rd());
+// Index of text in a candidate table, -1 if missing. Only used while parsing.
+static int find_glyph(const char *const *table, int count, const char *text)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(table[i], text) == 0)
+            return i;
+    }
+    return -1;
+}
+
+const int GridBoard::heart_emoji_index = find_glyph(GridBoard::emoji_chars, GridBoard::total_emoji_cards, "❤");
+
+#ifdef GRID_BOARD_NO_BUILTIN_FONTS
+// Until set_fonts() gets the atlas fonts, LVGL's default keeps cards readable
+static const lv_font_t *const builtin_fonts[GLYPH_FONT_COUNT] = {LV_FONT_DEFAULT, LV_FONT_DEFAULT};
+#else
+static const lv_font_t *const builtin_fonts[GLYPH_FONT_COUNT] = {&ShareTech140, &NotoEmoji64};
+#endif
+
+// Card text colors. A fixed palette instead of arbitrary RGB keeps the number
+// of distinct (glyph, color) tiles small enough to cache.
+const uint32_t GridBoard::card_palette[] = {
+    0xFF6B6B, 0xFFB84D, 0xFFE066, 0x8CE99A, 0x66D9E8, 0x74C0FC, 0xB197FC, 0xF783AC};
+const int GridBoard::total_palette_colors = sizeof(GridBoard::card_palette) / sizeof(GridBoard::card_palette[0]);
 
 static GridBoard *g_grid_instance = nullptr;
 
@@ -25,93 +56,220 @@ GridBoard *get_grid_board_instance()
     return g_grid_instance;
 }
 
-// Utility function for typographic quotes replacement
-static void replace_typographic_quotes(char *str)
+// One transition per candidate, at the effect's own pace
+static FlipTimelineConfig flip_config(const GridLayout &layout, CardTransition transition)
 {
-    if (!str)
-        return;
-    unsigned char *p = (unsigned char *)str;
-    char *out = str;
-    while (*p)
+    return {
+        transition,
+        {layout.slot_width, layout.slot_height},
+        card_transition_duration(transition),
+        FLIP_STEP_MS,
+    };
+}
+
+GridBoard::GridBoard()
+    : geometry(grid_geometry(GRID_LAYOUT_12X5)), timeline(GRID_MAX_CELLS, flip_config(GRID_LAYOUT_12X5, CARD_TRANSITION_DROP)),
+      rng(esp_random()), running_animations(0),
+      start_card_flip_sound_task(nullptr), stop_card_flip_sound_task(nullptr)
+{
+    for (int row = 0; row < GRID_MAX_ROWS; row++)
     {
-        // UTF-8 for ' (U+2018): 0xE2 0x80 0x98
-        if (p[0] == 0xE2 && p[1] == 0x80 && p[2] == 0x98)
-        {
-            *out++ = '\'';
-            p += 3;
-        }
-        // UTF-8 for ' (U+2019): 0xE2 0x80 0x99
-        else if (p[0] == 0xE2 && p[1] == 0x80 && p[2] == 0x99)
-        {
-            *out++ = '\'';
-            p += 3;
-        }
-        else
+        for (int col = 0; col < GRID_MAX_COLS; col++)
         {
-            *out++ = *p++;
+            slots[row][col] = nullptr;
+            cards[row][col] = nullptr;
+            labels[row][col] = nullptr;
+            card_text[row][col] = "";
+            board_cells[row][col][0] = '\0';
+            card_pose[row][col] = CARD_POSE_REST;
+            memset(&flip_slots[row][col], 0, sizeof(GridCharacterSlot));
+            flip_slots[row][col].row = row;
+            flip_slots[row][col].col = col;
         }
     }
-    *out = 0;
+    for (int i = 0; i < GLYPH_FONT_COUNT; i++)
+    {
+        glyph_fonts[i] = builtin_fonts[i];
+    }
+    timeline.set_listener(this);
+    g_grid_instance = this;
 }
 
-// UTF-8 helper function
-static uint32_t utf8_next(const char **txt)
+GridBoard::~GridBoard()
 {
-    const unsigned char *ptr = (const unsigned char *)(*txt);
-    uint32_t codepoint = 0;
-
-    if (*ptr < 0x80)
+    if (flip_timer)
     {
-        codepoint = *ptr;
-        (*txt)++;
+        lv_timer_delete(flip_timer);
     }
-    else if ((*ptr & 0xE0) == 0xC0)
+    if (message_timer)
     {
-        codepoint = ((*ptr & 0x1F) << 6) | (*(ptr + 1) & 0x3F);
-        (*txt) += 2;
+        lv_timer_delete(message_timer);
     }
-    else if ((*ptr & 0xF0) == 0xE0)
+    if (marquee_timer)
     {
-        codepoint = ((*ptr & 0x0F) << 12) | ((*(ptr + 1) & 0x3F) << 6) | (*(ptr + 2) & 0x3F);
-        (*txt) += 3;
+        lv_timer_delete(marquee_timer);
     }
-    else if ((*ptr & 0xF8) == 0xF0)
+    delete widget;
+    delete flap_renderer;
+    delete tile_cache;
+    if (g_grid_instance == this)
     {
-        codepoint = ((*ptr & 0x07) << 18) | ((*(ptr + 1) & 0x3F) << 12) |
-                    ((*(ptr + 2) & 0x3F) << 6) | (*(ptr + 3) & 0x3F);
-        (*txt) += 4;
+        g_grid_instance = nullptr;
     }
-    else
+}
+
+void GridBoard::set_layout(const GridLayout &layout)
+{
+    if (!grid_layout_valid(layout))
+    {
+        ESP_LOGE(TAG, "Layout %s (%dx%d) does not fit its %dx%d screen", layout.name, layout.cols,
+                 layout.rows, layout.screen_width, layout.screen_height);
+        return;
+    }
+    if (widget || slots[0][0])
     {
-        codepoint = *ptr;
-        (*txt)++;
+        ESP_LOGW(TAG, "Layout must be set before initialize(), keeping %s", geometry.layout.name);
+        return;
     }
-    return codepoint;
+
+    geometry = grid_geometry(layout);
+    timeline.set_config(flip_config(layout, transition));
 }
 
-GridBoard::GridBoard() : running_animations(0), start_card_flip_sound_task(nullptr), stop_card_flip_sound_task(nullptr)
+void GridBoard::set_fonts(const lv_font_t *text, const lv_font_t *emoji)
 {
-    for (int row = 0; row < GRID_ROWS; row++)
+    if (widget || slots[0][0])
     {
-        for (int col = 0; col < GRID_COLS; col++)
-        {
-            slots[row][col] = nullptr;
-        }
+        ESP_LOGW(TAG, "Fonts must be set before initialize()");
+        return;
     }
-    g_grid_instance = this;
+    glyph_fonts[GLYPH_FONT_TEXT] = text ? text : builtin_fonts[GLYPH_FONT_TEXT];
+    glyph_fonts[GLYPH_FONT_EMOJI] = emoji ? emoji : builtin_fonts[GLYPH_FONT_EMOJI];
 }
 
-GridBoard::~GridBoard()
+void GridBoard::set_emoji_atlas(const EmojiAtlas *atlas)
 {
-    if (g_grid_instance == this)
+    if (widget || slots[0][0])
     {
-        g_grid_instance = nullptr;
+        ESP_LOGW(TAG, "Emoji atlas must be set before initialize()");
+        return;
     }
+    emoji_atlas = atlas;
+}
+
+void GridBoard::set_transition(CardTransition transition)
+{
+    if (timeline.active_count() > 0)
+    {
+        ESP_LOGW(TAG, "Transition cannot change while cards move, keeping %s",
+                 card_transition_name(this->transition));
+        return;
+    }
+
+    // Once the board exists, the split-flap look has to have its tiles
+    bool created = widget || slots[0][0];
+    if (transition == CARD_TRANSITION_FLAP && created && !create_flap_renderer())
+    {
+        ESP_LOGW(TAG, "Split-flap transition needs widget mode with a tile cache, keeping %s",
+                 card_transition_name(this->transition));
+        return;
+    }
+
+    this->transition = transition;
+    timeline.set_config(flip_config(geometry.layout, transition));
+    ESP_LOGI(TAG, "Card transition: %s, %u ms", card_transition_name(transition),
+             (unsigned)card_transition_duration(transition));
 }
 
 void GridBoard::initialize(lv_obj_t *parent)
 {
-    create_grid(parent);
+    const GridLayout &layout = geometry.layout;
+    ESP_LOGI(TAG, "Grid layout %s: %dx%d slots of %dx%d px on %dx%d", layout.name, layout.cols, layout.rows,
+             layout.slot_width, layout.slot_height, layout.screen_width, layout.screen_height);
+    lv_obj_set_style_bg_color(parent, lv_color_hex(0x1A1A1A), 0);
+
+    if (render_mode == GRID_RENDER_WIDGET)
+    {
+        widget = new BoardWidget(geometry);
+        widget->set_emoji_atlas(emoji_atlas);
+        widget->create(parent);
+        stats.lv_allocations++;
+
+        if (tile_cache_size > 0)
+        {
+            tile_cache = new GlyphTileCache(tile_cache_size, layout.slot_width, layout.slot_height,
+                                            lv_color_hex(BOARD_CARD_BG_COLOR));
+            tile_cache->set_emoji_atlas(emoji_atlas);
+            if (tile_cache->init(parent))
+            {
+                widget->set_tile_cache(tile_cache);
+                stats.lv_allocations++;
+            }
+            else
+            {
+                delete tile_cache;
+                tile_cache = nullptr;
+            }
+        }
+    }
+    else
+    {
+        create_grid(parent);
+    }
+
+    if (transition == CARD_TRANSITION_FLAP && !create_flap_renderer())
+    {
+        ESP_LOGW(TAG, "Split-flap transition needs widget mode with a tile cache, using drop");
+        set_transition(CARD_TRANSITION_DROP);
+    }
+
+    // One timer drives every card animation; it sleeps while the board is idle
+    flip_timer = lv_timer_create(flip_timer_callback, FLIP_STEP_MS, this);
+    lv_timer_pause(flip_timer);
+    stats.lv_allocations++;
+
+    // Marquee steps run on their own timer, also asleep until a marquee starts
+    marquee_timer = lv_timer_create(marquee_timer_callback, scroll_step_ms, this);
+    lv_timer_pause(marquee_timer);
+    stats.lv_allocations++;
+
+    // Messages from other tasks are taken over on the LVGL side. The timer
+    // sleeps while the queue is empty, take_messages() wakes it.
+    if (message_queue)
+    {
+        message_timer = lv_timer_create(message_timer_callback, MESSAGE_POLL_MS, this);
+        stats.lv_allocations++;
+    }
+
+    // Time every render pass of the display so both modes can be compared
+    lv_display_t *disp = lv_obj_get_display(parent);
+    if (disp)
+    {
+        lv_display_add_event_cb(disp, render_event_callback, LV_EVENT_RENDER_START, this);
+        lv_display_add_event_cb(disp, render_event_callback, LV_EVENT_RENDER_READY, this);
+    }
+    ESP_LOGI(TAG, "Grid board initialized in %s mode",
+             render_mode == GRID_RENDER_WIDGET ? "widget" : "object-tree");
+}
+
+bool GridBoard::create_flap_renderer()
+{
+    if (flap_renderer)
+        return true;
+    if (!widget || !tile_cache)
+        return false;
+
+    const GridLayout &layout = geometry.layout;
+    flap_renderer = new SplitFlapRenderer(layout.cols * layout.rows, layout.slot_width, layout.slot_height,
+                                          lv_color_hex(BOARD_CARD_BG_COLOR));
+    if (!flap_renderer->init())
+    {
+        delete flap_renderer;
+        flap_renderer = nullptr;
+        return false;
+    }
+    widget->set_flap_renderer(flap_renderer);
+    return true;
 }
 
 void GridBoard::set_sound_callback(void (*on_start)(), void (*on_end)())
@@ -120,22 +278,108 @@ void GridBoard::set_sound_callback(void (*on_start)(), void (*on_end)())
     stop_card_flip_sound_task = on_end;
 }
 
-void GridBoard::create_grid(lv_obj_t *parent)
+void GridBoard::set_random_seed(uint32_t seed)
 {
-    lv_obj_set_style_bg_color(parent, lv_color_hex(0x1A1A1A), 0);
-    int total_width = GRID_COLS * GRID_SLOT_WIDTH + (GRID_COLS - 1) * GRID_GAP;
-    int total_height = GRID_ROWS * GRID_SLOT_HEIGHT + (GRID_ROWS - 1) * GRID_GAP;
-    int x_start = (GRID_SCREEN_WIDTH - total_width) / 2;
-    int y_start = (GRID_SCREEN_HEIGHT - total_height) / 2;
+    rng.seed(seed);
+}
 
-    for (int row = 0; row < GRID_ROWS; row++)
+void GridBoard::flip_timer_callback(lv_timer_t *t)
+{
+    GridBoard *board = (GridBoard *)lv_timer_get_user_data(t);
+    uint32_t elapsed = lv_tick_elaps(board->last_flip_tick);
+    board->last_flip_tick += elapsed;
+    board->advance_animations(elapsed);
+}
+
+void GridBoard::advance_animations(uint32_t elapsed_ms)
+{
+    timeline.advance(elapsed_ms);
+    if (timeline.active_count() == 0 && flip_timer)
+    {
+        lv_timer_pause(flip_timer);
+    }
+}
+
+// Wake the message timer and let it run on the next lv_timer_handler()
+void GridBoard::take_messages()
+{
+    if (!message_timer)
+        return;
+    lv_timer_resume(message_timer);
+    lv_timer_ready(message_timer);
+}
+
+// Show the next queued message once the board is idle. Interrupts are
+// handed out by the queue even while cards are still flipping. A marquee
+// counts as idle once its text went through at least once.
+void GridBoard::message_timer_callback(lv_timer_t *t)
+{
+    GridBoard *board = (GridBoard *)lv_timer_get_user_data(t);
+    bool idle = !board->is_animation_running() && (!board->marquee_active || board->marquee_passes > 0);
+    bool taken = board->message_queue->pop(&board->incoming, idle);
+    // A message waiting for the board keeps the timer polling until it is idle
+    if (board->message_queue->size() == 0)
+        lv_timer_pause(t);
+    if (!taken)
+        return;
+
+    ESP_LOGI(TAG, "Message #%lu (%s), waited %lld us in queue", (unsigned long)board->incoming.seq,
+             board->incoming.policy == BOARD_MSG_INTERRUPT ? "interrupt" : "queued",
+             (long long)(esp_timer_get_time() - board->incoming.enqueue_us));
+    board->stats.messages++;
+    // Latency is taken at the first frame showing the message; an identical
+    // message changes nothing and renders no frame
+    if (board->process_text_and_animate(std::string(board->incoming.text, board->incoming.len)) > 0)
+    {
+        board->first_frame_pending_us = board->incoming.enqueue_us;
+    }
+}
+
+void GridBoard::render_event_callback(lv_event_t *e)
+{
+    GridBoard *board = (GridBoard *)lv_event_get_user_data(e);
+    int64_t now = esp_timer_get_time();
+
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START)
+    {
+        board->render_start_us = now;
+        return;
+    }
+
+    uint32_t elapsed = (uint32_t)(now - board->render_start_us);
+    board->stats.frames++;
+    board->stats.render_time_us += elapsed;
+    if (elapsed > board->stats.render_time_max_us)
     {
-        for (int col = 0; col < GRID_COLS; col++)
+        board->stats.render_time_max_us = elapsed;
+    }
+
+    if (board->first_frame_pending_us)
+    {
+        uint32_t latency = (uint32_t)(now - board->first_frame_pending_us);
+        board->first_frame_pending_us = 0;
+        board->stats.msg_latency_last_us = latency;
+        if (latency > board->stats.msg_latency_max_us)
         {
-            int x = x_start + col * (GRID_SLOT_WIDTH + GRID_GAP);
-            int y = y_start + row * (GRID_SLOT_HEIGHT + GRID_GAP);
+            board->stats.msg_latency_max_us = latency;
+        }
+        ESP_LOGI(TAG, "Message latency: %lu us from post to first frame (max %lu us)",
+                 (unsigned long)latency, (unsigned long)board->stats.msg_latency_max_us);
+    }
+}
+
+void GridBoard::create_grid(lv_obj_t *parent)
+{
+    const GridLayout &layout = geometry.layout;
+    for (int row = 0; row < layout.rows; row++)
+    {
+        for (int col = 0; col < layout.cols; col++)
+        {
+            int x = geometry.x0 + geometry.col_x[col];
+            int y = geometry.y0 + geometry.row_y[row];
             lv_obj_t *slot = lv_obj_create(parent);
-            lv_obj_set_size(slot, GRID_SLOT_WIDTH, GRID_SLOT_HEIGHT);
+            stats.lv_allocations++;
+            lv_obj_set_size(slot, layout.slot_width, layout.slot_height);
             lv_obj_set_pos(slot, x, y);
             lv_obj_clear_flag(slot, LV_OBJ_FLAG_SCROLLABLE);
             lv_obj_set_layout(slot, LV_LAYOUT_NONE);
@@ -145,60 +389,129 @@ void GridBoard::create_grid(lv_obj_t *parent)
             lv_obj_set_style_bg_color(slot, lv_color_hex(0x2A2A2A), 0);
             lv_obj_set_style_radius(slot, 0, 0);
             slots[row][col] = slot;
+            cards[row][col] = create_card(slot, row, col);
         }
     }
 }
 
-lv_obj_t *GridBoard::create_card(lv_obj_t *slot, const char *text, const lv_font_t *font)
+// Build the pooled card for a slot once. All styles that later flips touch
+// (text, font, color, emoji image) are set here so their local style entries already exist
+// and updating them never allocates.
+lv_obj_t *GridBoard::create_card(lv_obj_t *slot, int row, int col)
 {
-    if (slot == nullptr)
-    {
-        ESP_LOGE(TAG, "Attempted to create card on NULL slot for '%s'", text);
-        return nullptr;
-    }
-
     lv_obj_t *card = lv_obj_create(slot);
-    lv_obj_set_size(card, GRID_SLOT_WIDTH, GRID_SLOT_HEIGHT);
+    stats.lv_allocations++;
+    lv_obj_set_size(card, geometry.layout.slot_width, geometry.layout.slot_height);
     lv_obj_clear_flag(card, LV_OBJ_FLAG_SCROLLABLE);
 
-    lv_obj_set_style_bg_color(card, lv_color_hex(0x121212), 0);
+    lv_obj_set_style_bg_color(card, lv_color_hex(BOARD_CARD_BG_COLOR), 0);
     lv_obj_set_style_border_width(card, 0, 0);
     lv_obj_set_style_radius(card, 0, 0);
     lv_obj_set_style_pad_all(card, 0, 0);
-    lv_obj_align(card, LV_ALIGN_TOP_MID, 0, -GRID_SLOT_HEIGHT);
+    lv_obj_set_style_opa(card, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_image_src(card, nullptr, 0);
+    lv_obj_set_pos(card, 0, 0);
+    lv_obj_add_flag(card, LV_OBJ_FLAG_HIDDEN);
 
     lv_obj_t *label = lv_label_create(card);
+    stats.lv_allocations++;
+    // Static text: the label points at card_text[row][col] instead of owning a copy
+    lv_label_set_text_static(label, card_text[row][col]);
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_obj_set_style_text_font(label, glyph_fonts[GLYPH_FONT_TEXT], 0);
+    lv_obj_center(label);
 
-    lv_label_set_text(label, text);
+    labels[row][col] = label;
+    return card;
+}
 
-    // Set emoji color
-    if (strcmp(text, "❤") == 0 || strcmp(text, "❤️") == 0)
+// text must stay valid while it is on the card: a candidate table entry or
+// the target text of the cell's slot
+void GridBoard::show_card(int row, int col, const char *text, const lv_font_t *font, lv_color_t color)
+{
+    card_text[row][col] = text;
+
+    if (widget)
     {
-        lv_obj_set_style_text_color(label, lv_color_hex(0xFF4444), 0); // Red heart
+        widget->set_cell(row, col, text, font, color);
+        return;
     }
-    else if (font == &ShareTech140)
+
+    lv_obj_t *card = cards[row][col];
+    lv_obj_t *label = labels[row][col];
+    if (card == nullptr || label == nullptr)
     {
-        // Random color for other emojis
-        uint8_t r = esp_random() % 200 + 55;
-        uint8_t g = esp_random() % 200 + 55;
-        uint8_t b = esp_random() % 200 + 55;
-        lv_obj_set_style_text_color(label, lv_color_make(r, g, b), 0);
+        ESP_LOGE(TAG, "Attempted to show card on NULL slot for '%s'", text);
+        return;
     }
-    else
+
+    // A color emoji is the card's background image, centered like the label
+    uint32_t i = 0;
+    const lv_image_dsc_t *emoji = emoji_atlas ? emoji_atlas->find(lv_text_encoded_next(text, &i)) : nullptr;
+    lv_obj_set_style_bg_image_src(card, emoji, 0);
+    lv_label_set_text_static(label, emoji ? "" : text);
+    lv_obj_set_style_text_color(label, color, 0);
+    lv_obj_set_style_text_font(label, font, 0);
+    lv_obj_center(label);
+    lv_obj_clear_flag(card, LV_OBJ_FLAG_HIDDEN);
+}
+
+// The widget redraws only the dirty part of the slot; pooled card objects
+// are invalidated by LVGL itself
+void GridBoard::set_card_pose(int row, int col, const CardPose &pose, const SlotRect *dirty)
+{
+    CardPose &current = card_pose[row][col];
+    if (widget)
     {
-        lv_obj_set_style_text_color(label, lv_color_white(), 0);
+        widget->set_cell_pose(row, col, pose, dirty);
     }
+    else if (cards[row][col])
+    {
+        lv_obj_t *card = cards[row][col];
+        if (pose.x != current.x || pose.y != current.y)
+        {
+            lv_obj_set_pos(card, pose.x, pose.y);
+        }
+        if (pose.opa != current.opa)
+        {
+            lv_obj_set_style_opa(card, pose.opa, 0);
+        }
+        if (pose.cut != current.cut)
+        {
+            // The card clips its label; keep the label where it rests
+            lv_obj_set_width(card, geometry.layout.slot_width - pose.cut);
+            lv_obj_align(labels[row][col], LV_ALIGN_CENTER, pose.cut / 2, 0);
+        }
+    }
+    current = pose;
+}
 
-    lv_obj_center(label);
-    lv_obj_set_style_text_font(label, font, 0);
+void GridBoard::hide_card(int row, int col)
+{
+    if (flip_slots[row][col].active)
+    {
+        timeline.cancel(row * GRID_MAX_COLS + col);
+        flip_slots[row][col].active = false;
+        running_animations--;
+    }
+    card_text[row][col] = "";
 
-    return card;
+    if (widget)
+    {
+        widget->clear_cell(row, col);
+        card_pose[row][col] = CARD_POSE_REST;
+    }
+    else if (cards[row][col])
+    {
+        lv_obj_add_flag(cards[row][col], LV_OBJ_FLAG_HIDDEN);
+        set_card_pose(row, col, CARD_POSE_REST);
+    }
 }
 
 bool GridBoard::is_emoji(const char *utf8_char)
 {
-    const char *tmp = utf8_char;
-    uint32_t cp = utf8_next(&tmp);
+    uint32_t cp;
+    utf8_decode(utf8_char, strlen(utf8_char), &cp);
     return (
         (cp >= 0x1F600 && cp <= 0x1F64F) ||
         (cp >= 0x1F680 && cp <= 0x1F6FF) ||
@@ -215,377 +528,873 @@ void GridBoard::utf8_to_upper_ascii(char *utf8_char)
     }
 }
 
-int GridBoard::utf8_char_len(unsigned char c)
+// Hand a cell to the timeline. The timeline repeats the transition until
+// on_flip_landed() reports that the card settled.
+void GridBoard::animate_card_to_slot(GridCharacterSlot *info, int delay_ms)
 {
-    if ((c & 0x80) == 0x00)
-        return 1; // ASCII
-    if ((c & 0xE0) == 0xC0)
-        return 2; // 2-byte UTF-8
-    if ((c & 0xF0) == 0xE0)
-        return 3; // 3-byte UTF-8
-    if ((c & 0xF8) == 0xF0)
-        return 4; // 4-byte UTF-8
-    return 1;     // fallback
+    set_card_pose(info->row, info->col, timeline.pose_at(0));
+    if (widget)
+    {
+        widget->set_cell_phase(info->row, info->col, BOARD_CELL_MOVING);
+    }
+
+    if (timeline.active_count() == 0)
+    {
+        last_flip_tick = lv_tick_get();
+    }
+    timeline.start(info->row * GRID_MAX_COLS + info->col, delay_ms);
+    if (flip_timer)
+    {
+        lv_timer_resume(flip_timer);
+    }
 }
 
-void GridBoard::animate_card_to_slot(lv_obj_t *card, const char *target)
+void GridBoard::on_flip_start(int cell)
 {
     if (start_card_flip_sound_task)
     {
         start_card_flip_sound_task();
     }
+}
 
-    lv_anim_t a;
-    lv_anim_init(&a);
-    lv_anim_set_var(&a, card);
-    lv_anim_set_exec_cb(&a, (lv_anim_exec_xcb_t)lv_obj_set_y);
-    lv_anim_set_time(&a, 333);
-    lv_coord_t start_y = -GRID_SLOT_HEIGHT * 2;
-    lv_coord_t end_y = GRID_SLOT_HEIGHT * 1.2; // go beyond bottom
-
-    lv_anim_set_values(&a, start_y, end_y);
-    lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
-    lv_anim_set_ready_cb(&a, animation_ready_callback);
+bool GridBoard::on_flip_landed(int cell)
+{
+    GridCharacterSlot *info = &flip_slots[cell / GRID_MAX_COLS][cell % GRID_MAX_COLS];
+    if (!info->active)
+        return true;
 
-    lv_anim_start(&a);
+    return on_card_dropped(info);
 }
 
-void GridBoard::animation_ready_callback(lv_anim_t *a)
+void GridBoard::on_flip_move(int cell, const CardPose &pose, const SlotRect &dirty)
 {
-    lv_obj_t *card = (lv_obj_t *)a->var;
-    lv_obj_set_y(card, 0); // reset to top before next retry
+    set_card_pose(cell / GRID_MAX_COLS, cell % GRID_MAX_COLS, pose, &dirty);
+}
 
-    GridBoard *instance = get_grid_board_instance();
-    if (instance)
+// Show a slot's target character as a resting card
+void GridBoard::settle_card(int row, int col)
+{
+    const GridCharacterSlot &slot = flip_slots[row][col];
+    const GlyphDescriptor &glyph = slot.glyph;
+    const char *text = slot.utf8_char;
+    if (glyph.target_index >= 0)
+    {
+        text = glyph.table == GLYPH_TABLE_EMOJI ? emoji_chars[glyph.target_index] : card_chars[glyph.target_index];
+    }
+    show_card(row, col, text, glyph_fonts[glyph.font], glyph_color(glyph.color));
+    set_card_pose(row, col, CARD_POSE_REST);
+    if (widget)
     {
-        instance->on_card_dropped(card);
+        widget->set_cell_phase(row, col, BOARD_CELL_SETTLED);
     }
 }
 
-void GridBoard::on_card_dropped(lv_obj_t *card)
+// Settle a card on its target character
+void GridBoard::finish_card(GridCharacterSlot *slot_info)
 {
-    if (!card)
-        return;
-
-    lv_obj_t *slot = lv_obj_get_parent(card);
-    GridCharacterSlot *slot_info = (GridCharacterSlot *)lv_obj_get_user_data(card);
-    if (!slot_info || !slot)
-        return;
-
-    const char *target = slot_info->utf8_char;
-    const char *txt = lv_label_get_text(lv_obj_get_child(card, 0));
-    if (!target || !txt)
-        return;
-
-    const int MAX_RETRY_PER_CARD = 30;
+    running_animations--;
+    stats.settled++;
+    settle_card(slot_info->row, slot_info->col);
+    slot_info->active = false;
 
-    // 1. If match: show final static card, finish
-    if (strcmp(txt, target) == 0)
+    if (running_animations <= 0 && queue_length == 0)
     {
-        running_animations--;
-        lv_obj_t *final_card;
-        if (is_emoji(target))
+        if (stop_card_flip_sound_task)
         {
-            final_card = create_card(slot, target, &NotoEmoji64);
+            stop_card_flip_sound_task();
         }
-        else
+        ESP_LOGI(TAG, "Board settled: %lu flips, %lu LVGL allocations so far",
+                 (unsigned long)stats.flips, (unsigned long)stats.lv_allocations);
+        if (stats.frames > 0)
         {
-            final_card = create_card(slot, target, &ShareTech140);
+            ESP_LOGI(TAG, "Render (%s, %d draw units): %lu frames, avg %lu us, max %lu us",
+                     widget ? "widget" : "object-tree", LV_DRAW_SW_DRAW_UNIT_CNT, (unsigned long)stats.frames,
+                     (unsigned long)(stats.render_time_us / stats.frames),
+                     (unsigned long)stats.render_time_max_us);
         }
-        lv_obj_set_y(final_card, 0);
-        delete slot_info;
-        lv_obj_del(card);
-
-        if (running_animations <= 0 && animation_queue.empty())
+        if (tile_cache)
         {
-
-            if (stop_card_flip_sound_task)
+            const GlyphTileCacheStats &cs = tile_cache->get_stats();
+            ESP_LOGI(TAG, "Tile cache: %lu hits, %lu misses, %lu evictions",
+                     (unsigned long)cs.hits, (unsigned long)cs.misses, (unsigned long)cs.evictions);
+            if (cs.emoji_blits > 0)
             {
-                stop_card_flip_sound_task();
+                ESP_LOGI(TAG, "Emoji tiles: %lu blits, avg %lu us per cell",
+                         (unsigned long)cs.emoji_blits, (unsigned long)(cs.emoji_blit_us / cs.emoji_blits));
             }
         }
-        start_animation_batch();
-
-        return;
-    }
-
-    // 2. If retry count exceeded: force correct answer and finish
-    if (slot_info->retry_index > MAX_RETRY_PER_CARD)
-    {
-        running_animations--;
-        lv_obj_t *final_card;
-        if (is_emoji(target))
+        if (flap_renderer)
         {
-            final_card = create_card(slot, target, &NotoEmoji64);
+            const SplitFlapStats &fs = flap_renderer->get_stats();
+            ESP_LOGI(TAG, "Split flaps: %lu composed (%llu rows, %llu us), %lu reused",
+                     (unsigned long)fs.composed, (unsigned long long)fs.rows,
+                     (unsigned long long)fs.compose_time_us, (unsigned long)fs.reused);
         }
-        else
+        if (settled_callback)
         {
-            final_card = create_card(slot, target, &ShareTech140);
+            settled_callback(settled_arg);
         }
-        lv_obj_set_y(final_card, 0);
-        delete slot_info;
-        lv_obj_del(card);
+    }
+    start_animation_batch();
+}
 
-        if (running_animations <= 0 && animation_queue.empty())
-        {
+// Bijective mix of a 2^bits domain, keyed by seed
+static uint32_t mix_index(uint32_t x, uint32_t mask, uint32_t seed)
+{
+    x = (x * ((seed | 1) & mask)) & mask;
+    x = (x + (seed >> 8)) & mask;
+    x ^= x >> 3;
+    x = (x * 0x9E3779B1u) & mask;
+    x ^= x >> 2;
+    return x;
+}
 
-            if (stop_card_flip_sound_task)
+// index-th element of a seeded permutation of [0, n), computed without any
+// table. The mix permutes the next power of two; values outside [0, n) are
+// walked along the cycle until they land inside, which takes fewer than two
+// rounds on average.
+static int permute_index(uint32_t index, uint32_t n, uint32_t seed)
+{
+    uint32_t mask = 1;
+    while (mask < n)
+    {
+        mask <<= 1;
+    }
+    mask--;
+
+    uint32_t x = index % n;
+    do
+    {
+        x = mix_index(x, mask, seed);
+    } while (x >= n);
+    return (int)x;
+}
+
+// Show the next candidate of the cell's seeded order on its card
+void GridBoard::show_candidate(GridCharacterSlot *slot_info)
+{
+    if (slot_info->glyph.table == GLYPH_TABLE_EMOJI)
+    {
+        int i = permute_index(slot_info->retry_index, total_emoji_cards, slot_info->order_seed);
+        slot_info->shown = i;
+        show_card(slot_info->row, slot_info->col, emoji_chars[i], glyph_fonts[GLYPH_FONT_EMOJI],
+                  glyph_color(i == heart_emoji_index ? GLYPH_COLOR_HEART : GLYPH_COLOR_WHITE));
+    }
+    else
+    {
+        int i = permute_index(slot_info->retry_index, total_cards, slot_info->order_seed);
+        slot_info->shown = i;
+        show_card(slot_info->row, slot_info->col, card_chars[i], glyph_fonts[GLYPH_FONT_TEXT],
+                  glyph_color(rng() % total_palette_colors));
+    }
+}
+
+lv_color_t GridBoard::glyph_color(uint8_t color_id) const
+{
+    if (color_id == GLYPH_COLOR_HEART)
+        return lv_color_hex(0xFF4444); // Red heart
+    if (color_id == GLYPH_COLOR_WHITE)
+        return lv_color_white();
+    return lv_color_hex(card_palette[color_id]);
+}
+
+// Font, candidate table and index of a cell's target. Emoji get their fixed
+// color, text is left white for the caller to color.
+void GridBoard::lookup_glyph(const char *utf8, GlyphDescriptor *glyph)
+{
+    utf8_decode(utf8, strlen(utf8), &glyph->codepoint);
+
+    if (is_emoji(utf8))
+    {
+        glyph->font = GLYPH_FONT_EMOJI;
+        glyph->table = GLYPH_TABLE_EMOJI;
+        glyph->target_index = find_glyph(emoji_chars, total_emoji_cards, utf8);
+        glyph->color = glyph->codepoint == 0x2764 ? GLYPH_COLOR_HEART : GLYPH_COLOR_WHITE;
+    }
+    else
+    {
+        glyph->font = GLYPH_FONT_TEXT;
+        glyph->table = GLYPH_TABLE_CHARS;
+        glyph->target_index = find_glyph(card_chars, total_cards, utf8);
+        glyph->color = GLYPH_COLOR_WHITE;
+    }
+}
+
+// Resolve a cell's target once: font, candidate table, its index there and
+// the color it settles in
+void GridBoard::resolve_glyph(const char *utf8, GlyphDescriptor *glyph)
+{
+    lookup_glyph(utf8, glyph);
+    if (glyph->table == GLYPH_TABLE_CHARS)
+    {
+        glyph->color = rng() % total_palette_colors;
+    }
+}
+
+// FNV-1a over both candidate tables
+uint32_t GridBoard::glyph_table_signature()
+{
+    uint32_t hash = 2166136261u;
+    auto add = [&hash](const char *const *table, int count) {
+        for (int i = 0; i < count; i++)
+        {
+            for (const char *p = table[i]; ; p++)
             {
-                stop_card_flip_sound_task();
+                hash = (hash ^ (uint8_t)*p) * 16777619u;
+                if (!*p)
+                    break;
             }
         }
+    };
+    add(card_chars, total_cards);
+    add(emoji_chars, total_emoji_cards);
+    return hash;
+}
 
-        start_animation_batch();
-        return;
+// Returns true if the card settled, false if it keeps spinning
+bool GridBoard::on_card_dropped(GridCharacterSlot *slot_info)
+{
+    if (!slot_info)
+        return true;
+
+    const int MAX_RETRY_PER_CARD = 30;
+
+    // 1. If match: show final static card, finish
+    // 2. If retry count exceeded: force correct answer and finish
+    if (slot_info->shown == slot_info->glyph.target_index || slot_info->retry_index > MAX_RETRY_PER_CARD)
+    {
+        finish_card(slot_info);
+        return true;
     }
 
-    // 3. Not matched, keep spinning with next candidate
-    lv_obj_del(card);
-    lv_obj_t *next_card;
-    if (is_emoji(target))
+    // 3. Not matched, keep spinning with next candidate on the same card
+    show_candidate(slot_info);
+    slot_info->retry_index++;
+    stats.flips++;
+
+    if (start_card_flip_sound_task)
+    {
+        start_card_flip_sound_task();
+    }
+    return false;
+}
+
+void GridBoard::start_animation_batch()
+{
+    while (running_animations < max_parallel && queue_length > 0)
     {
-        // Use per-slot shuffled emoji order if present, otherwise random
-        if (!slot_info->shuffled_emojis.empty())
+        int cell = animation_queue[--queue_length];
+        GridCharacterSlot *info = &flip_slots[cell / GRID_MAX_COLS][cell % GRID_MAX_COLS];
+
+        if (!widget && !cards[info->row][info->col])
         {
-            int i = slot_info->retry_index % slot_info->shuffled_emojis.size();
-            next_card = create_card(slot, slot_info->shuffled_emojis[i], &NotoEmoji64);
+            continue;
         }
-        else
+
+        hide_card(info->row, info->col);
+        info->active = true;
+        running_animations++;
+
+        show_candidate(info);
+        info->retry_index++;
+
+        int delay_ms = (rng() % 200) + 100; // between 100–300ms delay
+        animate_card_to_slot(info, delay_ms);
+    }
+}
+
+bool GridBoard::is_animation_running() const
+{
+    return running_animations > 0 || queue_length > 0;
+}
+
+void GridBoard::clear_display()
+{
+    queue_length = 0;
+
+    // Clear grid: hide the pooled cards, nothing is deleted
+    for (int row = 0; row < geometry.layout.rows; row++)
+    {
+        for (int col = 0; col < geometry.layout.cols; col++)
         {
-            next_card = create_card(slot, emoji_chars[esp_random() % total_emoji_cards], &NotoEmoji64);
+            hide_card(row, col);
+            board_cells[row][col][0] = '\0';
         }
     }
+    running_animations = 0;
+}
+
+// Split text into board cells, at most max_cells
+int GridBoard::split_characters(const std::string &text, Utf8Cell *cells, int max_cells)
+{
+    Utf8SegmentStats seg_stats = {};
+    int count = utf8_segment(text.data(), text.size(), cells, max_cells, &seg_stats);
+    if (seg_stats.invalid_bytes > 0)
+    {
+        ESP_LOGW(TAG, "Skipped %lu malformed UTF-8 bytes", (unsigned long)seg_stats.invalid_bytes);
+    }
+    return count;
+}
+
+// Place the message on an empty grid, word-wrapped and aligned by
+// text_layout(). Returns true if it does not fit the board and was cut off.
+bool GridBoard::layout_text(const std::string &new_text, char layout[GRID_MAX_ROWS][GRID_MAX_COLS][8])
+{
+    const int rows = geometry.layout.rows;
+    const int cols = geometry.layout.cols;
+    memset(layout, 0, sizeof(char) * GRID_MAX_ROWS * GRID_MAX_COLS * 8);
+
+    // One cell more than can fit tells that the text overflows
+    const int max_cells = rows * cols + rows;
+    int count = split_characters(new_text, text_cells, max_cells + 1);
+    TextLayoutResult placed = text_layout(text_cells, count > max_cells ? max_cells : count, cols, rows, text_align,
+                                          text_positions);
+    for (int i = 0; i < count && i < max_cells; i++)
+    {
+        if (text_positions[i] == TEXT_LAYOUT_HIDDEN)
+            continue;
+        int row = text_positions[i] / cols;
+        int col = text_positions[i] % cols;
+        to_physical(row, col);
+        memcpy(layout[row][col], text_cells[i].text, text_cells[i].len + 1);
+    }
+    return placed.overflow || count > max_cells;
+}
+
+// Queue the spin animation of one cell towards its target character. The
+// glyph is resolved here unless the message was compiled.
+void GridBoard::queue_cell(int row, int col, const char *utf8, const GlyphDescriptor *glyph)
+{
+    GridCharacterSlot &slot = flip_slots[row][col];
+    strncpy(slot.utf8_char, utf8, sizeof(slot.utf8_char) - 1);
+    slot.utf8_char[sizeof(slot.utf8_char) - 1] = '\0';
+    slot.active = false;
+    if (glyph)
+    {
+        slot.glyph = *glyph;
+    }
     else
     {
-        // Use per-slot shuffled char order if present, otherwise random
-        if (!slot_info->shuffled_chars.empty())
-        {
-            int i = slot_info->retry_index % slot_info->shuffled_chars.size();
-            char buf[2] = {slot_info->shuffled_chars[i], '\0'};
-            next_card = create_card(slot, buf, &ShareTech140);
-        }
-        else
+        resolve_glyph(slot.utf8_char, &slot.glyph);
+    }
+    slot.shown = -1;
+    slot.order_seed = rng();
+    slot.retry_index = rng() % total_cards;
+
+    animation_queue[queue_length++] = row * GRID_MAX_COLS + col;
+}
+
+// Remove a cell from the pending queue, keeping the order of the others
+void GridBoard::remove_queued(int row, int col)
+{
+    int cell = row * GRID_MAX_COLS + col;
+    int out = 0;
+    for (int i = 0; i < queue_length; i++)
+    {
+        if (animation_queue[i] != cell)
         {
-            int i = slot_info->retry_index % total_cards;
-            char buf[2] = {card_chars[i], '\0'};
-            next_card = create_card(slot, buf, &ShareTech140);
+            animation_queue[out++] = animation_queue[i];
         }
     }
-    slot_info->retry_index++;
+    queue_length = out;
+}
+
+// Diff one cell against the logical board. Unchanged cells are not touched at
+// all, even if they are still spinning towards the same character. Returns
+// true if the cell changed.
+bool GridBoard::update_cell(int row, int col, const char *utf8, const GlyphDescriptor *glyph)
+{
+    // Spaces are static/transparent: the slot's card stays hidden
+    const char *target = (strcmp(utf8, " ") == 0) ? "" : utf8;
+    if (strcmp(board_cells[row][col], target) == 0)
+        return false;
 
-    lv_obj_set_user_data(next_card, slot_info);
-    animate_card_to_slot(next_card, target);
+    strncpy(board_cells[row][col], target, sizeof(board_cells[row][col]) - 1);
+    board_cells[row][col][sizeof(board_cells[row][col]) - 1] = '\0';
+
+    // Drop a pending or running animation towards the old character
+    remove_queued(row, col);
+    hide_card(row, col);
+
+    if (target[0] != '\0')
+    {
+        queue_cell(row, col, target, glyph);
+    }
+    return true;
 }
 
-void GridBoard::timer_callback(lv_timer_t *t)
+// Map viewer coordinates to slot coordinates on an inverted board
+void GridBoard::to_physical(int &row, int &col) const
 {
-    lv_obj_t *card = (lv_obj_t *)lv_timer_get_user_data(t);
-    GridCharacterSlot *info = (GridCharacterSlot *)lv_obj_get_user_data(card);
+    if (m_inverted)
+    {
+        row = (geometry.layout.rows - 1) - row;
+        col = (geometry.layout.cols - 1) - col;
+    }
+}
+
+void GridBoard::set_cell(int row, int col, const char *utf8)
+{
+    if (row < 0 || row >= geometry.layout.rows || col < 0 || col >= geometry.layout.cols || !utf8)
+        return;
 
-    GridBoard *instance = get_grid_board_instance();
-    if (instance)
+    stop_marquee();
+    to_physical(row, col);
+    if (update_cell(row, col, utf8))
     {
-        instance->animate_card_to_slot(card, info->utf8_char);
+        start_animation_batch();
     }
-    lv_timer_del(t);
 }
 
-void GridBoard::start_animation_batch()
+void GridBoard::set_cells(int row, int col, const std::string &text)
 {
-    while (running_animations < MAX_PARALLEL_ANIMATIONS && !animation_queue.empty())
+    if (row < 0 || row >= geometry.layout.rows || col < 0 || col >= geometry.layout.cols)
+        return;
+
+    stop_marquee();
+
+    // Consecutive cells in reading order, wrapping onto the next row
+    const int cols = geometry.layout.cols;
+    int index = row * cols + col;
+    Utf8Cell *characters = text_cells;
+    int count = split_characters(text, characters, grid_layout_cells(geometry.layout) - index);
+    for (int i = 0; i < count; i++, index++)
     {
-        GridCharacterSlot slot_info = animation_queue.back();
-        animation_queue.pop_back();
-        running_animations++;
+        int r = index / cols;
+        int c = index % cols;
+        to_physical(r, c);
+        update_cell(r, c, characters[i].text);
+    }
+    start_animation_batch();
+}
 
-        GridCharacterSlot *info = new GridCharacterSlot(slot_info); // allocate per-slot
+const char *GridBoard::get_cell(int row, int col) const
+{
+    if (row < 0 || row >= geometry.layout.rows || col < 0 || col >= geometry.layout.cols)
+        return "";
 
-        lv_obj_t *slot = slots[info->row][info->col];
-        if (!slot)
-        {
-            delete info;
-            continue;
-        }
+    to_physical(row, col);
+    if (marquee_active)
+    {
+        return board_cells[marquee_ring_row(row)][marquee_ring_col(col)];
+    }
+    return board_cells[row][col];
+}
 
-        lv_obj_t *card;
-        if (is_emoji(info->utf8_char))
-        {
-            card = create_card(slot, emoji_chars[esp_random() % total_emoji_cards], &NotoEmoji64);
-        }
-        else
+std::string GridBoard::get_snapshot() const
+{
+    std::string cells;
+    if (marquee_active)
+        return cells;
+
+    for (int row = 0; row < geometry.layout.rows; row++)
+    {
+        for (int col = 0; col < geometry.layout.cols; col++)
         {
-            int i = info->retry_index++ % total_cards;
-            char buf[2] = {card_chars[i], '\0'};
-            card = create_card(slot, buf, &ShareTech140);
+            const char *text = get_cell(row, col);
+            cells += text[0] ? text : " ";
         }
+    }
+    return cells;
+}
 
-        lv_obj_set_user_data(card, info);
+void GridBoard::show_snapshot(const std::string &cells)
+{
+    stop_marquee();
+    clear_display();
 
-        int delay_ms = (esp_random() % 200) + 100; // between 100–300ms delay
+    const int cols = geometry.layout.cols;
+    Utf8Cell *characters = text_cells;
+    int count = split_characters(cells, characters, grid_layout_cells(geometry.layout));
+    int shown = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (characters[i].codepoint == ' ')
+            continue;
 
-        lv_timer_t *timer = lv_timer_create_basic();
-        lv_timer_set_repeat_count(timer, 1); // one-shot
-        lv_timer_set_period(timer, delay_ms);
-        lv_timer_set_user_data(timer, card);
-        lv_timer_set_cb(timer, timer_callback);
+        int row = i / cols;
+        int col = i % cols;
+        to_physical(row, col);
+        GridCharacterSlot &slot = flip_slots[row][col];
+        memcpy(board_cells[row][col], characters[i].text, characters[i].len + 1);
+        memcpy(slot.utf8_char, characters[i].text, characters[i].len + 1);
+        resolve_glyph(slot.utf8_char, &slot.glyph);
+        settle_card(row, col);
+        shown++;
     }
+    ESP_LOGI(TAG, "Snapshot shown: %d cards", shown);
 }
 
-bool GridBoard::is_animation_running() const
+int GridBoard::compile_message(const GridLayout &layout, const std::string &text, CompiledCell *cells,
+                               uint32_t color_seed, bool *overflow, TextAlign align)
 {
-    return running_animations > 0 || !animation_queue.empty();
+    const int max_cells = grid_layout_cells(layout) + layout.rows;
+    std::vector<Utf8Cell> characters(max_cells + 1);
+    std::vector<int16_t> positions(max_cells);
+    int text_length = utf8_segment(text.data(), text.size(), characters.data(), max_cells + 1);
+    TextLayoutResult placed = text_layout(characters.data(), text_length > max_cells ? max_cells : text_length,
+                                          layout.cols, layout.rows, align, positions.data());
+    if (overflow)
+    {
+        *overflow = placed.overflow || text_length > max_cells;
+    }
+
+    std::mt19937 colors(color_seed);
+    int count = 0;
+    for (int i = 0; i < text_length && i < max_cells; i++)
+    {
+        const Utf8Cell &cell = characters[i];
+        if (positions[i] == TEXT_LAYOUT_HIDDEN || cell.codepoint == ' ')
+            continue;
+
+        CompiledCell &out = cells[count++];
+        out.row = positions[i] / layout.cols;
+        out.col = positions[i] % layout.cols;
+        memcpy(out.utf8, cell.text, cell.len + 1);
+        lookup_glyph(out.utf8, &out.glyph);
+        if (out.glyph.table == GLYPH_TABLE_CHARS)
+        {
+            out.glyph.color = colors() % total_palette_colors;
+        }
+    }
+    return count;
 }
 
-void GridBoard::clear_display()
+int GridBoard::show_compiled(const CompiledCell *cells, int count)
 {
-    animation_queue.clear();
-    running_animations = 0;
+    int64_t start_us = esp_timer_get_time();
+    stop_marquee();
 
-    // Clear grid
-    for (int row = 0; row < GRID_ROWS; row++)
+    const int rows = geometry.layout.rows;
+    const int cols = geometry.layout.cols;
+    for (int row = 0; row < rows; row++)
     {
-        for (int col = 0; col < GRID_COLS; col++)
+        for (int col = 0; col < cols; col++)
         {
-            if (slots[row][col])
+            next_cells[row][col][0] = '\0';
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int row = cells[i].row;
+        int col = cells[i].col;
+        if (row >= rows || col >= cols)
+            continue;
+        to_physical(row, col);
+        memcpy(next_cells[row][col], cells[i].utf8, sizeof(cells[i].utf8));
+        next_glyphs[row][col] = cells[i].glyph;
+    }
+
+    int changed = 0;
+    for (int row = 0; row < rows; row++)
+    {
+        for (int col = 0; col < cols; col++)
+        {
+            if (update_cell(row, col, next_cells[row][col], &next_glyphs[row][col]))
             {
-                lv_obj_clean(slots[row][col]);
+                changed++;
             }
         }
     }
+    std::shuffle(animation_queue, animation_queue + queue_length, rng);
+    start_animation_batch();
+
+    ESP_LOGI(TAG, "Compiled message: %d of %d cells changed, queued in %lld us",
+             changed, grid_layout_cells(geometry.layout), (long long)(esp_timer_get_time() - start_us));
+    return changed;
 }
 
-void GridBoard::process_text_and_animate(const std::string &new_text)
+int GridBoard::process_text_and_animate(const std::string &new_text)
 {
-    clear_display();
-
     if (new_text.empty())
     {
         ESP_LOGI(TAG, "New text is empty, clearing display.");
-        return;
+        int cleared = 0;
+        for (int row = 0; row < geometry.layout.rows; row++)
+        {
+            for (int col = 0; col < geometry.layout.cols; col++)
+            {
+                if (board_cells[row][col][0] != '\0')
+                    cleared++;
+            }
+        }
+        stop_marquee();
+        clear_display();
+        return cleared;
     }
 
-    // Parse text into UTF8 characters first
-    std::vector<std::string> characters;
-    int i = 0;
-    while (i < new_text.size())
+    int64_t start_us = esp_timer_get_time();
+    stop_marquee();
+    bool overflow = layout_text(new_text, next_cells);
+    if (overflow && long_text_mode == GRID_LONG_TEXT_SCROLL)
     {
-        int char_len = utf8_char_len((unsigned char)new_text[i]);
-        if (char_len < 1 || i + char_len > new_text.size())
-            break;
-        
-        char utf8[8] = {0};
-        memcpy(utf8, &new_text[i], char_len);
-        replace_typographic_quotes(utf8);
-        characters.push_back(std::string(utf8));
-        i += char_len;
-    }
-
-    // If inverted, reverse the character order for proper 180-degree display
-    if (m_inverted) {
-        std::reverse(characters.begin(), characters.end());
-    }
-
-    int text_length = characters.size();
-    
-    // Calculate centering position
-    int total_slots = GRID_ROWS * GRID_COLS;
-    int start_position = (total_slots - text_length) / 2;
-    
-    // Center vertically and horizontally
-    int center_row = GRID_ROWS / 2;
-    int text_rows = (text_length + GRID_COLS - 1) / GRID_COLS;  // Rows needed for text
-    int start_row = (GRID_ROWS - text_rows) / 2;
-    
-    // If text fits in one row, center it horizontally
-    if (text_length <= GRID_COLS) {
-        start_position = start_row * GRID_COLS + (GRID_COLS - text_length) / 2;
-    } else {
-        // Multi-row text, start from beginning of centered row
-        start_position = start_row * GRID_COLS;
-    }
-
-    int actual_char_index = start_position;
-    for (size_t char_idx = 0; char_idx < characters.size() && actual_char_index < GRID_ROWS * GRID_COLS; char_idx++)
-    {
-        const std::string& utf8_str = characters[char_idx];
-        char utf8[8] = {0};
-        memcpy(utf8, utf8_str.c_str(), utf8_str.size());
-
-        int row = actual_char_index / GRID_COLS;
-        int col = actual_char_index % GRID_COLS;
-        
-        // Invert position if needed for 180-degree rotation
-        if (m_inverted) {
-            row = (GRID_ROWS - 1) - row;
-            col = (GRID_COLS - 1) - col;
-        }
-        
-        actual_char_index++;
-
-        GridCharacterSlot slot{};
-        memcpy(slot.utf8_char, utf8, sizeof(slot.utf8_char));
-        slot.row = row;
-        slot.col = col;
-        slot.retry_index = esp_random() % total_cards;
+        // Every cell the marquee runs through counts as changed
+        start_marquee(new_text, long_text_direction);
+        return long_text_direction == GRID_SCROLL_LEFT ? geometry.layout.cols : grid_layout_cells(geometry.layout);
+    }
 
-        // Spaces are static/transparent
-        if (strcmp(slot.utf8_char, " ") == 0)
+    // Only cells whose character changed spin; the rest keep their card
+    int changed = 0;
+    for (int row = 0; row < geometry.layout.rows; row++)
+    {
+        for (int col = 0; col < geometry.layout.cols; col++)
         {
-            if (slots[row][col])
+            if (update_cell(row, col, next_cells[row][col]))
             {
-                lv_obj_t *space_card = lv_obj_create(slots[row][col]);
-                lv_obj_set_size(space_card, GRID_SLOT_WIDTH, GRID_SLOT_HEIGHT);
-                lv_obj_clear_flag(space_card, LV_OBJ_FLAG_SCROLLABLE);
-                lv_obj_set_style_bg_opa(space_card, LV_OPA_TRANSP, 0);
-                lv_obj_set_style_border_width(space_card, 0, 0);
-                lv_obj_set_y(space_card, 0);
+                changed++;
             }
-            continue;
         }
+    }
+    std::shuffle(animation_queue, animation_queue + queue_length, rng);
+    start_animation_batch();
+
+    ESP_LOGI(TAG, "Message diff: %d of %d cells changed, queued in %lld us",
+             changed, grid_layout_cells(geometry.layout), (long long)(esp_timer_get_time() - start_us));
+    return changed;
+}
+
+void GridBoard::set_long_text_mode(GridLongTextMode mode, GridScrollDirection direction)
+{
+    long_text_mode = mode;
+    long_text_direction = direction;
+}
+
+void GridBoard::set_scroll_speed(int steps_per_second)
+{
+    if (steps_per_second < 1)
+        steps_per_second = 1;
+    if (steps_per_second > 100)
+        steps_per_second = 100;
+    scroll_step_ms = 1000 / steps_per_second;
+    if (marquee_timer)
+    {
+        lv_timer_set_period(marquee_timer, scroll_step_ms);
+    }
+}
+
+// The marquee starts on a blank board; its text enters from the right (or the
+// bottom) and loops with one board width of blank space in between
+void GridBoard::start_marquee(const std::string &text, GridScrollDirection direction)
+{
+    stop_marquee();
+    clear_display();
+    if (text.empty())
+        return;
+
+    marquee_text = text;
+    marquee_direction = direction;
+    marquee_pos = 0;
+    marquee_trailer = 0;
+    marquee_row_offset = 0;
+    marquee_col_offset = 0;
+    marquee_passes = 0;
+    marquee_pending_ms = 0;
+    marquee_active = true;
+
+    if (marquee_timer)
+    {
+        last_marquee_tick = lv_tick_get();
+        lv_timer_resume(marquee_timer);
+    }
+    ESP_LOGI(TAG, "Marquee: %u bytes scrolling %s, %lu ms per step", (unsigned)marquee_text.size(),
+             direction == GRID_SCROLL_LEFT ? "left" : "up", (unsigned long)scroll_step_ms);
+}
+
+void GridBoard::stop_marquee()
+{
+    if (!marquee_active)
+        return;
+
+    marquee_active = false;
+    if (marquee_timer)
+    {
+        lv_timer_pause(marquee_timer);
+    }
+    clear_display();
+    marquee_row_offset = 0;
+    marquee_col_offset = 0;
+    if (widget)
+    {
+        widget->set_scroll_offset(0, 0);
+    }
+    ESP_LOGI(TAG, "Marquee stopped after %lu passes, %lu steps", (unsigned long)marquee_passes,
+             (unsigned long)stats.scroll_steps);
+}
 
-        // Prepare animation sequence for letters/emojis
-        if (is_emoji(slot.utf8_char))
+void GridBoard::marquee_timer_callback(lv_timer_t *t)
+{
+    GridBoard *board = (GridBoard *)lv_timer_get_user_data(t);
+    uint32_t elapsed = lv_tick_elaps(board->last_marquee_tick);
+    board->last_marquee_tick += elapsed;
+    board->advance_marquee(elapsed);
+}
+
+// Steps write cells into the ring only; the slots are brought up to date once
+// per call, however many steps were due
+void GridBoard::advance_marquee(uint32_t elapsed_ms)
+{
+    if (!marquee_active)
+        return;
+
+    marquee_pending_ms += elapsed_ms;
+    uint32_t steps = marquee_pending_ms / scroll_step_ms;
+    marquee_pending_ms -= steps * scroll_step_ms;
+
+    // After a stall, catch up by at most one board width instead of a burst
+    uint32_t max_steps = marquee_direction == GRID_SCROLL_LEFT ? geometry.layout.cols : geometry.layout.rows;
+    if (steps > max_steps)
+    {
+        steps = max_steps;
+    }
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        marquee_step();
+    }
+    if (steps > 0)
+    {
+        refresh_marquee_slots();
+    }
+}
+
+// Next cell of the marquee text, segmented on demand so the cost of a step
+// does not depend on the length of the text
+bool GridBoard::next_marquee_cell(Utf8Cell *cell)
+{
+    while (marquee_pos < marquee_text.size())
+    {
+        size_t used = 0;
+        int n = utf8_segment_next(marquee_text.data() + marquee_pos, marquee_text.size() - marquee_pos,
+                                  cell, 1, &used);
+        marquee_pos += used;
+        if (n == 1)
+            return true;
+        if (used == 0)
+            break;
+    }
+    return false;
+}
+
+// Rotate the ring by one column (left) or row (up) and write the cells that
+// come into view into the ring entries that just left it
+void GridBoard::marquee_step()
+{
+    const int rows = geometry.layout.rows;
+    const int cols = geometry.layout.cols;
+    const Utf8Cell blank = {" ", 1, ' '};
+
+    Utf8Cell line[GRID_MAX_COLS];
+    int count = marquee_direction == GRID_SCROLL_LEFT ? 1 : cols;
+    int filled = 0;
+    bool got_text = false;
+    Utf8Cell cell;
+    while (filled < count && next_marquee_cell(&cell))
+    {
+        got_text = true;
+        if (cell.codepoint == '\n' && marquee_direction == GRID_SCROLL_UP)
+            break;  // the rest of the line stays blank
+        line[filled++] = cell.codepoint < 0x20 ? blank : cell;
+    }
+    for (int i = filled; i < count; i++)
+    {
+        line[i] = blank;
+    }
+
+    // Past the end of the text: blank steps until it has left the board,
+    // then it starts over
+    if (!got_text && ++marquee_trailer >= (marquee_direction == GRID_SCROLL_LEFT ? cols : rows))
+    {
+        marquee_trailer = 0;
+        marquee_pos = 0;
+        marquee_passes++;
+    }
+
+    if (marquee_direction == GRID_SCROLL_LEFT)
+    {
+        int row = (rows - 1) / 2;
+        int col = cols - 1;
+        to_physical(row, col);
+        marquee_col_offset = m_inverted ? (marquee_col_offset + cols - 1) % cols : (marquee_col_offset + 1) % cols;
+        put_marquee_cell(marquee_ring_row(row), marquee_ring_col(col), line[0]);
+    }
+    else
+    {
+        marquee_row_offset = m_inverted ? (marquee_row_offset + rows - 1) % rows : (marquee_row_offset + 1) % rows;
+        for (int i = 0; i < cols; i++)
         {
-            std::vector<const char *> emojis(emoji_chars, emoji_chars + total_emoji_cards);
-            std::shuffle(emojis.begin(), emojis.end(), g);
-            slot.shuffled_emojis = emojis;
+            int row = rows - 1;
+            int col = i;
+            to_physical(row, col);
+            put_marquee_cell(marquee_ring_row(row), marquee_ring_col(col), line[i]);
         }
-        else
+    }
+    stats.scroll_steps++;
+}
+
+// row, col address the ring. The glyph is resolved here, once per cell that
+// enters the board, and never again while the cell scrolls through.
+void GridBoard::put_marquee_cell(int row, int col, const Utf8Cell &cell)
+{
+    char *text = board_cells[row][col];
+    if (cell.codepoint == ' ')
+    {
+        text[0] = '\0';
+        if (widget)
         {
-            std::vector<char> chars(card_chars, card_chars + total_cards);
-            std::shuffle(chars.begin(), chars.end(), g);
-            slot.shuffled_chars = chars;
+            widget->clear_cell(row, col);
         }
+        return;
+    }
+
+    memcpy(text, cell.text, cell.len + 1);
+    GlyphDescriptor &glyph = flip_slots[row][col].glyph;
+    resolve_glyph(text, &glyph);
+    if (widget)
+    {
+        // The widget's cell array is the ring itself
+        widget->set_cell(row, col, text, glyph_fonts[glyph.font], glyph_color(glyph.color));
+    }
+}
 
-        animation_queue.push_back(slot);
+// Show the rotated ring. The widget only needs the new offset; in the object
+// tree each slot of the scrolling area points its label at the ring cell it
+// now shows.
+void GridBoard::refresh_marquee_slots()
+{
+    if (widget)
+    {
+        widget->set_scroll_offset(marquee_row_offset, marquee_col_offset);
+        return;
     }
 
-    // Fill all empty slots with static blank (including before text for centering)
-    for (int slot_idx = 0; slot_idx < GRID_ROWS * GRID_COLS; slot_idx++)
+    const int rows = geometry.layout.rows;
+    const int cols = geometry.layout.cols;
+    int first_row = 0;
+    int last_row = rows - 1;
+    if (marquee_direction == GRID_SCROLL_LEFT)
     {
-        int row = slot_idx / GRID_COLS;
-        int col = slot_idx % GRID_COLS;
-        
-        // Check if this slot is already used
-        bool slot_used = false;
-        for (const auto& anim : animation_queue) {
-            if (anim.row == row && anim.col == col) {
-                slot_used = true;
-                break;
-            }
-        }
-        
-        if (!slot_used && slots[row][col])
+        int col = 0;
+        first_row = (rows - 1) / 2;
+        to_physical(first_row, col);
+        last_row = first_row;
+    }
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+        int ring_row = marquee_ring_row(row);
+        for (int col = 0; col < cols; col++)
         {
-            lv_obj_t *space_card = lv_obj_create(slots[row][col]);
-            lv_obj_set_size(space_card, GRID_SLOT_WIDTH, GRID_SLOT_HEIGHT);
-            lv_obj_clear_flag(space_card, LV_OBJ_FLAG_SCROLLABLE);
-            lv_obj_set_style_bg_opa(space_card, LV_OPA_TRANSP, 0);
-            lv_obj_set_style_border_width(space_card, 0, 0);
-            lv_obj_set_y(space_card, 0);
+            int ring_col = marquee_ring_col(col);
+            const char *text = board_cells[ring_row][ring_col];
+            if (text[0] == '\0')
+            {
+                if (card_text[row][col][0] != '\0')
+                {
+                    hide_card(row, col);
+                }
+                continue;
+            }
+            const GlyphDescriptor &glyph = flip_slots[ring_row][ring_col].glyph;
+            show_card(row, col, text, glyph_fonts[glyph.font], glyph_color(glyph.color));
         }
     }
-
-    std::shuffle(animation_queue.begin(), animation_queue.end(), g);
-    start_animation_batch();
 }
@@ -1,88 +1,345 @@
 #pragma once
 
 #include "lvgl.h"
+#include "board_widget.hpp"
+#include "card_transition.hpp"
+#include "emoji_atlas.hpp"
+#include "flip_timeline.hpp"
+#include "grid_layout.hpp"
+#include "message_queue.hpp"
+#include "split_flap.hpp"
+#include "text_layout.hpp"
+#include "utf8_segment.hpp"
+#include <random>
 #include <string>
 #include <vector>
 
-// Grid dimensions
-#define GRID_COLS 12
-#define GRID_ROWS 5
-#define GRID_SLOT_WIDTH 96
-#define GRID_SLOT_HEIGHT 126  // Reduced from 150 to fit 720p screen
-#define GRID_GAP 10
-#define GRID_SCREEN_WIDTH 1280
-#define GRID_SCREEN_HEIGHT 720  // Changed from 800 to 720 for Tab5
-
 // Animation constants
-#define MAX_PARALLEL_ANIMATIONS 10
+#define MAX_PARALLEL_ANIMATIONS 10  // default, see set_max_parallel_animations()
+#define FLIP_STEP_MS 10  // fixed step of the animation timeline
+#define MESSAGE_POLL_MS 20  // how often the LVGL side checks the queue while messages wait
 
-// Font declarations
+// Font declarations. The firmware can leave them out and load the fonts
+// from a glyph atlas instead (GRID_BOARD_NO_BUILTIN_FONTS, see set_fonts()).
 LV_FONT_DECLARE(ShareTech140);
 LV_FONT_DECLARE(NotoEmoji64);
 
-// Character slot structure for animation management
+// Names of the board's fonts in a glyph atlas
+#define GLYPH_ATLAS_FONT_TEXT "text"
+#define GLYPH_ATLAS_FONT_EMOJI "emoji"
+
+// Font a cell is drawn with
+typedef enum : uint8_t
+{
+    GLYPH_FONT_TEXT = 0,  // ShareTech140
+    GLYPH_FONT_EMOJI,     // NotoEmoji64
+    GLYPH_FONT_COUNT,
+} GlyphFont;
+
+// Candidate table a spinning card cycles through
+typedef enum : uint8_t
+{
+    GLYPH_TABLE_CHARS = 0,  // GridBoard::card_chars
+    GLYPH_TABLE_EMOJI,      // GridBoard::emoji_chars
+} GlyphTable;
+
+// Card colors that are not palette entries
+#define GLYPH_COLOR_WHITE 0xFE
+#define GLYPH_COLOR_HEART 0xFF
+
+// Target character of a cell, resolved once when the message is parsed so
+// the animation never has to look at the UTF-8 text again
+typedef struct
+{
+    uint32_t codepoint;     // first codepoint of the cell text
+    int16_t target_index;   // index in the candidate table, -1 if not in it
+    GlyphFont font;
+    GlyphTable table;
+    uint8_t color;          // card_palette index or GLYPH_COLOR_*
+} GlyphDescriptor;
+
+// One cell of a message laid out ahead of time, in viewer coordinates, with
+// its glyph already resolved. Blank cells are left out.
+typedef struct
+{
+    uint8_t row;
+    uint8_t col;
+    char utf8[8];
+    GlyphDescriptor glyph;
+} CompiledCell;
+
+// Character slot structure for animation management. Plain data, one per cell
+// in a fixed array: the candidate order is derived from order_seed on the fly
+// instead of storing a shuffled copy of the character set.
 typedef struct
 {
     char utf8_char[8];
-    int row;
-    int col;
-    int retry_index;
-    std::vector<char> shuffled_chars;         
-    std::vector<const char *> shuffled_emojis;
+    GlyphDescriptor glyph;
+    uint8_t row;
+    uint8_t col;
+    bool active;           // card is being animated by the timeline
+    int16_t shown;         // candidate index currently on the card
+    uint16_t retry_index;  // position in the candidate order
+    uint32_t order_seed;   // selects this cell's permutation of the candidates
 } GridCharacterSlot;
 
-class GridBoard {
+// Allocation/flip counters, readable from the host to verify that steady-state
+// flipping reuses the per-slot card pool instead of allocating LVGL objects
+typedef struct
+{
+    uint32_t lv_allocations;  // lv_obj/lv_label/lv_timer created by the board
+    uint32_t flips;           // intermediate candidate flips (retries)
+    uint32_t settled;         // cells that reached their target character
+    uint32_t frames;          // display render passes
+    uint64_t render_time_us;  // total time spent rendering those frames
+    uint32_t render_time_max_us;
+    uint32_t messages;        // messages taken from the message queue
+    uint32_t msg_latency_last_us;  // post() to the first rendered frame
+    uint32_t msg_latency_max_us;
+    uint32_t scroll_steps;    // marquee shifts by one column or row
+} GridBoardStats;
+
+// How the board is turned into pixels
+typedef enum
+{
+    GRID_RENDER_OBJECTS = 0,  // lv_obj per slot + pooled card + label (~180 objects)
+    GRID_RENDER_WIDGET,       // single BoardWidget drawing all cells in one draw event
+} GridRenderMode;
+
+// What process_text_and_animate() does with text that does not fit the board
+typedef enum
+{
+    GRID_LONG_TEXT_TRUNCATE = 0,  // cells past the end of the board are dropped
+    GRID_LONG_TEXT_SCROLL,        // the message runs through the board as a marquee
+} GridLongTextMode;
+
+// Direction of a marquee
+typedef enum
+{
+    GRID_SCROLL_LEFT = 0,  // one line through the middle row, new cells enter on the right
+    GRID_SCROLL_UP,        // text wrapped at the board width, new lines enter at the bottom
+} GridScrollDirection;
+
+class GridBoard : private FlipTimelineListener {
 public:
     // Constructor/Destructor
     GridBoard();
     ~GridBoard();
     
     // Main interface functions
+    void set_render_mode(GridRenderMode mode) { render_mode = mode; }  // call before initialize()
+    void set_tile_cache_size(int tiles) { tile_cache_size = tiles; }    // widget mode only, 0 = off
+    void set_message_queue(BoardMessageQueue *queue) { message_queue = queue; }  // call before initialize()
+    // A message was posted: look at the queue now, and keep looking while
+    // messages wait for the board. LVGL side only; other tasks get it there
+    // from the queue's post callback, e.g. through lvgl_port_call_async().
+    void take_messages();
+    void set_layout(const GridLayout &layout);  // call before initialize(), default GRID_LAYOUT_12X5
+    // Fonts for text and emoji cards, e.g. from a GlyphAtlas; call before
+    // initialize(). nullptr keeps the built-in font.
+    void set_fonts(const lv_font_t *text, const lv_font_t *emoji);
+    // Color emoji images, e.g. mapped from the "emoji" partition; call before
+    // initialize(). Emoji the atlas has are drawn from it in their own
+    // colors, the others from the emoji font. The atlas must outlive the board.
+    void set_emoji_atlas(const EmojiAtlas *atlas);
+    const GridLayout &get_layout() const { return geometry.layout; }
+    const GridGeometry &get_geometry() const { return geometry; }
+    // How cards enter their slot, CARD_TRANSITION_DROP by default. Only
+    // changes while no card is moving. CARD_TRANSITION_FLAP is drawn from
+    // tiles and needs widget mode with a tile cache, otherwise the board
+    // keeps its transition (or drops, if it was set before initialize()).
+    void set_transition(CardTransition transition);
+    CardTransition get_transition() const { return transition; }
     void initialize(lv_obj_t *parent);
-    void process_text_and_animate(const std::string& text);
+    int process_text_and_animate(const std::string& text);  // diffed against the current board, returns changed cells
+    // Lay a message out for a layout without a board, from any task: the
+    // cells are placed as process_text_and_animate() places them with the
+    // same alignment and their glyphs resolved, text colors drawn from
+    // color_seed. Returns the number of cells written, at most
+    // grid_layout_cells(); text that does not fit is cut off and reported
+    // through overflow.
+    static int compile_message(const GridLayout& layout, const std::string& text, CompiledCell *cells,
+                               uint32_t color_seed, bool *overflow = nullptr,
+                               TextAlign align = TEXT_ALIGN_CENTER);
+    // Show a compiled message: diffed against the board like
+    // process_text_and_animate(), without parsing. Returns changed cells.
+    int show_compiled(const CompiledCell *cells, int count);
+    // Changes whenever the candidate tables do, so stored glyph indices can be checked
+    static uint32_t glyph_table_signature();
     void clear_display();
+
+    // Direct cell access, in viewer coordinates. Only cells whose character
+    // changes are animated.
+    void set_cell(int row, int col, const char *utf8);
+    void set_cells(int row, int col, const std::string& text);  // row-major, wraps to next row
+    const char *get_cell(int row, int col) const;               // "" for a blank cell
     void set_inverted(bool inverted) { m_inverted = inverted; }
+    // Messages are word-wrapped to the board width, each line aligned on
+    // its own and the lines centered vertically; '\n' breaks a line.
+    // Centered by default, applies from the next message.
+    void set_text_align(TextAlign align) { text_align = align; }
+    TextAlign get_text_align() const { return text_align; }
+
+    // Settled contents in reading order, one cell each, blanks as spaces.
+    // Empty while a marquee runs.
+    std::string get_snapshot() const;
+    // Put a snapshot on the board at once, as settled cards without animation
+    void show_snapshot(const std::string& cells);
     
     // Animation control
     void start_animation_batch();
     bool is_animation_running() const;
+    void set_random_seed(uint32_t seed);  // same seed + same messages = same animation
+    void set_max_parallel_animations(int count) { max_parallel = count > 0 ? count : 1; }
+    const SplitFlapRenderer *get_flap_renderer() const { return flap_renderer; }
+    const GlyphTileCache *get_tile_cache() const { return tile_cache; }  // nullptr without one
+    void advance_animations(uint32_t elapsed_ms);  // normally driven by the board's lv_timer
+
+    // Marquee: streams text of any length through the board. The board cells
+    // form a ring that is rotated one column or row per step, so a step only
+    // resolves the cells coming into view.
+    void set_long_text_mode(GridLongTextMode mode, GridScrollDirection direction = GRID_SCROLL_LEFT);
+    GridLongTextMode get_long_text_mode() const { return long_text_mode; }
+    GridScrollDirection get_long_text_direction() const { return long_text_direction; }
+    void set_scroll_speed(int steps_per_second);
+    void start_marquee(const std::string& text, GridScrollDirection direction = GRID_SCROLL_LEFT);
+    void stop_marquee();  // clears the board
+    bool is_marquee_running() const { return marquee_active; }
+    void advance_marquee(uint32_t elapsed_ms);  // normally driven by the board's lv_timer
     
     // Callback for external sound triggering
     void set_sound_callback(void (*on_start)(), void (*on_end)());
+    // Called from the LVGL task each time every card has settled
+    void set_settled_callback(void (*on_settled)(void *arg), void *arg)
+    {
+        settled_callback = on_settled;
+        settled_arg = arg;
+    }
+
+    // Instrumentation
+    const GridBoardStats& get_stats() const { return stats; }
+    void reset_stats() { stats = GridBoardStats{}; }
     
 private:
     // Grid management
     void create_grid(lv_obj_t *parent);
-    lv_obj_t* create_card(lv_obj_t *slot, const char *text, const lv_font_t *font);
+    bool create_flap_renderer();
+    lv_obj_t* create_card(lv_obj_t *slot, int row, int col);
+    void show_card(int row, int col, const char *text, const lv_font_t *font, lv_color_t color);
+    void set_card_pose(int row, int col, const CardPose &pose, const SlotRect *dirty = nullptr);
+    void hide_card(int row, int col);
+
+    // Logical board updates
+    int split_characters(const std::string& text, Utf8Cell *cells, int max_cells);
+    bool layout_text(const std::string& text, char layout[GRID_MAX_ROWS][GRID_MAX_COLS][8]);
+    bool update_cell(int row, int col, const char *utf8, const GlyphDescriptor *glyph = nullptr);
+    void queue_cell(int row, int col, const char *utf8, const GlyphDescriptor *glyph);
+    void to_physical(int& row, int& col) const;
+    static void render_event_callback(lv_event_t *e);
     
     // Animation functions
-    void animate_card_to_slot(lv_obj_t *card, const char *target);
-    static void animation_ready_callback(lv_anim_t *a);
-    static void timer_callback(lv_timer_t *t);
+    void animate_card_to_slot(GridCharacterSlot *info, int delay_ms);
+    static void flip_timer_callback(lv_timer_t *t);
+    static void message_timer_callback(lv_timer_t *t);
+    static void marquee_timer_callback(lv_timer_t *t);
+    void on_flip_start(int cell) override;
+    bool on_flip_landed(int cell) override;
+    void on_flip_move(int cell, const CardPose &pose, const SlotRect &dirty) override;
     
     // Card dropping logic
-    void on_card_dropped(lv_obj_t *card);
+    bool on_card_dropped(GridCharacterSlot *slot_info);
+    void finish_card(GridCharacterSlot *slot_info);
+    void settle_card(int row, int col);
+    void show_candidate(GridCharacterSlot *slot_info);
+    void resolve_glyph(const char *utf8, GlyphDescriptor *glyph);
+    static void lookup_glyph(const char *utf8, GlyphDescriptor *glyph);
+    lv_color_t glyph_color(uint8_t color_id) const;
+    void remove_queued(int row, int col);
+
+    // Marquee
+    bool next_marquee_cell(Utf8Cell *cell);
+    void marquee_step();
+    void put_marquee_cell(int row, int col, const Utf8Cell &cell);
+    void refresh_marquee_slots();
+    int marquee_ring_row(int row) const { return (row + marquee_row_offset) % geometry.layout.rows; }
+    int marquee_ring_col(int col) const { return (col + marquee_col_offset) % geometry.layout.cols; }
     
     // Utility functions
-    bool is_emoji(const char *utf8_char);
+    static bool is_emoji(const char *utf8_char);
     void utf8_to_upper_ascii(char *utf8_char);
-    int utf8_char_len(unsigned char c);
     
-    // Member variables
-    lv_obj_t *slots[GRID_ROWS][GRID_COLS];
-    std::vector<GridCharacterSlot> animation_queue;
+    // Member variables. Per-cell arrays are sized for the largest layout and
+    // indexed [row][col], only the active layout's rows and columns are used.
+    GridGeometry geometry;
+    lv_obj_t *slots[GRID_MAX_ROWS][GRID_MAX_COLS];
+    // Card pool: one pre-styled card + label per slot, reused for every flip
+    lv_obj_t *cards[GRID_MAX_ROWS][GRID_MAX_COLS];
+    lv_obj_t *labels[GRID_MAX_ROWS][GRID_MAX_COLS];
+    const char *card_text[GRID_MAX_ROWS][GRID_MAX_COLS];  // static label text: a candidate table entry or a slot's target
+    char board_cells[GRID_MAX_ROWS][GRID_MAX_COLS][8];  // logical contents, what each cell settles on
+    char next_cells[GRID_MAX_ROWS][GRID_MAX_COLS][8];   // message laid out on an empty board
+    GlyphDescriptor next_glyphs[GRID_MAX_ROWS][GRID_MAX_COLS];  // their glyphs, for a compiled message
+    Utf8Cell text_cells[TEXT_LAYOUT_MAX_CELLS + 1];  // segmented message (+1 to detect overflow), kept off the LVGL task stack
+    int16_t text_positions[TEXT_LAYOUT_MAX_CELLS];  // where text_layout() put each of them
+    CardPose card_pose[GRID_MAX_ROWS][GRID_MAX_COLS];
+    GridCharacterSlot flip_slots[GRID_MAX_ROWS][GRID_MAX_COLS];
+    GridRenderMode render_mode = GRID_RENDER_OBJECTS;
+    BoardWidget *widget = nullptr;  // only in GRID_RENDER_WIDGET mode
+    GlyphTileCache *tile_cache = nullptr;
+    const lv_font_t *glyph_fonts[GLYPH_FONT_COUNT];
+    const EmojiAtlas *emoji_atlas = nullptr;
+    SplitFlapRenderer *flap_renderer = nullptr;  // only with CARD_TRANSITION_FLAP
+    int tile_cache_size = 0;
+    GridBoardStats stats{};
+    int64_t render_start_us = 0;
+    FlipTimeline timeline;
+    CardTransition transition = CARD_TRANSITION_DROP;
+    lv_timer_t *flip_timer = nullptr;
+    uint32_t last_flip_tick = 0;
+    BoardMessageQueue *message_queue = nullptr;
+    lv_timer_t *message_timer = nullptr;
+    BoardMessage incoming;  // last message taken from the queue
+    int64_t first_frame_pending_us = 0;  // post() time of a message waiting for its first frame
+    // Marquee state. While it runs, board_cells is the ring store: slot
+    // (row, col) shows board_cells[marquee_ring_row(row)][marquee_ring_col(col)]
+    // and the cell's resolved glyph is kept in flip_slots[][].glyph.
+    GridLongTextMode long_text_mode = GRID_LONG_TEXT_TRUNCATE;
+    GridScrollDirection long_text_direction = GRID_SCROLL_LEFT;
+    GridScrollDirection marquee_direction = GRID_SCROLL_LEFT;
+    bool marquee_active = false;
+    std::string marquee_text;
+    size_t marquee_pos = 0;          // next byte of marquee_text to segment
+    int marquee_trailer = 0;         // blank steps taken after the end of the text
+    int marquee_row_offset = 0;
+    int marquee_col_offset = 0;
+    uint32_t marquee_passes = 0;     // times the whole text went through
+    uint32_t scroll_step_ms = 125;
+    uint32_t marquee_pending_ms = 0;
+    uint32_t last_marquee_tick = 0;
+    lv_timer_t *marquee_timer = nullptr;
+    std::mt19937 rng;
+    // Cells waiting for an animation slot, as row * GRID_MAX_COLS + col
+    int16_t animation_queue[GRID_MAX_CELLS];
+    int queue_length = 0;
     int running_animations;
+    int max_parallel = MAX_PARALLEL_ANIMATIONS;
     bool m_inverted = false;  // For 180-degree inverted display
+    TextAlign text_align = TEXT_ALIGN_CENTER;
 
     // SFX callback functions
     void (*start_card_flip_sound_task)();
     void (*stop_card_flip_sound_task)();
+    void (*settled_callback)(void *arg) = nullptr;
+    void *settled_arg = nullptr;
     
     // Static character sets
-    static const char *card_chars;
+    static const char *card_chars[];
     static const char *emoji_chars[];
+    static const int heart_emoji_index;
     static const int total_emoji_cards;
     static const int total_cards;
+    static const uint32_t card_palette[];
+    static const int total_palette_colors;
 };
 
 extern GridBoard* get_grid_board_instance();
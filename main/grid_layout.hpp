@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Largest grid any layout may use. Per-cell state is sized for this, so cell
+// ids (row * GRID_MAX_COLS + col) keep a constant stride for every layout.
+#define GRID_MAX_COLS 16
+#define GRID_MAX_ROWS 9
+#define GRID_MAX_CELLS (GRID_MAX_COLS * GRID_MAX_ROWS)
+
+// Shape of the board: how many slots, how big, and the screen they are centered on
+typedef struct
+{
+    const char *name;
+    uint8_t cols;
+    uint8_t rows;
+    int16_t slot_width;
+    int16_t slot_height;
+    int16_t gap;
+    int16_t screen_width;
+    int16_t screen_height;
+} GridLayout;
+
+constexpr int grid_layout_width(const GridLayout &l)
+{
+    return l.cols * l.slot_width + (l.cols - 1) * l.gap;
+}
+
+constexpr int grid_layout_height(const GridLayout &l)
+{
+    return l.rows * l.slot_height + (l.rows - 1) * l.gap;
+}
+
+constexpr int grid_layout_cells(const GridLayout &l)
+{
+    return l.cols * l.rows;
+}
+
+constexpr bool grid_layout_valid(const GridLayout &l)
+{
+    return l.cols > 0 && l.rows > 0 && l.cols <= GRID_MAX_COLS && l.rows <= GRID_MAX_ROWS &&
+           l.slot_width > 0 && l.slot_height > 0 && l.gap >= 0 &&
+           grid_layout_width(l) <= l.screen_width && grid_layout_height(l) <= l.screen_height;
+}
+
+// Presets. Landscape layouts are for the rotated 1280x720 Tab5 screen, the
+// portrait one for the panel's native 720x1280 orientation.
+constexpr GridLayout GRID_LAYOUT_12X5 = {"12x5", 12, 5, 96, 126, 10, 1280, 720};
+constexpr GridLayout GRID_LAYOUT_16X6 = {"16x6", 16, 6, 72, 108, 8, 1280, 720};
+constexpr GridLayout GRID_LAYOUT_8X3 = {"8x3", 8, 3, 140, 200, 12, 1280, 720};
+constexpr GridLayout GRID_LAYOUT_PORTRAIT = {"portrait", 6, 9, 96, 126, 10, 720, 1280};
+
+static_assert(grid_layout_valid(GRID_LAYOUT_12X5), "12x5 layout does not fit");
+static_assert(grid_layout_valid(GRID_LAYOUT_16X6), "16x6 layout does not fit");
+static_assert(grid_layout_valid(GRID_LAYOUT_8X3), "8x3 layout does not fit");
+static_assert(grid_layout_valid(GRID_LAYOUT_PORTRAIT), "portrait layout does not fit");
+
+/**
+ * Slot rectangles of a layout, resolved once.
+ *
+ * Slots form a regular grid, so a column table and a row table describe every
+ * cell rectangle: slot (row, col) spans col_x[col]..+slot_width and
+ * row_y[row]..+slot_height, relative to the board origin at (x0, y0) on the
+ * screen. Render and invalidate paths read these instead of multiplying the
+ * layout out per cell, and a clip area is turned into a row/column range with
+ * a short table scan.
+ */
+struct GridGeometry
+{
+    GridLayout layout;
+    int16_t x0;  // board origin, centered on the screen
+    int16_t y0;
+    int16_t width;
+    int16_t height;
+    int16_t col_x[GRID_MAX_COLS];
+    int16_t row_y[GRID_MAX_ROWS];
+};
+
+constexpr GridGeometry grid_geometry(const GridLayout &l)
+{
+    GridGeometry g = {};
+    g.layout = l;
+    g.width = (int16_t)grid_layout_width(l);
+    g.height = (int16_t)grid_layout_height(l);
+    g.x0 = (int16_t)((l.screen_width - g.width) / 2);
+    g.y0 = (int16_t)((l.screen_height - g.height) / 2);
+    for (int col = 0; col < l.cols && col < GRID_MAX_COLS; col++)
+    {
+        g.col_x[col] = (int16_t)(col * (l.slot_width + l.gap));
+    }
+    for (int row = 0; row < l.rows && row < GRID_MAX_ROWS; row++)
+    {
+        g.row_y[row] = (int16_t)(row * (l.slot_height + l.gap));
+    }
+    return g;
+}
+
+// Look up a preset by name ("12x5", "16x6", "8x3", "portrait"), nullptr if unknown
+inline const GridLayout *grid_layout_find(const char *name)
+{
+    static const GridLayout *const presets[] = {
+        &GRID_LAYOUT_12X5, &GRID_LAYOUT_16X6, &GRID_LAYOUT_8X3, &GRID_LAYOUT_PORTRAIT};
+    for (const GridLayout *layout : presets)
+    {
+        if (strcmp(layout->name, name) == 0)
+            return layout;
+    }
+    return nullptr;
+}
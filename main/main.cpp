@@ -17,6 +17,7 @@
 #include "esp_heap_caps.h"
 #include "bsp/m5stack_tab5.h"
 #include "esp_lcd_types.h"
+#include "esp_lvgl_port.h"
 #include "lvgl.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
@@ -30,6 +31,7 @@
 #include <random>
 
 #include "grid_board.hpp"
+#include "message_queue.hpp"
 
 extern const uint8_t card_pcm_start[] asm("_binary_card_pcm_start");
 extern const uint8_t card_pcm_end[] asm("_binary_card_pcm_end");
@@ -38,6 +40,8 @@ static const char *TAG = "GridBoard_Tab5";
 
 // Global grid board instance
 static GridBoard grid_board;
+// Messages from BLE and the main task, shown by the LVGL task
+static BoardMessageQueue message_queue(CONFIG_GRID_BOARD_MESSAGE_QUEUE_DEPTH);
 
 static const char *device_name = "Grid_Board_Tab5";
 static std::string target_text = "              WELCOME😀       TO     📌GRID BOARD❤            ";
@@ -104,28 +108,26 @@ void on_ble_connect(bool connected)
 
 void on_ble_write(const uint8_t *data, uint16_t len)
 {
-    std::string received_text((const char *)data, len);
-    ESP_LOGI(TAG, "BLE Received: %s", received_text.c_str());
-    
-    // Wait for any current animations to finish before starting new ones
-    while (grid_board.is_animation_running())
+    ESP_LOGI(TAG, "BLE Received: %.*s", (int)len, (const char *)data);
+
+    // Never wait for the board here, this runs in the NimBLE host task.
+    // The board takes the message once the current animation is done.
+    if (!message_queue.post((const char *)data, len, BOARD_MSG_ENQUEUE))
     {
-        vTaskDelay(pdMS_TO_TICKS(100));
+        ESP_LOGW(TAG, "Message queue full, BLE write dropped");
     }
-    
-    // Process the received text and animate grid
-    grid_board.process_text_and_animate(received_text);
 }
 
-void lvgl_task(void *pvParameters)
+// Queued by message_posted(), runs in the LVGL task
+static void take_messages(void *arg)
 {
-    ESP_LOGI(TAG, "Starting LVGL task");
-    
-    while (1)
-    {
-        vTaskDelay(pdMS_TO_TICKS(10));
-        lv_timer_handler();
-    }
+    grid_board.take_messages();
+}
+
+// BLE writes wake the LVGL task instead of the board polling its queue
+static void message_posted(void *arg)
+{
+    lvgl_port_call_async(take_messages, NULL);
 }
 
 extern "C" void app_main(void)
@@ -150,6 +152,9 @@ extern "C" void app_main(void)
     }
     ESP_ERROR_CHECK(bsp_display_backlight_on());
     
+    // The port's LVGL task is already running
+    bsp_display_lock(0);
+    
     // Set display rotation to landscape
     lv_display_set_rotation(disp, LV_DISPLAY_ROTATION_270);
     
@@ -158,15 +163,19 @@ extern "C" void app_main(void)
     lv_obj_t *screen = lv_display_get_screen_active(disp);
     
     // Initialize grid board
+#if CONFIG_GRID_BOARD_SCROLL_LONG_TEXT
+    grid_board.set_long_text_mode(GRID_LONG_TEXT_SCROLL);
+    grid_board.set_scroll_speed(CONFIG_GRID_BOARD_SCROLL_SPEED);
+#endif
+    message_queue.set_post_callback(message_posted, NULL);
+    grid_board.set_message_queue(&message_queue);
     grid_board.initialize(screen);
     grid_board.set_sound_callback(start_card_flip_sound_task, stop_card_flip_sound_task);
+    bsp_display_unlock();
     
     // Start sound effects task (audio disabled for now)
     start_sfx_task();
     
-    // Create LVGL task
-    xTaskCreate(lvgl_task, "lvgl_task", 4096, NULL, 5, NULL);
-    
     // Start BLE server
     ESP_LOGI(TAG, "Starting BLE server");
     ble_server_register_callbacks(on_ble_connect, on_ble_write);
@@ -174,7 +183,7 @@ extern "C" void app_main(void)
     
     // Display initial welcome message
     ESP_LOGI(TAG, "Displaying welcome message");
-    grid_board.process_text_and_animate(target_text);
+    message_queue.post(target_text, BOARD_MSG_REPLACE_LATEST);
     
     ESP_LOGI(TAG, "Grid Board initialized successfully!");
     
@@ -15,19 +15,76 @@
 #include "lvgl.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include <atomic>
 #include <string>
+#include <time.h>
 
+#include "board_state.hpp"
+#include "boot_trace.h"
+#include "emoji_atlas.hpp"
+#include "glyph_atlas.hpp"
 #include "grid_board.hpp"
+#include "message_queue.hpp"
+#include "playlist.hpp"
 #include "sd_card_helper.h"
 
 static const char *TAG = "GridBoard_Tab5";
 
 // Global grid board instance  
 static GridBoard grid_board;
+#if CONFIG_GRID_BOARD_FONT_ATLAS
+// Card fonts mapped from the glyphs partition, for as long as the board runs
+static GlyphAtlas glyph_atlas;
+#endif
+#if CONFIG_GRID_BOARD_EMOJI_ATLAS
+// Color emoji mapped from the emoji partition
+static EmojiAtlas emoji_atlas;
+#endif
+static BoardMessageQueue message_queue(CONFIG_GRID_BOARD_MESSAGE_QUEUE_DEPTH);
+
+#if CONFIG_GRID_BOARD_LAYOUT_16X6
+static constexpr GridLayout board_layout = GRID_LAYOUT_16X6;
+#elif CONFIG_GRID_BOARD_LAYOUT_8X3
+static constexpr GridLayout board_layout = GRID_LAYOUT_8X3;
+#elif CONFIG_GRID_BOARD_LAYOUT_PORTRAIT
+static constexpr GridLayout board_layout = GRID_LAYOUT_PORTRAIT;
+#else
+static constexpr GridLayout board_layout = GRID_LAYOUT_12X5;
+#endif
+
+#if CONFIG_GRID_BOARD_TRANSITION_FADE
+static constexpr CardTransition board_transition = CARD_TRANSITION_FADE;
+#elif CONFIG_GRID_BOARD_TRANSITION_SLIDE
+static constexpr CardTransition board_transition = CARD_TRANSITION_SLIDE;
+#elif CONFIG_GRID_BOARD_TRANSITION_TYPEWRITER
+static constexpr CardTransition board_transition = CARD_TRANSITION_TYPEWRITER;
+#elif CONFIG_GRID_BOARD_TRANSITION_FLAP
+static constexpr CardTransition board_transition = CARD_TRANSITION_FLAP;
+#else
+static constexpr CardTransition board_transition = CARD_TRANSITION_DROP;
+#endif
+
+#if CONFIG_GRID_BOARD_TEXT_ALIGN_LEFT
+static constexpr TextAlign board_text_align = TEXT_ALIGN_LEFT;
+#elif CONFIG_GRID_BOARD_TEXT_ALIGN_RIGHT
+static constexpr TextAlign board_text_align = TEXT_ALIGN_RIGHT;
+#else
+static constexpr TextAlign board_text_align = TEXT_ALIGN_CENTER;
+#endif
+
+#if CONFIG_GRID_BOARD_ROTATE_KERNEL_TILED
+static constexpr lvgl_port_rotate_kernel_t board_rotate_kernel = LVGL_PORT_ROTATE_KERNEL_TILED;
+#elif CONFIG_GRID_BOARD_ROTATE_KERNEL_LVGL
+static constexpr lvgl_port_rotate_kernel_t board_rotate_kernel = LVGL_PORT_ROTATE_KERNEL_LVGL;
+#elif CONFIG_GRID_BOARD_ROTATE_KERNEL_PPA
+static constexpr lvgl_port_rotate_kernel_t board_rotate_kernel = LVGL_PORT_ROTATE_KERNEL_PPA;
+#else
+static constexpr lvgl_port_rotate_kernel_t board_rotate_kernel = LVGL_PORT_ROTATE_KERNEL_AUTO;
+#endif
 
 static std::string demo_text = "EVA AND YULIA WELCOME HOME 😊❤❤❤";
 
-static bool grid_initialized = false;
 static lv_display_t* main_disp = NULL;
 static int msg_index = 0;
 static uint32_t last_message_time = 0;
@@ -40,52 +97,97 @@ static const char* messages[] = {
     "FAMILY TOGETHER ❤😊❤"
 };
 
-void lvgl_task(void *pvParameters)
+// Playlist from the SD card; the built-in messages rotate until it is loaded
+static Playlist playlist;
+static std::atomic<bool> playlist_ready(false);
+
+static EventGroupHandle_t boot_events = NULL;
+#define BOOT_FIRST_FRAME BIT0
+#define BOOT_STORAGE_READY BIT1
+#define BOOT_C6_READY BIT2
+#define BOOT_BOARD_IDLE BIT3
+
+// How often the message rotation looks at the clock; playlist durations are
+// whole seconds
+#define ROTATION_CHECK_MS 250
+
+// First rendered frame, from the LVGL task
+static void first_frame_cb(lv_event_t *e)
 {
-    ESP_LOGI(TAG, "Starting LVGL task");
-    
-    // Wait a bit for initialization to complete
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
-    // Initialize grid board once LVGL is ready
-    if (!grid_initialized && main_disp != NULL) {
-        vTaskDelay(pdMS_TO_TICKS(200)); // Give LVGL time to settle
-        
-        ESP_LOGI(TAG, "Initializing Grid Board UI from LVGL task");
-        lv_obj_t *screen = lv_display_get_screen_active(main_disp);
-        
-        // Initialize grid board
-        grid_board.initialize(screen);
-        
-        // Display initial message
-        grid_board.process_text_and_animate(messages[msg_index]);
-        last_message_time = esp_timer_get_time() / 1000; // Get time in ms
-        
-        grid_initialized = true;
-        ESP_LOGI(TAG, "Grid board initialized successfully!");
+    if (xEventGroupGetBits(boot_events) & BOOT_FIRST_FRAME) {
+        return;
     }
-    
-    while (1)
-    {
-        // Check if LVGL is ready before calling handler
-        if (lv_display_get_default() != NULL) {
-            lv_timer_handler();
-            
-            // Check if it's time to change message (every 30 seconds)
-            if (grid_initialized) {
-                uint32_t current_time = esp_timer_get_time() / 1000;
-                if (current_time - last_message_time > 30000) {
-                    msg_index = (msg_index + 1) % 5;
-                    ESP_LOGI(TAG, "Changing to message %d: %s", msg_index, messages[msg_index]);
-                    grid_board.process_text_and_animate(messages[msg_index]);
-                    last_message_time = current_time;
-                }
-            }
-        }
-        vTaskDelay(pdMS_TO_TICKS(10));
+    boot_trace_mark("first frame");
+    xEventGroupSetBits(boot_events, BOOT_FIRST_FRAME);
+}
+
+// Display port work for the message that just settled
+static void log_damage_stats(void)
+{
+    static lvgl_port_damage_stats_t last = {};
+    lvgl_port_damage_stats_t stats;
+    if (main_disp == NULL || lvgl_port_get_damage_stats(main_disp, &stats) != ESP_OK) {
+        return;
+    }
+    ESP_LOGI(TAG, "Damage: %lu areas in, %lu merged, %lu flushed in %lu refreshes, %llu px flushed, %llu px rotated",
+             (unsigned long)(stats.areas_in - last.areas_in), (unsigned long)(stats.areas_merged - last.areas_merged),
+             (unsigned long)(stats.areas_out - last.areas_out), (unsigned long)(stats.refreshes - last.refreshes),
+             (unsigned long long)(stats.pixels_out - last.pixels_out),
+             (unsigned long long)(stats.pixels_rotated - last.pixels_rotated));
+    last = stats;
+}
+
+// Every settled board becomes the one shown on the next boot
+static void board_settled_cb(void *arg)
+{
+    board_state_save(board_layout, grid_board.get_snapshot());
+    log_damage_stats();
+    xEventGroupSetBits(boot_events, BOOT_BOARD_IDLE);
+}
+
+// Minute of the local day for playlist time windows, -1 while the clock is not set
+static int minute_of_day(void)
+{
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    if (local.tm_year < 2020 - 1900) {
+        return -1;
+    }
+    return local.tm_hour * 60 + local.tm_min;
+}
+
+// Message rotation on the LVGL side: the playlist once the SD card has one,
+// the built-in messages every 30 seconds until then
+static void rotation_timer_cb(lv_timer_t *timer)
+{
+    if (playlist_ready.load(std::memory_order_acquire)) {
+        playlist.tick(grid_board, esp_timer_get_time() / 1000, minute_of_day());
+        return;
+    }
+    uint32_t current_time = esp_timer_get_time() / 1000;
+    if (current_time - last_message_time > 30000) {
+        msg_index = (msg_index + 1) % 5;
+        ESP_LOGI(TAG, "Changing to message %d: %s", msg_index, messages[msg_index]);
+        message_queue.post(messages[msg_index], BOARD_MSG_REPLACE_LATEST);
+        last_message_time = current_time;
     }
 }
 
+// Queued by message_posted(), runs in the LVGL task
+static void take_messages(void *arg)
+{
+    grid_board.take_messages();
+}
+
+// Every post wakes the LVGL task instead of the board polling its queue. If
+// the port's call queue is full, the take_messages() calls already in it
+// (the only calls this app queues) see the message too.
+static void message_posted(void *arg)
+{
+    lvgl_port_call_async(take_messages, NULL);
+}
+
 // External C6 integration function
 extern "C" {
     esp_err_t tab5_c6_system_init(bool force_bridge_mode);
@@ -95,30 +197,27 @@ extern "C" {
     esp_err_t delete_c6_backup(void);
 }
 
-extern "C" void app_main(void)
+// SD card, the C6 bridge-mode decision and the playlist, off the display path
+static void storage_init_task(void *arg)
 {
-    ESP_LOGI(TAG, "Grid Board Demo for M5Stack Tab5 starting...");
-    
-    // Initialize NVS
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
-    {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(ret);
-    
     // Check if we should enter bridge mode for C6 firmware flashing
     // Initialize SD card first to check for firmware status
+    int phase = boot_trace_begin("sd mount");
     sd_card_init();
+    boot_trace_end(phase);
     
     // AUTO DELETE: Remove backup file to exit bridge mode
     // Since we already transferred the firmware, we don't need bridge mode
+    phase = boot_trace_begin("c6 backup delete");
     if (delete_c6_backup() == ESP_OK) {
         ESP_LOGI(TAG, "Backup file deleted, continuing with normal boot");
     }
+    boot_trace_end(phase);
     
-    if (should_enter_bridge_mode()) {
+    phase = boot_trace_begin("bridge mode check");
+    bool bridge = should_enter_bridge_mode();
+    boot_trace_end(phase);
+    if (bridge) {
         ESP_LOGI(TAG, "Entering C6 UART bridge mode for firmware flashing");
         ESP_LOGI(TAG, "==============================================");
         ESP_LOGI(TAG, "UART BRIDGE MODE ACTIVE");
@@ -127,9 +226,75 @@ extern "C" void app_main(void)
         ESP_LOGI(TAG, "==============================================");
         c6_uart_bridge_main();
         // Never returns from bridge mode
-        return;
     }
     
+    xEventGroupSetBits(boot_events, BOOT_STORAGE_READY);
+    
+    // Compile the playlist here, so the LVGL task only switches between
+    // ready-made layouts
+    if (sd_card_is_initialized()) {
+        std::string path = std::string(sd_card_get_mount_point()) + "/" CONFIG_GRID_BOARD_PLAYLIST_FILE;
+        std::string cache = path + ".bin";
+        phase = boot_trace_begin("playlist");
+        bool loaded = playlist.load(path.c_str(), cache.c_str(), board_layout, board_text_align);
+        boot_trace_end(phase);
+        if (loaded) {
+            playlist_ready.store(true, std::memory_order_release);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+// ESP32-C6 link. Waits for the bridge-mode decision, since bridge mode owns
+// the C6 instead.
+static void c6_init_task(void *arg)
+{
+    xEventGroupWaitBits(boot_events, BOOT_STORAGE_READY, pdFALSE, pdTRUE, portMAX_DELAY);
+    
+    // Initialize ESP32-C6 communication
+    ESP_LOGI(TAG, "Initializing ESP32-C6 communication system");
+    int phase = boot_trace_begin("c6 init");
+    esp_err_t ret = tab5_c6_system_init(false);  // false = normal SDIO mode, not bridge
+    boot_trace_end(phase);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "C6 communication initialized, starting demo");
+        // Run C6 demo in background task
+        xTaskCreate([](void* arg) { tab5_c6_demo(); }, "c6_demo", 4096, NULL, 3, NULL);
+    } else {
+        ESP_LOGW(TAG, "C6 communication initialization failed: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "ESP32-C6 may not have SDIO slave firmware installed");
+        ESP_LOGW(TAG, "To flash C6 firmware:");
+        ESP_LOGW(TAG, "1. Hold BOOT button and press RESET to enter bridge mode");
+        ESP_LOGW(TAG, "2. Or modify should_enter_bridge_mode() to return true");
+    }
+    
+    xEventGroupSetBits(boot_events, BOOT_C6_READY);
+    vTaskDelete(NULL);
+}
+
+extern "C" void app_main(void)
+{
+    boot_trace_mark("app_main");
+    boot_events = xEventGroupCreate();
+    ESP_LOGI(TAG, "Grid Board Demo for M5Stack Tab5 starting...");
+    
+    // Initialize NVS
+    int phase = boot_trace_begin("nvs");
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+    boot_trace_end(phase);
+    
+    // Last board shown before the reboot, drawn on the first frame
+    phase = boot_trace_begin("board state load");
+    std::string snapshot;
+    bool restored = board_state_load(board_layout, &snapshot);
+    boot_trace_end(phase);
+    
     // Initialize display exactly like reference implementation
     ESP_LOGI(TAG, "Initializing display with landscape orientation");
     bsp_display_cfg_t cfg = {
@@ -147,7 +312,9 @@ extern "C" void app_main(void)
         }
     };
     
+    phase = boot_trace_begin("display");
     lv_display_t* disp = bsp_display_start_with_config(&cfg);
+    boot_trace_end(phase);
     if (disp == NULL) {
         ESP_LOGE(TAG, "Failed to initialize display");
         return;
@@ -155,36 +322,86 @@ extern "C" void app_main(void)
     
     // Store display for LVGL task
     main_disp = disp;
+    if (lvgl_port_set_rotate_kernel(disp, board_rotate_kernel, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "Rotation kernel not available, using the default");
+    }
+    lvgl_port_set_damage_merge(disp, CONFIG_GRID_BOARD_DAMAGE_AREA_COST);
+    
+    // Slow subsystems come up while the board renders
+    xTaskCreate(storage_init_task, "storage_init", 6144, NULL, 4, NULL);
+    xTaskCreate(c6_init_task, "c6_init", 4096, NULL, 3, NULL);
+    
+    phase = boot_trace_begin("board setup");
+    bsp_display_lock(0);
     
     // Rotate to landscape: 90 for normal viewing, 270 for inverted (bottom mount)
-    // Using 90 for normal landscape orientation
-    lv_display_set_rotation(disp, LV_DISPLAY_ROTATION_90);
-    ESP_ERROR_CHECK(bsp_display_backlight_on());
+    // Using 90 for normal landscape orientation. Portrait layouts use the
+    // panel as is.
+    bool landscape = board_layout.screen_width > board_layout.screen_height;
+    lv_display_set_rotation(disp, landscape ? LV_DISPLAY_ROTATION_90 : LV_DISPLAY_ROTATION_0);
     
-    // Unlock display after configuration
-    bsp_display_unlock();
+    ESP_LOGI(TAG, "Initializing Grid Board UI");
+    lv_obj_t *screen = lv_display_get_screen_active(disp);
     
-    // Create LVGL task - it will handle grid initialization
-    ESP_LOGI(TAG, "Starting LVGL task");
-    xTaskCreate(lvgl_task, "lvgl_task", 8192, NULL, 5, NULL);
+    // Initialize grid board
+#if CONFIG_GRID_BOARD_RENDER_WIDGET
+    grid_board.set_render_mode(GRID_RENDER_WIDGET);
+    grid_board.set_tile_cache_size(CONFIG_GRID_BOARD_TILE_CACHE_SIZE);
+#endif
+    grid_board.set_layout(board_layout);
+#if CONFIG_GRID_BOARD_FONT_ATLAS
+    if (glyph_atlas.map_partition()) {
+        grid_board.set_fonts(glyph_atlas.font(GLYPH_ATLAS_FONT_TEXT), glyph_atlas.font(GLYPH_ATLAS_FONT_EMOJI));
+    }
+#endif
+#if CONFIG_GRID_BOARD_EMOJI_ATLAS
+    if (emoji_atlas.map_partition()) {
+        grid_board.set_emoji_atlas(&emoji_atlas);
+    }
+#endif
+    grid_board.set_transition(board_transition);
+    grid_board.set_max_parallel_animations(CONFIG_GRID_BOARD_PARALLEL_FLIPS);
+    grid_board.set_text_align(board_text_align);
+#if CONFIG_GRID_BOARD_SCROLL_LONG_TEXT
+    grid_board.set_long_text_mode(GRID_LONG_TEXT_SCROLL);
+    grid_board.set_scroll_speed(CONFIG_GRID_BOARD_SCROLL_SPEED);
+#endif
+    message_queue.set_post_callback(message_posted, NULL);
+    grid_board.set_message_queue(&message_queue);
+    grid_board.set_settled_callback(board_settled_cb, NULL);
+    grid_board.initialize(screen);
     
-    // Initialize ESP32-C6 communication
-    ESP_LOGI(TAG, "Initializing ESP32-C6 communication system");
-    ret = tab5_c6_system_init(false);  // false = normal SDIO mode, not bridge
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "C6 communication initialized, starting demo");
-        // Run C6 demo in background task
-        xTaskCreate([](void* arg) { tab5_c6_demo(); }, "c6_demo", 4096, NULL, 3, NULL);
+    // Restored boards stay up until the normal message rotation moves on;
+    // a first boot starts with the first message
+    if (restored) {
+        grid_board.show_snapshot(snapshot);
+        xEventGroupSetBits(boot_events, BOOT_BOARD_IDLE);
     } else {
-        ESP_LOGW(TAG, "C6 communication initialization failed: %s", esp_err_to_name(ret));
-        ESP_LOGW(TAG, "ESP32-C6 may not have SDIO slave firmware installed");
-        ESP_LOGW(TAG, "To flash C6 firmware:");
-        ESP_LOGW(TAG, "1. Hold BOOT button and press RESET to enter bridge mode");
-        ESP_LOGW(TAG, "2. Or modify should_enter_bridge_mode() to return true");
+        message_queue.post(messages[msg_index], BOARD_MSG_REPLACE_LATEST);
     }
+    last_message_time = esp_timer_get_time() / 1000; // Get time in ms
+    lv_timer_create(rotation_timer_cb, ROTATION_CHECK_MS, NULL);
+    lv_display_add_event_cb(disp, first_frame_cb, LV_EVENT_REFR_READY, NULL);
     
-    // Grid board initialization and message cycling happens in LVGL task
-    ESP_LOGI(TAG, "Grid Board initialization delegated to LVGL task");
+    bsp_display_unlock();
+    boot_trace_end(phase);
+    phase = boot_trace_begin("backlight");
+    ESP_ERROR_CHECK(bsp_display_backlight_on());
+    boot_trace_end(phase);
+    
+    // Report once startup is over and the board has nothing left to animate
+    xEventGroupWaitBits(boot_events, BOOT_FIRST_FRAME | BOOT_C6_READY | BOOT_BOARD_IDLE, pdFALSE, pdTRUE,
+                        portMAX_DELAY);
+#if CONFIG_GRID_BOARD_BOOT_TRACE_SD
+    if (sd_card_is_initialized()) {
+        std::string path = std::string(sd_card_get_mount_point()) + "/boot_trace.txt";
+        boot_trace_dump(path.c_str());
+    } else {
+        boot_trace_dump(NULL);
+    }
+#else
+    boot_trace_dump(NULL);
+#endif
     
     // Main task just keeps running
     while (1)
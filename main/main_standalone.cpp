@@ -17,6 +17,8 @@
 #include <vector>
 #include <cstring>
 
+#include "grid_layout.hpp"
+
 static const char *TAG = "GridBoard";
 
 // Tab5 Display Configuration
@@ -27,12 +29,14 @@ static const char *TAG = "GridBoard";
 #define MIPI_DSI_LANE_RATE_MBPS 500
 #define LCD_BACKLIGHT_GPIO     22
 
-// Grid configuration
-#define GRID_COLS 12
-#define GRID_ROWS 5
-#define GRID_SLOT_WIDTH 96
-#define GRID_SLOT_HEIGHT 126
-#define GRID_GAP 10
+// Grid configuration, from the shared layout presets
+static constexpr GridLayout board_layout = GRID_LAYOUT_12X5;
+static_assert(board_layout.screen_width == LCD_H_RES && board_layout.screen_height == LCD_V_RES,
+              "layout is for a different screen");
+#define GRID_COLS board_layout.cols
+#define GRID_ROWS board_layout.rows
+#define GRID_SLOT_WIDTH board_layout.slot_width
+#define GRID_SLOT_HEIGHT board_layout.slot_height
 
 class GridBoardDemo {
 private:
@@ -51,16 +55,13 @@ public:
         lv_obj_set_style_bg_color(parent, lv_color_hex(0x000000), 0);
         
         // Calculate grid position
-        int total_width = GRID_COLS * GRID_SLOT_WIDTH + (GRID_COLS - 1) * GRID_GAP;
-        int total_height = GRID_ROWS * GRID_SLOT_HEIGHT + (GRID_ROWS - 1) * GRID_GAP;
-        int x_start = (LCD_H_RES - total_width) / 2;
-        int y_start = (LCD_V_RES - total_height) / 2;
+        constexpr GridGeometry geometry = grid_geometry(board_layout);
 
         // Create grid slots
         for (int row = 0; row < GRID_ROWS; row++) {
             for (int col = 0; col < GRID_COLS; col++) {
-                int x = x_start + col * (GRID_SLOT_WIDTH + GRID_GAP);
-                int y = y_start + row * (GRID_SLOT_HEIGHT + GRID_GAP);
+                int x = geometry.x0 + geometry.col_x[col];
+                int y = geometry.y0 + geometry.row_y[row];
                 
                 lv_obj_t* slot = lv_obj_create(parent);
                 lv_obj_set_size(slot, GRID_SLOT_WIDTH, GRID_SLOT_HEIGHT);
@@ -0,0 +1,97 @@
+#include "message_queue.hpp"
+#include "esp_timer.h"
+#include <cstring>
+
+BoardMessageQueue::BoardMessageQueue(int capacity)
+    : capacity(capacity), head(0), count(0), next_seq(0), stats{}, post_callback(nullptr), post_callback_arg(nullptr)
+{
+    ring = new BoardMessage[capacity];
+}
+
+BoardMessageQueue::~BoardMessageQueue()
+{
+    delete[] ring;
+}
+
+bool BoardMessageQueue::post(const char *text, size_t len, BoardMessagePolicy policy)
+{
+    int64_t now = esp_timer_get_time();
+    bool truncated = false;
+    if (len > BOARD_MESSAGE_MAX_LEN - 1)
+    {
+        // Do not split a UTF-8 sequence
+        len = BOARD_MESSAGE_MAX_LEN - 1;
+        while (len > 0 && ((unsigned char)text[len] & 0xC0) == 0x80)
+        {
+            len--;
+        }
+        truncated = true;
+    }
+
+    {
+        // Every holder only updates the indexes and copies one message, so a
+        // producer waits for the LVGL side at most that long
+        std::lock_guard<std::mutex> guard(lock);
+        stats.posted++;
+        if (truncated)
+        {
+            stats.truncated++;
+        }
+
+        if (policy != BOARD_MSG_ENQUEUE)
+        {
+            stats.replaced += count;
+            head = 0;
+            count = 0;
+        }
+        else if (count == capacity)
+        {
+            stats.dropped++;
+            return false;
+        }
+
+        BoardMessage &msg = ring[(head + count) % capacity];
+        memcpy(msg.text, text, len);
+        msg.text[len] = '\0';
+        msg.len = (uint16_t)len;
+        msg.policy = policy;
+        msg.seq = next_seq++;
+        msg.enqueue_us = now;
+        count++;
+    }
+
+    if (post_callback)
+    {
+        post_callback(post_callback_arg);
+    }
+    return true;
+}
+
+bool BoardMessageQueue::pop(BoardMessage *out, bool board_idle)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (count == 0)
+        return false;
+
+    // post() clears the queue for an interrupt, so it can only be at the head
+    const BoardMessage &msg = ring[head];
+    if (!board_idle && msg.policy != BOARD_MSG_INTERRUPT)
+        return false;
+
+    memcpy(out, &msg, sizeof(BoardMessage));
+    head = (head + 1) % capacity;
+    count--;
+    return true;
+}
+
+int BoardMessageQueue::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return count;
+}
+
+BoardMessageQueueStats BoardMessageQueue::get_stats() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <string>
+
+// Longest message kept by the queue, in bytes. Longer text is cut at a
+// character boundary.
+#define BOARD_MESSAGE_MAX_LEN 256
+
+// What a new message does to the messages still waiting
+typedef enum : uint8_t
+{
+    BOARD_MSG_ENQUEUE = 0,     // append, shown after everything before it
+    BOARD_MSG_REPLACE_LATEST,  // drop everything waiting, shown next
+    BOARD_MSG_INTERRUPT,       // drop everything waiting, shown immediately even mid-animation
+} BoardMessagePolicy;
+
+typedef struct
+{
+    char text[BOARD_MESSAGE_MAX_LEN];
+    uint16_t len;
+    BoardMessagePolicy policy;
+    uint32_t seq;          // increasing message number, for logs
+    int64_t enqueue_us;    // esp_timer time of post()
+} BoardMessage;
+
+typedef struct
+{
+    uint32_t posted;
+    uint32_t dropped;      // ENQUEUE on a full queue
+    uint32_t replaced;     // pending messages discarded by REPLACE_LATEST/INTERRUPT
+    uint32_t truncated;
+} BoardMessageQueueStats;
+
+/**
+ * Bounded message queue between the transports and the board.
+ *
+ * Producers (BLE, SDIO, timers, ...) call post() from any task. It only copies
+ * the text into a preallocated ring under a short lock and never waits for the
+ * board. The LVGL side calls pop() from its timer: a message is handed out
+ * when the board is idle, or right away if it was posted as an interrupt.
+ * The post callback tells the LVGL side that there is something to pop, so
+ * it does not have to poll an empty queue.
+ */
+class BoardMessageQueue {
+public:
+    explicit BoardMessageQueue(int capacity);
+    ~BoardMessageQueue();
+
+    // Returns false if the message was dropped because the queue is full
+    bool post(const char *text, size_t len, BoardMessagePolicy policy = BOARD_MSG_ENQUEUE);
+    bool post(const std::string &text, BoardMessagePolicy policy = BOARD_MSG_ENQUEUE)
+    {
+        return post(text.data(), text.size(), policy);
+    }
+
+    // Called by every post() that queued its message, in the posting task
+    // after the lock is released. Set it before the producers start.
+    void set_post_callback(void (*callback)(void *arg), void *arg)
+    {
+        post_callback = callback;
+        post_callback_arg = arg;
+    }
+
+    // Take the next message if the board may show it now
+    bool pop(BoardMessage *out, bool board_idle);
+
+    int size() const;
+    BoardMessageQueueStats get_stats() const;
+
+private:
+    BoardMessage *ring;
+    int capacity;
+    int head;   // oldest message
+    int count;
+    uint32_t next_seq;
+    BoardMessageQueueStats stats;
+    mutable std::mutex lock;
+    void (*post_callback)(void *arg);
+    void *post_callback_arg;
+};
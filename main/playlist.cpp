@@ -0,0 +1,350 @@
+#include "playlist.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char *TAG = "PLAYLIST";
+
+#define PLAYLIST_CACHE_MAGIC 0x4C504247  // "GBPL"
+
+static uint32_t fnv1a(const std::string &data)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : data)
+    {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static std::string trim(const std::string &s)
+{
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && is_space(s[begin]))
+        begin++;
+    while (end > begin && is_space(s[end - 1]))
+        end--;
+    return s.substr(begin, end - begin);
+}
+
+// "HH:MM" as minute of the day, -1 if malformed
+static int parse_time(const char *s)
+{
+    char *end;
+    long hours = strtol(s, &end, 10);
+    if (end == s || *end != ':' || hours < 0 || hours > 23)
+        return -1;
+    const char *m = end + 1;
+    long minutes = strtol(m, &end, 10);
+    if (end != m + 2 || minutes < 0 || minutes > 59)
+        return -1;
+    return (int)(hours * 60 + minutes);
+}
+
+// Schedule in front of the '|': "30s", "p2", "07:00-09:00" in any order
+static bool parse_schedule(const std::string &spec, PlaylistEntry *e)
+{
+    size_t pos = 0;
+    while (pos < spec.size())
+    {
+        while (pos < spec.size() && is_space(spec[pos]))
+            pos++;
+        size_t end = pos;
+        while (end < spec.size() && !is_space(spec[end]))
+            end++;
+        if (end == pos)
+            break;
+
+        std::string token = spec.substr(pos, end - pos);
+        pos = end;
+        char *rest;
+        if (token[0] == 'p' || token[0] == 'P')
+        {
+            long priority = strtol(token.c_str() + 1, &rest, 10);
+            if (rest == token.c_str() + 1 || *rest || priority < 0 || priority > PLAYLIST_MAX_PRIORITY)
+                return false;
+            e->priority = (uint8_t)priority;
+        }
+        else if (token.find('-') != std::string::npos)
+        {
+            size_t dash = token.find('-');
+            int start = parse_time(token.substr(0, dash).c_str());
+            int stop = parse_time(token.substr(dash + 1).c_str());
+            if (start < 0 || stop < 0 || start == stop)
+                return false;
+            e->window_start = (int16_t)start;
+            e->window_end = (int16_t)stop;
+        }
+        else
+        {
+            long seconds = strtol(token.c_str(), &rest, 10);
+            if (rest == token.c_str() || (*rest && strcmp(rest, "s") != 0) || seconds < 1 || seconds > 65535)
+                return false;
+            e->duration_s = (uint16_t)seconds;
+        }
+    }
+    return true;
+}
+
+bool Playlist::compile(const std::string &source, const GridLayout &board_layout, TextAlign text_align)
+{
+    int64_t start_us = esp_timer_get_time();
+    layout = board_layout;
+    align = text_align;
+    entries.clear();
+    cell_pool.clear();
+    text_pool.clear();
+    source_hash = fnv1a(source);
+    from_cache = false;
+    current = -1;
+
+    std::vector<CompiledCell> cells(grid_layout_cells(layout));
+    size_t pos = 0;
+    int line_number = 0;
+    while (pos < source.size())
+    {
+        size_t end = source.find('\n', pos);
+        if (end == std::string::npos)
+            end = source.size();
+        std::string line = trim(source.substr(pos, end - pos));
+        pos = end + 1;
+        line_number++;
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        if (entries.size() >= PLAYLIST_MAX_ENTRIES)
+        {
+            ESP_LOGW(TAG, "More than %d entries, ignoring the rest from line %d", PLAYLIST_MAX_ENTRIES,
+                     line_number);
+            break;
+        }
+
+        PlaylistEntry e = {};
+        e.duration_s = PLAYLIST_DEFAULT_DURATION_S;
+        e.window_start = -1;
+        e.window_end = -1;
+        std::string text = line;
+        size_t bar = line.find('|');
+        if (bar != std::string::npos)
+        {
+            if (!parse_schedule(line.substr(0, bar), &e))
+            {
+                ESP_LOGW(TAG, "Line %d: bad schedule \"%s\"", line_number, trim(line.substr(0, bar)).c_str());
+                continue;
+            }
+            text = trim(line.substr(bar + 1));
+        }
+        if (text.empty() || text.size() > UINT16_MAX)
+        {
+            ESP_LOGW(TAG, "Line %d: no message", line_number);
+            continue;
+        }
+
+        // Colors are seeded per entry, so a recompile gives the same board
+        bool overflow = false;
+        int count = GridBoard::compile_message(layout, text, cells.data(), source_hash + entries.size(), &overflow,
+                                               align);
+        if (overflow)
+        {
+            e.flags |= PLAYLIST_ENTRY_SCROLL;
+        }
+        e.cell_offset = cell_pool.size();
+        e.cell_count = (uint16_t)count;
+        cell_pool.insert(cell_pool.end(), cells.begin(), cells.begin() + count);
+        e.text_offset = text_pool.size();
+        e.text_len = (uint16_t)text.size();
+        text_pool += text;
+        entries.push_back(e);
+    }
+
+    ESP_LOGI(TAG, "Compiled %d entries (%d cells) for %s in %lld us", (int)entries.size(), (int)cell_pool.size(),
+             layout.name, (long long)(esp_timer_get_time() - start_us));
+    return !entries.empty();
+}
+
+bool Playlist::load(const char *path, const char *cache_path, const GridLayout &board_layout, TextAlign text_align)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        ESP_LOGI(TAG, "No playlist at %s", path);
+        return false;
+    }
+    std::string source;
+    char buf[512];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    {
+        source.append(buf, n);
+    }
+    fclose(f);
+
+    layout = board_layout;
+    align = text_align;
+    if (cache_path && load_cache(cache_path, fnv1a(source)))
+    {
+        ESP_LOGI(TAG, "Loaded %d compiled entries from %s", (int)entries.size(), cache_path);
+        return true;
+    }
+    if (!compile(source, board_layout, text_align))
+        return false;
+    if (cache_path)
+    {
+        save_cache(cache_path);
+    }
+    return true;
+}
+
+bool Playlist::save_cache(const char *path) const
+{
+    PlaylistCacheHeader header = {};
+    header.magic = PLAYLIST_CACHE_MAGIC;
+    header.version = PLAYLIST_CACHE_VERSION;
+    header.entry_size = sizeof(PlaylistEntry);
+    header.cell_size = sizeof(CompiledCell);
+    header.cols = layout.cols;
+    header.rows = layout.rows;
+    header.align = align;
+    header.slot_width = layout.slot_width;
+    header.slot_height = layout.slot_height;
+    header.source_hash = source_hash;
+    header.glyph_tables = GridBoard::glyph_table_signature();
+    header.entry_count = (uint16_t)entries.size();
+    header.cell_count = cell_pool.size();
+    header.text_bytes = text_pool.size();
+
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        ESP_LOGW(TAG, "Cannot write %s", path);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(entries.data(), sizeof(PlaylistEntry), entries.size(), f) == entries.size() &&
+              fwrite(cell_pool.data(), sizeof(CompiledCell), cell_pool.size(), f) == cell_pool.size() &&
+              fwrite(text_pool.data(), 1, text_pool.size(), f) == text_pool.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok)
+    {
+        ESP_LOGW(TAG, "Writing %s failed", path);
+        remove(path);
+    }
+    return ok;
+}
+
+// Accept the cache only if it was compiled from the same text, for the same
+// layout, alignment and glyph tables, by the same build of the structures
+bool Playlist::load_cache(const char *path, uint32_t hash)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+
+    PlaylistCacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 && header.magic == PLAYLIST_CACHE_MAGIC &&
+              header.version == PLAYLIST_CACHE_VERSION && header.entry_size == sizeof(PlaylistEntry) &&
+              header.cell_size == sizeof(CompiledCell) && header.cols == layout.cols &&
+              header.rows == layout.rows && header.align == align && header.slot_width == layout.slot_width &&
+              header.slot_height == layout.slot_height && header.source_hash == hash &&
+              header.glyph_tables == GridBoard::glyph_table_signature() && header.entry_count > 0 &&
+              header.entry_count <= PLAYLIST_MAX_ENTRIES &&
+              header.cell_count <= (uint32_t)PLAYLIST_MAX_ENTRIES * grid_layout_cells(layout);
+    if (ok)
+    {
+        entries.resize(header.entry_count);
+        cell_pool.resize(header.cell_count);
+        text_pool.resize(header.text_bytes);
+        ok = fread(entries.data(), sizeof(PlaylistEntry), entries.size(), f) == entries.size() &&
+             fread(cell_pool.data(), sizeof(CompiledCell), cell_pool.size(), f) == cell_pool.size() &&
+             fread(&text_pool[0], 1, text_pool.size(), f) == text_pool.size();
+    }
+    fclose(f);
+
+    for (size_t i = 0; ok && i < entries.size(); i++)
+    {
+        const PlaylistEntry &e = entries[i];
+        ok = (uint64_t)e.cell_offset + e.cell_count <= cell_pool.size() &&
+             (uint64_t)e.text_offset + e.text_len <= text_pool.size() && e.priority <= PLAYLIST_MAX_PRIORITY;
+    }
+    if (!ok)
+    {
+        entries.clear();
+        cell_pool.clear();
+        text_pool.clear();
+        return false;
+    }
+    source_hash = hash;
+    from_cache = true;
+    current = -1;
+    return true;
+}
+
+bool Playlist::in_window(const PlaylistEntry &e, int minute_of_day)
+{
+    if (e.window_start < 0)
+        return true;
+    if (minute_of_day < 0)
+        return false;
+    if (e.window_start < e.window_end)
+        return minute_of_day >= e.window_start && minute_of_day < e.window_end;
+    return minute_of_day >= e.window_start || minute_of_day < e.window_end;
+}
+
+int Playlist::select(int minute_of_day) const
+{
+    int best = -1;
+    for (const PlaylistEntry &e : entries)
+    {
+        if (in_window(e, minute_of_day) && e.priority > best)
+            best = e.priority;
+    }
+    if (best < 0)
+        return -1;
+
+    // Round robin among the entries of that priority, after the current one
+    const int n = size();
+    for (int k = 1; k <= n; k++)
+    {
+        int i = (current + k) % n;
+        if (in_window(entries[i], minute_of_day) && entries[i].priority == best)
+            return i;
+    }
+    return -1;
+}
+
+int Playlist::show(GridBoard &board, int index) const
+{
+    const PlaylistEntry &e = entries[index];
+    if ((e.flags & PLAYLIST_ENTRY_SCROLL) && board.get_long_text_mode() == GRID_LONG_TEXT_SCROLL)
+    {
+        board.start_marquee(text(e), board.get_long_text_direction());
+        return board.get_long_text_direction() == GRID_SCROLL_LEFT ? board.get_layout().cols
+                                                                   : grid_layout_cells(board.get_layout());
+    }
+    return board.show_compiled(cells(e), e.cell_count);
+}
+
+bool Playlist::tick(GridBoard &board, int64_t now_ms, int minute_of_day)
+{
+    if (entries.empty())
+        return false;
+    if (current >= 0 &&
+        (now_ms - shown_at_ms < (int64_t)entries[current].duration_s * 1000 || board.is_animation_running()))
+        return false;
+
+    int next = select(minute_of_day);
+    if (next < 0)
+        return false;
+    show(board, next);
+    current = next;
+    shown_at_ms = now_ms;
+    return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "grid_board.hpp"
+#include "grid_layout.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define PLAYLIST_MAX_ENTRIES 64
+#define PLAYLIST_DEFAULT_DURATION_S 30
+#define PLAYLIST_MAX_PRIORITY 9
+// Bump when PlaylistEntry, CompiledCell, the cache layout or the way
+// messages are laid out change
+#define PLAYLIST_CACHE_VERSION 2
+
+// Entry flags
+#define PLAYLIST_ENTRY_SCROLL 0x01  // longer than the board: a marquee, or cut off if the board truncates
+
+// One scheduled message. Its cells and text live in the playlist's pools.
+typedef struct
+{
+    uint32_t cell_offset;
+    uint16_t cell_count;
+    uint16_t duration_s;
+    int16_t window_start;  // minute of the day, -1 = any time
+    int16_t window_end;    // exclusive; earlier than window_start wraps past midnight
+    uint8_t priority;      // 0..PLAYLIST_MAX_PRIORITY, higher is shown first
+    uint8_t flags;
+    uint32_t text_offset;
+    uint16_t text_len;
+} PlaylistEntry;
+
+// Header of the compiled cache file, followed by the entries, the cells and
+// the text pool
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint16_t version;
+    uint8_t entry_size;
+    uint8_t cell_size;
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t align;           // TextAlign the entries were laid out with
+    int16_t slot_width;
+    int16_t slot_height;
+    uint32_t source_hash;    // FNV-1a of the playlist text
+    uint32_t glyph_tables;   // GridBoard::glyph_table_signature()
+    uint16_t entry_count;
+    uint32_t cell_count;
+    uint32_t text_bytes;
+} PlaylistCacheHeader;
+
+/**
+ * Messages from a playlist file, compiled once and scheduled on the board.
+ *
+ * Each line of the file is one message, optionally preceded by its schedule
+ * and a '|':
+ *
+ *     # comment
+ *     HOME SWEET HOME ❤
+ *     10s | NEXT TRAIN 12:45
+ *     20s p2 07:00-09:00 | GOOD MORNING 😊
+ *
+ * "Ns" is how long the message stays up (default 30 s), "pN" its priority
+ * (0-9, default 0) and "HH:MM-HH:MM" the time of day it may be shown in.
+ * While entries of a higher priority are in their window, lower ones are
+ * skipped; entries of the same priority take turns.
+ *
+ * compile() lays every entry out for the board layout with
+ * GridBoard::compile_message(), so the LVGL task only diffs precompiled cells
+ * when the message changes. load() keeps the compiled form in a cache file
+ * next to the playlist and reuses it while the playlist text, the layout, the
+ * text alignment and the glyph tables are unchanged. Loading and compiling are meant for a
+ * background task; select(), show() and tick() for the LVGL task.
+ */
+class Playlist {
+public:
+    // Parse and compile playlist text, aligned as the board aligns its
+    // messages. Returns false if it has no entries.
+    bool compile(const std::string &source, const GridLayout &layout, TextAlign align = TEXT_ALIGN_CENTER);
+    // Read the playlist file, from cache_path if that is current. A fresh
+    // compile rewrites the cache; cache_path may be nullptr.
+    bool load(const char *path, const char *cache_path, const GridLayout &layout,
+              TextAlign align = TEXT_ALIGN_CENTER);
+    bool save_cache(const char *path) const;
+
+    int size() const { return (int)entries.size(); }
+    const PlaylistEntry &entry(int index) const { return entries[index]; }
+    const CompiledCell *cells(const PlaylistEntry &e) const { return cell_pool.data() + e.cell_offset; }
+    std::string text(const PlaylistEntry &e) const { return text_pool.substr(e.text_offset, e.text_len); }
+    bool loaded_from_cache() const { return from_cache; }
+
+    // Next entry to show at minute_of_day (-1 if the clock is not set, then
+    // only entries without a window qualify). Returns -1 if none does.
+    int select(int minute_of_day) const;
+    // Put an entry on the board; returns the changed cells
+    int show(GridBoard &board, int index) const;
+    // Move on once the current entry had its time and the board is idle.
+    // Returns true if a new entry was shown.
+    bool tick(GridBoard &board, int64_t now_ms, int minute_of_day);
+
+private:
+    bool load_cache(const char *path, uint32_t source_hash);
+    static bool in_window(const PlaylistEntry &e, int minute_of_day);
+
+    GridLayout layout = GRID_LAYOUT_12X5;
+    TextAlign align = TEXT_ALIGN_CENTER;
+    std::vector<PlaylistEntry> entries;
+    std::vector<CompiledCell> cell_pool;
+    std::string text_pool;
+    uint32_t source_hash = 0;
+    bool from_cache = false;
+    int current = -1;
+    int64_t shown_at_ms = 0;
+};
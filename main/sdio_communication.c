@@ -5,6 +5,7 @@
 
 #include "sdio_communication.h"
 #include "driver/gpio.h"
+#include "boot_trace.h"
 #include <string.h>
 
 static const char *TAG = "TAB5_SDIO";
@@ -177,13 +178,17 @@ esp_err_t tab5_sdio_init(tab5_sdio_handle_t *handle)
     
     // Reset C6 before initialization
     ESP_LOGI(TAG, "Resetting ESP32-C6");
+    int phase = boot_trace_begin("c6 reset");
     gpio_set_level(C6_RESET_GPIO, 0);
     vTaskDelay(pdMS_TO_TICKS(100));
     gpio_set_level(C6_RESET_GPIO, 1);
     vTaskDelay(pdMS_TO_TICKS(500));  // Wait for C6 to boot
+    boot_trace_end(phase);
     
     // Initialize SDIO host
+    phase = boot_trace_begin("sdio probe");
     ret = init_sdio_host(handle);
+    boot_trace_end(phase);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize SDIO host");
         return ret;
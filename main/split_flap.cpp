@@ -0,0 +1,106 @@
+#include "split_flap.hpp"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <cstring>
+
+static const char *TAG = "SPLIT_FLAP";
+
+SplitFlapRenderer::SplitFlapRenderer(int cells, int card_width, int card_height, lv_color_t card_color)
+    : flaps(nullptr), pixels(nullptr), cells(cells), card_width(card_width),
+      max_rows(card_height - card_height / 2), card_color(card_color), stats{}
+{
+}
+
+SplitFlapRenderer::~SplitFlapRenderer()
+{
+    heap_caps_free(pixels);
+    delete[] flaps;
+}
+
+bool SplitFlapRenderer::init()
+{
+    size_t flap_bytes = (size_t)card_width * max_rows * sizeof(uint16_t);
+    pixels = (uint8_t *)heap_caps_malloc(flap_bytes * cells, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!pixels)
+    {
+        ESP_LOGE(TAG, "Failed to allocate %d flaps (%u bytes) in PSRAM", cells, (unsigned)(flap_bytes * cells));
+        return false;
+    }
+
+    flaps = new Flap[cells];
+    for (int i = 0; i < cells; i++)
+    {
+        Flap &flap = flaps[i];
+        memset(&flap, 0, sizeof(flap));
+        flap.image.header.magic = LV_IMAGE_HEADER_MAGIC;
+        flap.image.header.cf = LV_COLOR_FORMAT_RGB565;
+        flap.image.header.w = card_width;
+        flap.image.header.stride = card_width * sizeof(uint16_t);
+        flap.image.data = pixels + flap_bytes * i;
+    }
+
+    ESP_LOGI(TAG, "Split-flap renderer: %d flaps of %dx%d RGB565, %u KB PSRAM", cells, card_width, max_rows,
+             (unsigned)(flap_bytes * cells / 1024));
+    return true;
+}
+
+void SplitFlapRenderer::forget(int cell)
+{
+    if (flaps && cell >= 0 && cell < cells)
+    {
+        flaps[cell].image.header.h = 0;
+    }
+}
+
+const lv_image_dsc_t *SplitFlapRenderer::compose(int cell, const lv_image_dsc_t *half, int height)
+{
+    if (!flaps || cell < 0 || cell >= cells || height <= 0)
+        return nullptr;
+    if (height > max_rows)
+        height = max_rows;
+
+    Flap &flap = flaps[cell];
+    if (flap.source == half && (int)flap.image.header.h == height)
+    {
+        stats.reused++;
+        return &flap.image;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    uint8_t *dst = (uint8_t *)flap.image.data;
+    const size_t row_bytes = flap.image.header.stride;
+    if (half)
+    {
+        // Nearest source row for every target row
+        const int src_rows = half->header.h;
+        for (int y = 0; y < height; y++)
+        {
+            memcpy(dst + row_bytes * y, half->data + (size_t)half->header.stride * (y * src_rows / height), row_bytes);
+        }
+    }
+    else
+    {
+        // Blank card: one row of the card color, repeated
+        uint16_t *row = (uint16_t *)dst;
+        uint16_t c = lv_color_to_u16(card_color);
+        for (int x = 0; x < card_width; x++)
+        {
+            row[x] = c;
+        }
+        for (int y = 1; y < height; y++)
+        {
+            memcpy(dst + row_bytes * y, dst, row_bytes);
+        }
+    }
+
+    flap.image.header.h = height;
+    flap.image.data_size = row_bytes * height;
+    flap.source = half;
+    lv_image_cache_drop(&flap.image);
+
+    stats.composed++;
+    stats.rows += height;
+    stats.compose_time_us += esp_timer_get_time() - start_us;
+    return &flap.image;
+}
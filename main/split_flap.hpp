@@ -0,0 +1,59 @@
+#pragma once
+
+#include "lvgl.h"
+#include <stdint.h>
+
+// Work done by the split-flap renderer
+typedef struct
+{
+    uint32_t composed;        // flap images built
+    uint32_t reused;          // compose() calls answered with the previous image
+    uint64_t rows;            // rows copied into flap images
+    uint64_t compose_time_us;
+} SplitFlapStats;
+
+/**
+ * Builds the falling flap of split-flap cards.
+ *
+ * A flipping card is drawn in three pieces: the top half of the new card
+ * above the flap, the bottom half of the old card below it, and the flap,
+ * which is the old top half folding down onto the hinge and then the new
+ * bottom half unfolding from it. Both halves come precomputed from the tile
+ * cache (GlyphTileCache::top_half() and bottom_half()). Only the flap changes
+ * from frame to frame: it is a row-scaled copy of one half, nearest row, one
+ * memcpy per row into a buffer the cell owns. No glyph is rasterized while
+ * cards flip, and a frame costs at most half a card of row copies per cell.
+ */
+class SplitFlapRenderer {
+public:
+    SplitFlapRenderer(int cells, int card_width, int card_height, lv_color_t card_color);
+    ~SplitFlapRenderer();
+
+    // Allocate one flap buffer per cell, half a card of RGB565 each
+    bool init();
+
+    // Flap image for a cell: half (nullptr = blank card) scaled to height
+    // rows. The image stays valid until the cell's next compose(); asking
+    // for the same flap again returns it without copying.
+    const lv_image_dsc_t *compose(int cell, const lv_image_dsc_t *half, int height);
+    // The cell's card changed: its next compose() copies again even if the
+    // half is at the same address, which a recycled tile can be
+    void forget(int cell);
+
+    const SplitFlapStats &get_stats() const { return stats; }
+
+private:
+    typedef struct
+    {
+        lv_image_dsc_t image;
+        const lv_image_dsc_t *source;  // half the image was scaled from
+    } Flap;
+
+    Flap *flaps;
+    uint8_t *pixels;
+    int cells;
+    int card_width;
+    int max_rows;       // taller of the two halves
+    lv_color_t card_color;
+    SplitFlapStats stats;
+};
@@ -17,6 +17,7 @@
 #include "sdio_communication.h"
 #include "c6_sd_firmware_loader.h"
 #include "c6_firmware_prepare.h"
+#include "boot_trace.h"
 
 static const char *TAG = "TAB5_C6_INTEGRATION";
 
@@ -112,6 +113,7 @@ esp_err_t tab5_c6_system_init(bool force_bridge_mode)
         }
     } else {
         ESP_LOGW(TAG, "C6 not ready, attempting reset...");
+        int phase = boot_trace_begin("c6 retry");
         ret = tab5_c6_reset(&sdio_handle);
         if (ret == ESP_OK) {
             vTaskDelay(pdMS_TO_TICKS(2000));
@@ -120,6 +122,7 @@ esp_err_t tab5_c6_system_init(bool force_bridge_mode)
                 ESP_LOGI(TAG, "C6 ready after reset");
             }
         }
+        boot_trace_end(phase);
     }
     
     // Create status monitoring task
@@ -0,0 +1,149 @@
+#include "text_layout.hpp"
+
+// A line of the laid out text: cells [first, end) of the input, shown side
+// by side. Lines are contiguous because only blanks at a wrap and breaks
+// fall between them.
+typedef struct
+{
+    int first;
+    int end;
+} TextLine;
+
+// Lines found so far. Empty lines are only kept once text follows them, so
+// trailing breaks do not push the text up or overflow the board.
+typedef struct
+{
+    TextLine lines[GRID_MAX_ROWS];
+    int count;
+    int empty;  // empty lines waiting for text
+    int rows;
+    bool overflow;
+} TextLines;
+
+static bool add_line(TextLines *t, int first, int end)
+{
+    if (first == end)
+    {
+        t->empty++;
+        return true;
+    }
+    if (t->count + t->empty >= t->rows)
+    {
+        t->overflow = true;
+        return false;
+    }
+    for (; t->empty > 0; t->empty--)
+    {
+        t->lines[t->count++] = {first, first};
+    }
+    t->lines[t->count++] = {first, end};
+    return true;
+}
+
+// Control characters other than '\n' (tabs, the '\r' of "\r\n") wrap like spaces
+static inline bool is_blank(uint32_t codepoint)
+{
+    return codepoint == ' ' || (codepoint < 0x20 && codepoint != '\n');
+}
+
+TextLayoutResult text_layout(const Utf8Cell *cells, int count, int cols, int rows, TextAlign align,
+                             int16_t *positions)
+{
+    TextLayoutResult result = {};
+    for (int i = 0; i < count; i++)
+    {
+        positions[i] = TEXT_LAYOUT_HIDDEN;
+    }
+    if (cols <= 0 || rows <= 0)
+    {
+        result.overflow = count > 0;
+        return result;
+    }
+
+    TextLines t = {};
+    t.rows = rows < GRID_MAX_ROWS ? rows : GRID_MAX_ROWS;
+
+    // The open line runs from first to the end of its last word; blanks after
+    // that only join it if another word fits behind them
+    int first = 0;
+    int end = 0;
+    bool wrapped = false;  // continues a wrapped line, so leading blanks go
+    int i = 0;
+    while (i < count)
+    {
+        const uint32_t codepoint = cells[i].codepoint;
+        if (codepoint == '\n')
+        {
+            if (!add_line(&t, first, end))
+                break;
+            first = end = ++i;
+            wrapped = false;
+            continue;
+        }
+        if (is_blank(codepoint))
+        {
+            i++;
+            continue;
+        }
+
+        int word_end = i + 1;
+        while (word_end < count && !is_blank(cells[word_end].codepoint) && cells[word_end].codepoint != '\n')
+        {
+            word_end++;
+        }
+        if (end == first && (wrapped || word_end - first > cols))
+        {
+            first = i;  // no indent on a wrapped line, nor one that cannot hold the word
+        }
+        if (word_end - first > cols && end > first)
+        {
+            // Wrap before the word; the blanks in between are dropped
+            if (!add_line(&t, first, end))
+                break;
+            first = i;
+            wrapped = true;
+        }
+        // A word wider than the board fills whole rows
+        while (word_end - first > cols && !t.overflow)
+        {
+            if (add_line(&t, first, first + cols))
+            {
+                first += cols;
+                wrapped = true;
+            }
+        }
+        if (t.overflow)
+            break;
+        end = i = word_end;
+    }
+    if (!t.overflow)
+    {
+        add_line(&t, first, end);
+    }
+
+    // Align every line and center the block
+    const int top = (t.rows - t.count) / 2;
+    for (int l = 0; l < t.count; l++)
+    {
+        const TextLine &line = t.lines[l];
+        const int width = line.end - line.first;
+        int col = 0;
+        if (align == TEXT_ALIGN_CENTER)
+        {
+            col = (cols - width) / 2;
+        }
+        else if (align == TEXT_ALIGN_RIGHT)
+        {
+            col = cols - width;
+        }
+        const int start = (top + l) * cols + col - line.first;
+        for (int k = line.first; k < line.end; k++)
+        {
+            positions[k] = (int16_t)(start + k);
+        }
+        result.placed += width;
+    }
+    result.lines = t.count;
+    result.overflow = t.overflow;
+    return result;
+}
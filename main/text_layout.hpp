@@ -0,0 +1,66 @@
+#pragma once
+
+#include "grid_layout.hpp"
+#include "utf8_segment.hpp"
+#include <stdint.h>
+#include <string.h>
+
+// Most cells a message may have to still fit a board: every cell used, plus
+// a line break ending each row. Longer text overflows whatever the wrapping.
+#define TEXT_LAYOUT_MAX_CELLS (GRID_MAX_CELLS + GRID_MAX_ROWS)
+
+// Position of a cell that is not shown: a break, blanks swallowed where a
+// line wraps, or text cut off below the last row
+#define TEXT_LAYOUT_HIDDEN -1
+
+// Where each line sits within the row
+typedef enum : uint8_t
+{
+    TEXT_ALIGN_CENTER = 0,
+    TEXT_ALIGN_LEFT,
+    TEXT_ALIGN_RIGHT,
+    TEXT_ALIGN_COUNT,
+} TextAlign;
+
+typedef struct
+{
+    int lines;      // rows the text takes, centered vertically
+    int placed;     // cells given a position, blanks between words included
+    bool overflow;  // text was left over after the last row
+} TextLayoutResult;
+
+/**
+ * Lay segmented text out on a cols x rows board.
+ *
+ * Words (runs of cells other than blanks and '\n') are wrapped greedily to
+ * the board width; a word longer than a row is split across rows. '\n' starts
+ * a new line, blank lines included, and blanks after one are kept as an
+ * indent. Blanks at a wrap and at the end of a line are dropped. Each line is
+ * aligned on its own and the block of lines is centered vertically.
+ *
+ * positions[i] receives row * cols + col of cells[i], or TEXT_LAYOUT_HIDDEN.
+ * One pass over the cells plus one over the placed lines; nothing is
+ * allocated. rows is capped at GRID_MAX_ROWS.
+ */
+TextLayoutResult text_layout(const Utf8Cell *cells, int count, int cols, int rows, TextAlign align,
+                             int16_t *positions);
+
+inline const char *text_align_name(TextAlign align)
+{
+    static const char *const names[TEXT_ALIGN_COUNT] = {"center", "left", "right"};
+    return align < TEXT_ALIGN_COUNT ? names[align] : "center";
+}
+
+// By name as text_align_name() gives it; false if unknown
+inline bool text_align_find(const char *name, TextAlign *align)
+{
+    for (int i = 0; i < TEXT_ALIGN_COUNT; i++)
+    {
+        if (strcmp(name, text_align_name((TextAlign)i)) == 0)
+        {
+            *align = (TextAlign)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,216 @@
+#include "utf8_segment.hpp"
+#include <cstring>
+
+// Lead byte classes
+enum : uint8_t
+{
+    U8_BAD = 0,   // continuation byte, C0/C1, F5..FF
+    U8_ASCII,
+    U8_2,         // C2..DF
+    U8_3,         // E1..EC, EE, EF
+    U8_E0,        // second byte A0..BF (no overlongs)
+    U8_ED,        // second byte 80..9F (no surrogates)
+    U8_4,         // F1..F3
+    U8_F0,        // second byte 90..BF (no overlongs)
+    U8_F4,        // second byte 80..8F (max U+10FFFF)
+};
+
+static const uint8_t lead_class[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // 80..8F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // 90..9F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // A0..AF
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // B0..BF
+    0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // C0..CF
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // D0..DF
+    4, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 5, 3, 3,  // E0..EF
+    7, 6, 6, 6, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // F0..FF
+};
+
+// Per class: sequence length, payload bits of the lead byte and the allowed
+// range of the second byte
+static const struct
+{
+    uint8_t len;
+    uint8_t mask;
+    uint8_t lo;
+    uint8_t hi;
+} class_info[] = {
+    {0, 0x00, 0x00, 0x00},  // U8_BAD
+    {1, 0x7F, 0x00, 0x00},  // U8_ASCII
+    {2, 0x1F, 0x80, 0xBF},  // U8_2
+    {3, 0x0F, 0x80, 0xBF},  // U8_3
+    {3, 0x0F, 0xA0, 0xBF},  // U8_E0
+    {3, 0x0F, 0x80, 0x9F},  // U8_ED
+    {4, 0x07, 0x80, 0xBF},  // U8_4
+    {4, 0x07, 0x90, 0xBF},  // U8_F0
+    {4, 0x07, 0x80, 0x8F},  // U8_F4
+};
+
+size_t utf8_decode(const char *s, size_t len, uint32_t *cp)
+{
+    const uint8_t *p = (const uint8_t *)s;
+    if (len == 0)
+    {
+        *cp = UTF8_INVALID;
+        return 0;
+    }
+
+    uint8_t c = lead_class[p[0]];
+    size_t n = class_info[c].len;
+    if (n == 1)
+    {
+        *cp = p[0];
+        return 1;
+    }
+    if (n == 0 || n > len || p[1] < class_info[c].lo || p[1] > class_info[c].hi)
+    {
+        *cp = UTF8_INVALID;
+        return 1;
+    }
+
+    uint32_t v = ((uint32_t)(p[0] & class_info[c].mask) << 6) | (p[1] & 0x3F);
+    for (size_t i = 2; i < n; i++)
+    {
+        if ((p[i] & 0xC0) != 0x80)
+        {
+            *cp = UTF8_INVALID;
+            return 1;
+        }
+        v = (v << 6) | (p[i] & 0x3F);
+    }
+    *cp = v;
+    return n;
+}
+
+// Code points that never start a cell of their own
+static bool is_extender(uint32_t cp)
+{
+    return cp == 0xFE0E || cp == 0xFE0F ||              // text/emoji presentation selectors
+           cp == 0x200D ||                              // zero width joiner
+           (cp >= 0x1F3FB && cp <= 0x1F3FF) ||          // skin tone modifiers
+           (cp >= 0x0300 && cp <= 0x036F) ||            // combining diacritics
+           (cp >= 0x20D0 && cp <= 0x20FF) ||            // combining marks for symbols, keycap
+           (cp >= 0xE0020 && cp <= 0xE007F);            // tag sequences
+}
+
+static bool is_regional_indicator(uint32_t cp)
+{
+    return cp >= 0x1F1E6 && cp <= 0x1F1FF;
+}
+
+static void put_ascii(Utf8Cell *cell, char c)
+{
+    cell->text[0] = c;
+    cell->text[1] = '\0';
+    cell->len = 1;
+    cell->codepoint = (uint8_t)c;
+}
+
+static int segment(const char *text, size_t len, Utf8Cell *cells, int max_cells, Utf8SegmentStats &st,
+                   size_t *consumed)
+{
+    const uint8_t *p = (const uint8_t *)text;
+    size_t i = 0;
+    int count = 0;
+    bool joined = false;      // previous code point was a ZWJ
+    bool flag_open = false;   // last cell is a single regional indicator
+
+    while (i < len && count < max_cells)
+    {
+        // ASCII fast path: eight plain bytes become eight cells
+        if (len - i >= 8 && max_cells - count >= 8 && !joined)
+        {
+            uint64_t word;
+            memcpy(&word, p + i, sizeof(word));
+            if ((word & 0x8080808080808080ull) == 0)
+            {
+                for (int k = 0; k < 8; k++)
+                {
+                    put_ascii(&cells[count++], (char)p[i + k]);
+                }
+                i += 8;
+                flag_open = false;
+                continue;
+            }
+        }
+
+        uint32_t cp;
+        size_t n = utf8_decode(text + i, len - i, &cp);
+        if (cp == UTF8_INVALID)
+        {
+            st.invalid_bytes++;
+            i += n;
+            continue;
+        }
+
+        // Everything that only modifies the previous cell is folded into it
+        bool fold = count > 0 && (is_extender(cp) || joined || (flag_open && is_regional_indicator(cp)));
+        joined = (cp == 0x200D);
+        if (fold)
+        {
+            st.folded++;
+            flag_open = false;
+            i += n;
+            continue;
+        }
+        if (is_extender(cp))
+        {
+            i += n;  // nothing to attach to
+            continue;
+        }
+
+        // Typographic quotes become their ASCII form
+        if (cp == 0x2018 || cp == 0x2019)
+        {
+            put_ascii(&cells[count++], '\'');
+        }
+        else if (cp == 0x201C || cp == 0x201D)
+        {
+            put_ascii(&cells[count++], '"');
+        }
+        else
+        {
+            Utf8Cell &cell = cells[count++];
+            memcpy(cell.text, text + i, n);
+            cell.text[n] = '\0';
+            cell.len = (uint8_t)n;
+            cell.codepoint = cp;
+        }
+        flag_open = is_regional_indicator(cp);
+        i += n;
+    }
+
+    // Take along whatever still folds into the last cell, so a stream can
+    // resume on a cell boundary
+    while (consumed && count > 0 && i < len)
+    {
+        uint32_t cp;
+        size_t n = utf8_decode(text + i, len - i, &cp);
+        if (cp == UTF8_INVALID || !(is_extender(cp) || joined || (flag_open && is_regional_indicator(cp))))
+            break;
+        st.folded++;
+        joined = (cp == 0x200D);
+        flag_open = false;
+        i += n;
+    }
+    if (consumed)
+        *consumed = i;
+    return count;
+}
+
+int utf8_segment(const char *text, size_t len, Utf8Cell *cells, int max_cells, Utf8SegmentStats *stats)
+{
+    Utf8SegmentStats local = {};
+    return segment(text, len, cells, max_cells, stats ? *stats : local, nullptr);
+}
+
+int utf8_segment_next(const char *text, size_t len, Utf8Cell *cells, int max_cells, size_t *consumed,
+                      Utf8SegmentStats *stats)
+{
+    Utf8SegmentStats local = {};
+    return segment(text, len, cells, max_cells, stats ? *stats : local, consumed);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Returned by utf8_decode() for a malformed or truncated sequence
+#define UTF8_INVALID 0xFFFFFFFFu
+
+// One board cell worth of text: a single code point with everything that
+// only modifies it (variation selectors, ZWJ tails, skin tones, combining
+// marks) folded away, since the bitmap fonts cannot draw those anyway
+typedef struct
+{
+    char text[8];        // UTF-8, NUL terminated, at most 4 bytes used
+    uint8_t len;
+    uint32_t codepoint;
+} Utf8Cell;
+
+typedef struct
+{
+    uint32_t invalid_bytes;   // bytes skipped as malformed or truncated
+    uint32_t folded;          // code points merged into the previous cell
+} Utf8SegmentStats;
+
+/**
+ * Decode one code point from s (len bytes available).
+ *
+ * Returns the number of bytes consumed, at least 1 when len > 0. Overlong
+ * forms, surrogates, values above U+10FFFF and sequences cut short by the end
+ * of the buffer decode to UTF8_INVALID and consume one byte.
+ */
+size_t utf8_decode(const char *s, size_t len, uint32_t *cp);
+
+/**
+ * Split text into board cells in one pass.
+ *
+ * Runs of ASCII are copied eight bytes at a time. Typographic quotes are
+ * normalized to ASCII on the way. Emoji sequences (VS15/VS16, ZWJ, skin tone,
+ * flag pairs, keycaps, tags) take one cell, showing their first emoji.
+ * Returns the number of cells written, at most max_cells.
+ */
+int utf8_segment(const char *text, size_t len, Utf8Cell *cells, int max_cells,
+                 Utf8SegmentStats *stats = nullptr);
+
+/**
+ * Segment the next cells of a text that is consumed piecewise, e.g. streamed
+ * through a scrolling board. Produces the same cells as utf8_segment();
+ * *consumed receives the number of bytes used, including anything that still
+ * folds into the last cell, so the next call can start right there.
+ */
+int utf8_segment_next(const char *text, size_t len, Utf8Cell *cells, int max_cells, size_t *consumed,
+                      Utf8SegmentStats *stats = nullptr);